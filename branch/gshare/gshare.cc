@@ -3,6 +3,7 @@
 #include <bitset>
 #include <map>
 
+#include "checkpoint.h"
 #include "msl/fwcounter.h"
 #include "ooo_cpu.h"
 
@@ -26,7 +27,11 @@ std::size_t gs_table_hash(uint64_t ip, std::bitset<GLOBAL_HISTORY_LENGTH> bh_vec
 }
 } // namespace
 
-void O3_CPU::initialize_branch_predictor() {}
+void O3_CPU::initialize_branch_predictor()
+{
+  ::branch_history_vector[this] = {};
+  ::gs_history_table[this] = {};
+}
 
 uint8_t O3_CPU::predict_branch(uint64_t ip)
 {
@@ -44,3 +49,14 @@ void O3_CPU::last_branch_result(uint64_t ip, uint64_t branch_target, uint8_t tak
   ::branch_history_vector[this] <<= 1;
   ::branch_history_vector[this][0] = taken;
 }
+
+void O3_CPU::checkpoint_branch_predictor(std::ostream& stream)
+{
+  champsim::checkpoint::save(stream, std::tie(::branch_history_vector.at(this), ::gs_history_table.at(this)));
+}
+
+void O3_CPU::restore_branch_predictor(std::istream& stream)
+{
+  auto fields = std::tie(::branch_history_vector.at(this), ::gs_history_table.at(this));
+  champsim::checkpoint::load(stream, fields);
+}
@@ -50,6 +50,7 @@ sources for you to plagiarize.
 #include <stdlib.h>
 #include <string.h>
 
+#include "checkpoint.h"
 #include "ooo_cpu.h"
 
 // this many tables
@@ -248,3 +249,15 @@ void O3_CPU::last_branch_result(uint64_t pc, uint64_t branch_target, uint8_t tak
     }
   }
 }
+
+// Each core only saves its own rows of the tables
+void O3_CPU::checkpoint_branch_predictor(std::ostream& stream)
+{
+  champsim::checkpoint::save(stream, std::tie(::tables[cpu], ::ghist_words[cpu], ::indices[cpu], ::theta[cpu], ::tc[cpu], ::yout[cpu]));
+}
+
+void O3_CPU::restore_branch_predictor(std::istream& stream)
+{
+  auto fields = std::tie(::tables[cpu], ::ghist_words[cpu], ::indices[cpu], ::theta[cpu], ::tc[cpu], ::yout[cpu]);
+  champsim::checkpoint::load(stream, fields);
+}
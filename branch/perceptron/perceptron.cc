@@ -43,6 +43,7 @@
 #include <deque>
 #include <map>
 
+#include "checkpoint.h"
 #include "msl/fwcounter.h"
 #include "ooo_cpu.h"
 
@@ -109,7 +110,13 @@ std::map<O3_CPU*, std::bitset<PERCEPTRON_HISTORY>> global_history;      // real
                                                                         // updated
 } // namespace
 
-void O3_CPU::initialize_branch_predictor() {}
+void O3_CPU::initialize_branch_predictor()
+{
+  ::perceptrons[this] = {};
+  ::perceptron_state_buf[this] = {};
+  ::spec_global_history[this] = {};
+  ::global_history[this] = {};
+}
 
 uint8_t O3_CPU::predict_branch(uint64_t ip)
 {
@@ -157,3 +164,14 @@ void O3_CPU::last_branch_result(uint64_t ip, uint64_t branch_target, uint8_t tak
   if ((output <= THETA && output >= -THETA) || (prediction != taken))
     ::perceptrons[this][index].update(taken, history);
 }
+
+void O3_CPU::checkpoint_branch_predictor(std::ostream& stream)
+{
+  champsim::checkpoint::save(stream, std::tie(::perceptrons.at(this), ::perceptron_state_buf.at(this), ::spec_global_history.at(this), ::global_history.at(this)));
+}
+
+void O3_CPU::restore_branch_predictor(std::istream& stream)
+{
+  auto fields = std::tie(::perceptrons.at(this), ::perceptron_state_buf.at(this), ::spec_global_history.at(this), ::global_history.at(this));
+  champsim::checkpoint::load(stream, fields);
+}
@@ -11,6 +11,7 @@
 #include <deque>
 #include <map>
 
+#include "checkpoint.h"
 #include "msl/lru_table.h"
 #include "ooo_cpu.h"
 
@@ -55,6 +56,7 @@ void O3_CPU::initialize_btb()
   std::fill(std::begin(::INDIRECT_BTB[this]), std::end(::INDIRECT_BTB[this]), 0);
   std::fill(std::begin(::CALL_SIZE[this]), std::end(::CALL_SIZE[this]), 4);
   ::CONDITIONAL_HISTORY[this] = 0;
+  ::RAS[this] = {};
 }
 
 std::pair<uint64_t, uint8_t> O3_CPU::btb_prediction(uint64_t ip)
@@ -136,3 +138,14 @@ void O3_CPU::update_btb(uint64_t ip, uint64_t branch_target, uint8_t taken, uint
     ::BTB.at(this).fill(opt_entry.value_or(::btb_entry_t{ip, branch_target, type}));
   }
 }
+
+void O3_CPU::checkpoint_btb(std::ostream& stream)
+{
+  champsim::checkpoint::save(stream, std::tie(::BTB.at(this), ::INDIRECT_BTB.at(this), ::CONDITIONAL_HISTORY.at(this), ::RAS.at(this), ::CALL_SIZE.at(this)));
+}
+
+void O3_CPU::restore_btb(std::istream& stream)
+{
+  auto fields = std::tie(::BTB.at(this), ::INDIRECT_BTB.at(this), ::CONDITIONAL_HISTORY.at(this), ::RAS.at(this), ::CALL_SIZE.at(this));
+  champsim::checkpoint::load(stream, fields);
+}
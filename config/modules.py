@@ -13,7 +13,9 @@
 # limitations under the License.
 
 import os
+import re
 import itertools
+import functools
 
 from . import util
 
@@ -44,6 +46,21 @@ class ModuleSearchContext:
         files = itertools.starmap(os.path.join, itertools.chain(*(zip(itertools.repeat(b), d) for b,d,_ in base_dirs)))
         return [self.data_from_path(f) for f in files]
 
+# The checkpoint hooks are optional. A module that does not define one is given a definition that does nothing.
+optional_functions = ('checkpoint_branch_predictor', 'restore_branch_predictor', 'checkpoint_btb', 'restore_btb', 'prefetcher_checkpoint', 'prefetcher_restore', 'checkpoint_replacement', 'restore_replacement')
+
+# Read the sources of a module, to find which of the optional functions it defines
+@functools.lru_cache(maxsize=None)
+def module_sources(path):
+    fnames = itertools.chain(*(((os.path.join(base, f) for f in files if os.path.splitext(f)[1] in ('.cc', '.h')) for base,_,files in os.walk(path))))
+    def read(fname):
+        with open(fname, 'rt', errors='ignore') as rfp:
+            return rfp.read()
+    return '\n'.join(map(read, sorted(fnames)))
+
+def defines_function(module_data, fname):
+    return fname not in optional_functions or re.search(r'::\s*{}\s*\('.format(fname), module_sources(module_data.get('fname', ''))) is not None
+
 # A unifying function for the four module types to return their information
 def data_getter(prefix, module_name, funcs):
     return {
@@ -53,15 +70,15 @@ def data_getter(prefix, module_name, funcs):
     }
 
 def get_branch_data(module_name):
-    return data_getter('bpred', module_name, ('initialize_branch_predictor', 'last_branch_result', 'predict_branch'))
+    return data_getter('bpred', module_name, ('initialize_branch_predictor', 'last_branch_result', 'predict_branch', 'checkpoint_branch_predictor', 'restore_branch_predictor'))
 
 def get_btb_data(module_name):
-    return data_getter('btb', module_name, ('initialize_btb', 'update_btb', 'btb_prediction'))
+    return data_getter('btb', module_name, ('initialize_btb', 'update_btb', 'btb_prediction', 'checkpoint_btb', 'restore_btb'))
 
 def get_pref_data(module_name, is_instruction_cache=False):
     prefix = 'ipref' if is_instruction_cache else 'pref'
     return util.chain(
-            data_getter(prefix, module_name, ('prefetcher_initialize', 'prefetcher_cache_operate', 'prefetcher_branch_operate', 'prefetcher_cache_fill', 'prefetcher_cycle_operate', 'prefetcher_final_stats')),
+            data_getter(prefix, module_name, ('prefetcher_initialize', 'prefetcher_cache_operate', 'prefetcher_branch_operate', 'prefetcher_cache_fill', 'prefetcher_cycle_operate', 'prefetcher_final_stats', 'prefetcher_checkpoint', 'prefetcher_restore')),
             { 'deprecated_func_map' : {
                     'l1i_prefetcher_initialize': '_'.join((prefix, module_name, 'prefetcher_initialize')),
                     'l1d_prefetcher_initialize': '_'.join((prefix, module_name, 'prefetcher_initialize')),
@@ -86,7 +103,7 @@ def get_pref_data(module_name, is_instruction_cache=False):
         )
 
 def get_repl_data(module_name):
-    return data_getter('repl', module_name, ('initialize_replacement', 'find_victim', 'update_replacement_state', 'replacement_final_stats'))
+    return data_getter('repl', module_name, ('initialize_replacement', 'find_victim', 'update_replacement_state', 'replacement_final_stats', 'checkpoint_replacement', 'restore_replacement'))
 
 # Generate C++ code giving the mangled module specialization functions
 def mangled_declarations(rtype, names, args, attrs=[]):
@@ -107,6 +124,11 @@ def mangled_prohibited_definitions(fname, names, args=tuple(), rtype='void', *ta
     argstring = ', '.join(a[0] for a in args)
     yield from ('[[{}]] {} {}({}) {{ throw std::runtime_error("Not implemented"); }}'.format(attrstring, rtype, name, argstring) for name in names)
 
+# Generate C++ code defining the mangled module specialization functions that do nothing, for modules that do not define an optional function
+def mangled_default_definitions(fname, names, args=tuple(), rtype='void', *tail, attrs=[]):
+    argstring = ', '.join(a[0] for a in args)
+    yield from ('{} {}({}) {{}}'.format(rtype, name, argstring) for name in names)
+
 # Generate C++ code giving the declaration for a discriminator function. If the class name is given, the declaration is assumed to be outside the class declaration
 def discriminator_function_declaration(fname, rtype, args, varname, secondary_varname, classname):
     yield 'template <unsigned long long {}, unsigned long long {}>'.format(*sorted([varname, secondary_varname]))
@@ -146,6 +168,11 @@ def get_module_variant_declarations(fname, fnamelist, args=tuple(), rtype='void'
     yield from mangled_declarations(rtype, fnamelist, args, attrs=attrs)
     yield ''
 
+# For a given module function, generate C++ code declaring the mangled specializations that the modules define, and defining those that they omit
+def get_module_variant_lines(fname, module_data, *finfo, attrs=[]):
+    yield from mangled_default_definitions(fname, [v['func_map'][fname] for v in module_data if not defines_function(v, fname)], *finfo)
+    yield from get_module_variant_declarations(fname, [v['func_map'][fname] for v in module_data if defines_function(v, fname)], *finfo, attrs=attrs)
+
 # For a given module function, generate C++ code defining the discriminator function
 def get_discriminator(fname, varname, secondary_varname, zipped_keys_and_funcs, args=tuple(), rtype='void', join_op=None, *tail, classname=None):
     yield from discriminator_function_declaration(fname, rtype, args, varname, secondary_varname, classname)
@@ -163,7 +190,9 @@ def get_ooo_cpu_module_lines(branch_data, btb_data):
     branch_variant_data = [
         ('initialize_branch_predictor',),
         ('last_branch_result', (('uint64_t', 'ip'), ('uint64_t', 'target'), ('uint8_t', 'taken'), ('uint8_t', 'branch_type'))),
-        ('predict_branch', (('uint64_t','ip'),), 'uint8_t', 'std::bit_or')
+        ('predict_branch', (('uint64_t','ip'),), 'uint8_t', 'std::bit_or'),
+        ('checkpoint_branch_predictor', (('std::ostream&','stream'),)),
+        ('restore_branch_predictor', (('std::istream&','stream'),))
     ]
 
     btb_prefix = 't'
@@ -171,7 +200,9 @@ def get_ooo_cpu_module_lines(branch_data, btb_data):
     btb_variant_data = [
         ('initialize_btb',),
         ('update_btb', (('uint64_t','ip'), ('uint64_t','predicted_target'), ('uint8_t','taken'), ('uint8_t','branch_type'))),
-        ('btb_prediction', (('uint64_t','ip'),), 'std::pair<uint64_t, uint8_t>', 'champsim::detail::take_last')
+        ('btb_prediction', (('uint64_t','ip'),), 'std::pair<uint64_t, uint8_t>', 'champsim::detail::take_last'),
+        ('checkpoint_btb', (('std::ostream&','stream'),)),
+        ('restore_btb', (('std::istream&','stream'),))
     ]
 
     classname = 'O3_CPU::module_model<' + branch_varname + ', ' + btb_varname + '>'
@@ -182,8 +213,8 @@ def get_ooo_cpu_module_lines(branch_data, btb_data):
             constants_for_modules(btb_prefix, btb_data.values()), ('',),
 
             # Declare name-mangled functions
-            *(get_module_variant_declarations(fname, [v['func_map'][fname] for v in branch_data.values()], *finfo) for fname, *finfo in branch_variant_data),
-            *(get_module_variant_declarations(fname, [v['func_map'][fname] for v in btb_data.values()], *finfo) for fname, *finfo in btb_variant_data)
+            *(get_module_variant_lines(fname, branch_data.values(), *finfo) for fname, *finfo in branch_variant_data),
+            *(get_module_variant_lines(fname, btb_data.values(), *finfo) for fname, *finfo in btb_variant_data)
         ),
 
         itertools.chain(
@@ -202,7 +233,9 @@ def get_cache_module_lines(pref_data, repl_data):
         ('prefetcher_cache_operate', (('uint64_t', 'addr'), ('uint64_t', 'ip'), ('uint8_t', 'cache_hit'), ('bool', 'useful_prefetch'), ('uint8_t', 'type'), ('uint32_t', 'metadata_in')), 'uint32_t', 'std::bit_xor'),
         ('prefetcher_cache_fill', (('uint64_t', 'addr'), ('uint32_t', 'set'), ('uint32_t', 'way'), ('uint8_t', 'prefetch'), ('uint64_t', 'evicted_addr'), ('uint32_t', 'metadata_in')), 'uint32_t', 'std::bit_xor'),
         ('prefetcher_cycle_operate',),
-        ('prefetcher_final_stats',)
+        ('prefetcher_final_stats',),
+        ('prefetcher_checkpoint', (('std::ostream&','stream'),)),
+        ('prefetcher_restore', (('std::istream&','stream'),))
     ]
 
     pref_branch_variant_data = [
@@ -216,7 +249,9 @@ def get_cache_module_lines(pref_data, repl_data):
         ('initialize_replacement',),
         ('find_victim', (('uint32_t','triggering_cpu'), ('uint64_t','instr_id'), ('uint32_t','set'), ('const BLOCK*','current_set'), ('uint64_t','ip'), ('uint64_t','full_addr'), ('uint32_t','type')), 'uint32_t', 'champsim::detail::take_last'),
         ('update_replacement_state', (('uint32_t','triggering_cpu'), ('uint32_t','set'), ('uint32_t','way'), ('uint64_t','full_addr'), ('uint64_t','ip'), ('uint64_t','victim_addr'), ('uint32_t','type'), ('uint8_t','hit'))),
-        ('replacement_final_stats',)
+        ('replacement_final_stats',),
+        ('checkpoint_replacement', (('std::ostream&','stream'),)),
+        ('restore_replacement', (('std::istream&','stream'),))
     ]
 
     classname = 'CACHE::module_model<' + pref_varname + ', ' + repl_varname + '>'
@@ -227,7 +262,7 @@ def get_cache_module_lines(pref_data, repl_data):
             constants_for_modules(repl_prefix, repl_data.values()), ('',),
 
             # Establish functions common to all prefetchers
-            *(get_module_variant_declarations(fname, [v['func_map'][fname] for v in pref_data.values()], *finfo) for fname, *finfo in pref_nonbranch_variant_data),
+            *(get_module_variant_lines(fname, pref_data.values(), *finfo) for fname, *finfo in pref_nonbranch_variant_data),
 
             # Establish functions that only matter to instruction prefetchers
             ('', '// Assert data prefetchers do not operate on branches'),
@@ -235,7 +270,7 @@ def get_cache_module_lines(pref_data, repl_data):
             *(get_module_variant_declarations(fname, [v['func_map'][fname] for v in pref_data.values() if v.get('_is_instruction_prefetcher')], *finfo) for fname, *finfo in pref_branch_variant_data),
 
             # Declare name-mangled functions
-            *(get_module_variant_declarations(fname, [v['func_map'][fname] for v in repl_data.values()], *finfo) for fname, *finfo in repl_variant_data)
+            *(get_module_variant_lines(fname, repl_data.values(), *finfo) for fname, *finfo in repl_variant_data)
         ),
 
         itertools.chain(
@@ -14,6 +14,7 @@
 
 import itertools
 import collections
+import fractions
 import os
 import math
 
@@ -38,12 +39,13 @@ ptw_deprecation_keys = {
     'ptw_rq_size': 'rq_size'
 }
 
-# Scale frequencies
+# Scale frequencies to exact clock periods, measured in ticks of the fastest clock
 def scale_frequencies(it):
     it_a, it_b = itertools.tee(it, 2)
     max_freq = max(x['frequency'] for x in it_a)
     for x in it_b:
-        x['frequency'] = max_freq / x['frequency']
+        period = (fractions.Fraction(max_freq) / fractions.Fraction(x['frequency'])).limit_denominator(1 << 16)
+        x['frequency'] = 'champsim::clock_period{{{}, {}}}'.format(period.numerator, period.denominator)
 
 def executable_name(*config_list):
     name_by_parts = '_'.join(('champsim', *(c.get('name') for c in config_list if c.get('name') is not None)))
@@ -0,0 +1,225 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ASYNC_READER_H
+#define ASYNC_READER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "instruction.h"
+#include "util/detect.h"
+#include "util/spsc_ring.h"
+
+namespace champsim
+{
+/**
+ * Reads instructions from another reader on a background thread, so that decompressing and inflating them is taken off the simulation thread. The
+ * instructions are passed in batches through a ring that holds up to the given number of batches, and the simulation thread only pops them. Each
+ * side sleeps while the ring is full or empty, so the background thread does not keep a host core busy once it is ahead.
+ *
+ * The background thread is not copied by fork(), so a process that forks while simulating should read its traces synchronously.
+ */
+template <typename T>
+class async_reader
+{
+  using batch_type = std::vector<ooo_model_instr>;
+
+  template <typename U>
+  using has_eof = decltype(std::declval<U>().eof());
+
+  template <typename U>
+  using has_skip = decltype(std::declval<U>().skip(uint64_t{}));
+
+  struct state {
+    T intern_;
+    spsc_ring<batch_type> ring;
+    batch_type pending{}; // The batch that the producer is filling. It is only touched by the consumer while the producer is stopped.
+    std::atomic<bool> stop{false};
+    std::atomic<bool> done{false}; // The underlying reader has ended, and every batch has been pushed
+    std::thread producer{};
+
+    // Held only to sleep and to wake the other side. The ring itself is not locked.
+    std::mutex mutex{};
+    std::condition_variable changed{};
+
+    state(T&& inner, std::size_t depth) : intern_(std::move(inner)), ring(depth) {}
+  };
+
+  std::unique_ptr<state> state_;
+  batch_type current{};
+  std::size_t position = 0;
+
+  static bool inner_eof(const T& inner)
+  {
+    if constexpr (champsim::is_detected_v<has_eof, T>)
+      return inner.eof();
+    return false;
+  }
+
+  // Taking the lock orders the change before a sleeper's check of it, so that the wakeup is not lost
+  static void notify(state& s)
+  {
+    { std::lock_guard lock{s.mutex}; }
+    s.changed.notify_one();
+  }
+
+  // Sleep until a batch is ready or the producer has finished
+  void wait_for_batch() const
+  {
+    std::unique_lock lock{state_->mutex};
+    state_->changed.wait(lock, [s = state_.get()] { return !s->ring.empty() || s->done.load(std::memory_order_acquire); });
+  }
+
+  static void produce(state& s)
+  {
+    for (;;) {
+      while (std::size(s.pending) < batch_size && !inner_eof(s.intern_))
+        s.pending.push_back(s.intern_());
+
+      if (std::empty(s.pending)) {
+        s.done.store(true, std::memory_order_release);
+        notify(s);
+        return;
+      }
+
+      while (!s.ring.try_push(s.pending)) {
+        std::unique_lock lock{s.mutex};
+        s.changed.wait(lock, [&s] { return !s.ring.full() || s.stop.load(std::memory_order_acquire); });
+        if (s.stop.load(std::memory_order_acquire))
+          return;
+      }
+      s.pending.clear();
+      notify(s);
+
+      if (s.stop.load(std::memory_order_acquire))
+        return;
+    }
+  }
+
+  void start()
+  {
+    state_->done.store(false, std::memory_order_relaxed);
+    state_->producer = std::thread{produce, std::ref(*state_)};
+  }
+
+  void halt()
+  {
+    if (state_ != nullptr && state_->producer.joinable()) {
+      state_->stop.store(true, std::memory_order_release);
+      notify(*state_);
+      state_->producer.join();
+      state_->stop.store(false, std::memory_order_relaxed);
+    }
+  }
+
+  // Move to the next batch that is ready. The batch that the producer was filling is only taken once the producer is stopped.
+  bool next_batch(bool stopped)
+  {
+    position = 0;
+    if (state_->ring.try_pop(current)) {
+      notify(*state_);
+      return true;
+    }
+    if (stopped && !std::empty(state_->pending)) {
+      current = std::move(state_->pending);
+      state_->pending.clear();
+      return true;
+    }
+    current.clear();
+    return false;
+  }
+
+public:
+  constexpr static std::size_t batch_size = 256;
+
+  async_reader(T&& inner, std::size_t depth) : state_(std::make_unique<state>(std::move(inner), depth)) { start(); }
+  async_reader(async_reader&& other) = default;
+  async_reader& operator=(async_reader&& other)
+  {
+    halt();
+    state_ = std::move(other.state_);
+    current = std::move(other.current);
+    position = other.position;
+    return *this;
+  }
+  ~async_reader() { halt(); }
+
+  ooo_model_instr operator()()
+  {
+    while (position >= std::size(current) && !next_batch(false)) {
+      // Every batch is pushed before the producer finishes, so an empty ring is the end of the trace
+      if (state_->done.load(std::memory_order_acquire) && !next_batch(false)) {
+        halt();
+        return state_->intern_();
+      }
+      wait_for_batch();
+    }
+
+    return std::move(current.at(position++));
+  }
+
+  // Discard the instructions that were read ahead first. The rest are skipped by the underlying reader, if it can.
+  uint64_t skip(uint64_t count)
+  {
+    auto skip_buffered = [&](bool stopped) {
+      uint64_t skipped = 0;
+      while (skipped < count && (position < std::size(current) || next_batch(stopped))) {
+        auto step = std::min<uint64_t>(count - skipped, std::size(current) - position);
+        position += step;
+        skipped += step;
+      }
+      return skipped;
+    };
+
+    auto skipped = skip_buffered(false);
+    if (skipped < count) {
+      halt();
+      count -= skipped;
+      auto more = skip_buffered(true);
+      skipped += more;
+      count -= more;
+
+      if constexpr (champsim::is_detected_v<has_skip, T>) {
+        skipped += state_->intern_.skip(count);
+      } else {
+        for (; count > 0 && !inner_eof(state_->intern_); --count, ++skipped)
+          state_->intern_();
+      }
+      start();
+    }
+
+    return skipped;
+  }
+
+  // If no instructions are ready, this waits until the producer either pushes more or finishes
+  bool eof() const
+  {
+    if (position >= std::size(current))
+      wait_for_batch();
+    return position >= std::size(current) && state_->done.load(std::memory_order_acquire) && state_->ring.empty();
+  }
+};
+} // namespace champsim
+
+#endif
@@ -0,0 +1,61 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "clock_calendar.h"
+#include "environment.h"
+#include "phase_info.h"
+#include "tracereader.h"
+
+namespace champsim
+{
+// One simulation of a batch: the trace for each core, and the file to receive its JSON output
+struct batch_job {
+  std::vector<std::string> trace_names;
+  std::string json_file_name;
+};
+
+// Read a batch manifest. Each line holds the traces of one job, one for each core, followed by the name of its JSON file. Blank lines and lines that
+// begin with '#' are ignored.
+std::vector<batch_job> read_batch_manifest(std::istream& manifest, std::size_t num_cpus);
+
+// Runs many simulations on one environment. The environment is initialized once, and is returned to that state in place before each run, so that
+// no cache, table, or queue is reallocated between jobs.
+class batch
+{
+  environment& env;
+  clock_calendar calendar;
+  std::string initial_state;
+
+public:
+  explicit batch(environment& env_);
+
+  // Discard the work in flight, and restore the caches, predictors, modules, page mappings, and clocks to their state after initialization
+  void reset(std::vector<tracereader>& traces, const std::vector<std::size_t>& trace_index);
+
+  // Reset the environment, then run the phases as champsim::main() would
+  std::vector<phase_stats> run(std::vector<phase_info>& phases, std::vector<tracereader>& traces);
+};
+} // namespace champsim
+
+#endif
@@ -25,9 +25,12 @@
 #include <array>
 #include <bitset>
 #include <deque>
+#include <iosfwd>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "champsim.h"
@@ -35,6 +38,7 @@
 #include "channel.h"
 #include "module_impl.h"
 #include "operable.h"
+#include "profiler.h"
 #include <type_traits>
 
 struct cache_stats {
@@ -51,8 +55,21 @@ struct cache_stats {
 
   double avg_miss_latency = 0;
   uint64_t total_miss_latency = 0;
+
+  // The members to transfer with the checkpoint serializer
+  auto checkpoint_fields() const
+  {
+    return std::tie(name, pf_requested, pf_issued, pf_useful, pf_useless, pf_fill, hits, misses, avg_miss_latency, total_miss_latency);
+  }
+  auto checkpoint_fields()
+  {
+    return std::tie(name, pf_requested, pf_issued, pf_useful, pf_useless, pf_fill, hits, misses, avg_miss_latency, total_miss_latency);
+  }
 };
 
+// Combine the stats of two phases, as if they had run back to back
+cache_stats operator+(cache_stats lhs, const cache_stats& rhs);
+
 class CACHE : public champsim::operable
 {
   enum [[deprecated(
@@ -123,6 +140,7 @@ class CACHE : public champsim::operable
   void finish_translation(const response_type& packet);
 
   void issue_translation();
+  long perform_tag_checks();
 
   struct BLOCK {
     bool valid = false;
@@ -137,9 +155,17 @@ class CACHE : public champsim::operable
 
     BLOCK() = default;
     explicit BLOCK(mshr_type mshr);
+
+    // The members to transfer with the checkpoint serializer. Blocks are saved member by member, so that their padding is not.
+    auto checkpoint_fields() const { return std::tie(valid, prefetch, dirty, address, v_address, data, pf_metadata); }
+    auto checkpoint_fields() { return std::tie(valid, prefetch, dirty, address, v_address, data, pf_metadata); }
   };
   using set_type = std::vector<BLOCK>;
 
+  std::size_t find_fill_way(const mshr_type& fill_mshr);
+  request_type writeback_of(const BLOCK& victim, const mshr_type& fill_mshr) const;
+  uint32_t fill_way(const mshr_type& fill_mshr, std::size_t way_idx);
+
   std::pair<set_type::iterator, set_type::iterator> get_set_span(uint64_t address);
   std::pair<set_type::const_iterator, set_type::const_iterator> get_set_span(uint64_t address) const;
   std::size_t get_set_index(uint64_t address) const;
@@ -180,11 +206,23 @@ public:
   std::deque<mshr_type> MSHR;
   std::deque<mshr_type> inflight_writes;
 
+  // The steps of operate(), each timed by the self-profiler
+  enum class stage : std::size_t { collision, returns, translation, fill, tag_check, prefetcher, num_stages };
+  std::array<champsim::profiler::region, champsim::to_underlying(stage::num_stages)> stage_profile{};
+
   long operate() override final;
+  uint64_t next_event_cycle() const override final;
+  std::size_t input_occupancy() const override final;
+  long skip_operate() override final;
 
   void initialize() override final;
   void begin_phase() override final;
   void end_phase(unsigned cpu) override final;
+  void save_checkpoint(std::ostream& stream) override final;
+  void load_checkpoint(std::istream& stream) override final;
+  void clear_inflight() override final;
+  void save_inflight(std::ostream& stream) override final;
+  std::vector<std::pair<std::string, champsim::profiler::region>> profile() const override final;
 
   [[deprecated("get_occupancy() returns 0 for every input except 0 (MSHR). Use get_mshr_occupancy() instead.")]] std::size_t get_occupancy(uint8_t queue_type,
                                                                                                                                            uint64_t address);
@@ -213,6 +251,14 @@ public:
   uint64_t invalidate_entry(uint64_t inval_addr);
   int prefetch_line(uint64_t pf_addr, bool fill_this_level, uint32_t prefetch_metadata);
 
+  // Functional warming accesses the cache without modeling time. warm_access() checks the tags, training the prefetcher and replacement policy as a
+  // tag check would, and returns the data of the block on a hit. warm_fill() places a block after a miss, and returns the writeback of a dirty victim.
+  // The prefetches issued in the meantime are handed over by warm_prefetches(), which marks the ones that should not fill this level by not requesting
+  // a response.
+  std::optional<uint64_t> warm_access(const request_type& req, bool local_prefetch = false);
+  std::optional<request_type> warm_fill(const request_type& req, bool local_prefetch = false);
+  std::vector<request_type> warm_prefetches();
+
   [[deprecated("Use CACHE::prefetch_line(pf_addr, fill_this_level, prefetch_metadata) instead.")]] int
   prefetch_line(uint64_t ip, uint64_t base_addr, uint64_t pf_addr, bool fill_this_level, uint32_t prefetch_metadata);
 
@@ -229,6 +275,8 @@ public:
     virtual void impl_prefetcher_cycle_operate() = 0;
     virtual void impl_prefetcher_final_stats() = 0;
     virtual void impl_prefetcher_branch_operate(uint64_t ip, uint8_t branch_type, uint64_t branch_target) = 0;
+    virtual void impl_prefetcher_checkpoint(std::ostream& stream) = 0;
+    virtual void impl_prefetcher_restore(std::istream& stream) = 0;
 
     virtual void impl_initialize_replacement() = 0;
     virtual uint32_t impl_find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t ip, uint64_t full_addr,
@@ -236,6 +284,8 @@ public:
     virtual void impl_update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr,
                                                uint32_t type, uint8_t hit) = 0;
     virtual void impl_replacement_final_stats() = 0;
+    virtual void impl_checkpoint_replacement(std::ostream& stream) = 0;
+    virtual void impl_restore_replacement(std::istream& stream) = 0;
   };
 
   template <unsigned long long P_FLAG, unsigned long long R_FLAG>
@@ -249,6 +299,8 @@ public:
     void impl_prefetcher_cycle_operate();
     void impl_prefetcher_final_stats();
     void impl_prefetcher_branch_operate(uint64_t ip, uint8_t branch_type, uint64_t branch_target);
+    void impl_prefetcher_checkpoint(std::ostream& stream);
+    void impl_prefetcher_restore(std::istream& stream);
 
     void impl_initialize_replacement();
     uint32_t impl_find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t ip, uint64_t full_addr,
@@ -256,6 +308,8 @@ public:
     void impl_update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint32_t way, uint64_t full_addr, uint64_t ip, uint64_t victim_addr,
                                        uint32_t type, uint8_t hit);
     void impl_replacement_final_stats();
+    void impl_checkpoint_replacement(std::ostream& stream);
+    void impl_restore_replacement(std::istream& stream);
   };
 
   std::unique_ptr<module_concept> module_pimpl;
@@ -275,6 +329,8 @@ public:
   {
     module_pimpl->impl_prefetcher_branch_operate(ip, branch_type, branch_target);
   }
+  void impl_prefetcher_checkpoint(std::ostream& stream) { module_pimpl->impl_prefetcher_checkpoint(stream); }
+  void impl_prefetcher_restore(std::istream& stream) { module_pimpl->impl_prefetcher_restore(stream); }
 
   void impl_initialize_replacement() { module_pimpl->impl_initialize_replacement(); }
   uint32_t impl_find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t set, const BLOCK* current_set, uint64_t ip, uint64_t full_addr, uint32_t type)
@@ -287,6 +343,8 @@ public:
     module_pimpl->impl_update_replacement_state(triggering_cpu, set, way, full_addr, ip, victim_addr, type, hit);
   }
   void impl_replacement_final_stats() { module_pimpl->impl_replacement_final_stats(); }
+  void impl_checkpoint_replacement(std::ostream& stream) { module_pimpl->impl_checkpoint_replacement(stream); }
+  void impl_restore_replacement(std::istream& stream) { module_pimpl->impl_restore_replacement(stream); }
 
   class builder_conversion_tag
   {
@@ -297,7 +355,7 @@ public:
     using self_type = Builder<P_FLAG, R_FLAG>;
 
     std::string m_name{};
-    double m_freq_scale{};
+    champsim::clock_period m_freq_scale{};
     uint32_t m_sets{};
     uint32_t m_ways{};
     std::size_t m_pq_size{std::numeric_limits<std::size_t>::max()};
@@ -336,7 +394,7 @@ public:
       m_name = name_;
       return *this;
     }
-    self_type& frequency(double freq_scale_)
+    self_type& frequency(champsim::clock_period freq_scale_)
     {
       m_freq_scale = freq_scale_;
       return *this;
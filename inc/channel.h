@@ -131,6 +131,9 @@ public:
   std::size_t pq_size() const;
 
   void check_collision();
+
+  // Discard every request and response in the queues
+  void clear();
 };
 } // namespace champsim
 
@@ -0,0 +1,168 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "util/detect.h"
+
+namespace champsim
+{
+struct environment;
+class clock_calendar;
+class tracereader;
+
+/**
+ * Checkpoints hold the long-lived state of the simulator in native binary layout, so they may only be restored by a build of the same configuration.
+ *
+ * Pairs, tuples, optionals, and containers are stored member by member, and other trivially copyable values are copied directly. Other classes may
+ * take part by providing checkpoint_fields(), which returns a tuple of references to the members that should be saved.
+ */
+namespace checkpoint
+{
+namespace detail
+{
+template <typename T>
+using has_fields = decltype(std::declval<T&>().checkpoint_fields());
+
+template <typename T>
+using is_container = decltype(std::size(std::declval<T&>()), std::begin(std::declval<T&>()), std::end(std::declval<T&>()));
+
+template <typename T>
+using has_insert = decltype(std::declval<T&>().insert(std::end(std::declval<T&>()), std::declval<typename T::value_type>()));
+
+template <typename T>
+struct is_pair : std::false_type {
+};
+template <typename T, typename U>
+struct is_pair<std::pair<T, U>> : std::true_type {
+};
+
+template <typename T>
+struct is_tuple : std::false_type {
+};
+template <typename... Ts>
+struct is_tuple<std::tuple<Ts...>> : std::true_type {
+};
+
+template <typename T>
+struct is_optional : std::false_type {
+};
+template <typename T>
+struct is_optional<std::optional<T>> : std::true_type {
+};
+
+// The keys of associative containers are const, so their elements must be read into a mutable copy
+template <typename T>
+struct mutable_value {
+  using type = T;
+};
+template <typename T, typename U>
+struct mutable_value<std::pair<const T, U>> {
+  using type = std::pair<T, U>;
+};
+} // namespace detail
+
+template <typename T>
+void save(std::ostream& stream, const T& value)
+{
+  if constexpr (champsim::is_detected_v<detail::has_fields, const T>) {
+    save(stream, value.checkpoint_fields());
+  } else if constexpr (detail::is_pair<T>::value) {
+    save(stream, value.first);
+    save(stream, value.second);
+  } else if constexpr (detail::is_tuple<T>::value) {
+    std::apply([&stream](const auto&... members) { (save(stream, members), ...); }, value);
+  } else if constexpr (detail::is_optional<T>::value) {
+    save(stream, value.has_value());
+    if (value.has_value())
+      save(stream, *value);
+  } else if constexpr (std::is_trivially_copyable_v<T>) {
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  } else {
+    static_assert(champsim::is_detected_v<detail::is_container, const T>, "This type cannot be checkpointed");
+    save(stream, static_cast<uint64_t>(std::size(value)));
+    for (const auto& elem : value)
+      save(stream, elem);
+  }
+}
+
+template <typename T>
+void load(std::istream& stream, T& value)
+{
+  if constexpr (champsim::is_detected_v<detail::has_fields, T>) {
+    auto fields = value.checkpoint_fields();
+    load(stream, fields);
+  } else if constexpr (detail::is_pair<T>::value) {
+    load(stream, value.first);
+    load(stream, value.second);
+  } else if constexpr (detail::is_tuple<T>::value) {
+    std::apply([&stream](auto&... members) { (load(stream, members), ...); }, value);
+  } else if constexpr (detail::is_optional<T>::value) {
+    bool has_value = false;
+    load(stream, has_value);
+    value.reset();
+    if (has_value)
+      load(stream, value.emplace());
+  } else if constexpr (std::is_trivially_copyable_v<T>) {
+    stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+  } else {
+    static_assert(champsim::is_detected_v<detail::is_container, T>, "This type cannot be checkpointed");
+    uint64_t size = 0;
+    load(stream, size);
+    if constexpr (champsim::is_detected_v<detail::has_insert, T>) {
+      value.clear();
+      for (uint64_t i = 0; i < size && stream; ++i) {
+        typename detail::mutable_value<typename T::value_type>::type elem{};
+        load(stream, elem);
+        value.insert(std::end(value), std::move(elem));
+      }
+    } else {
+      // Fixed-size containers must match
+      if (size != std::size(value))
+        throw std::runtime_error("Checkpoint does not match the configuration");
+      for (auto& elem : value)
+        load(stream, elem);
+    }
+  }
+
+  if (!stream)
+    throw std::runtime_error("Checkpoint is truncated");
+}
+
+// Save the environment at a phase boundary. In-flight work, such as queued packets and the contents of the pipeline, is not saved. Instead, the trace
+// position of each core is saved just past its last retired instruction, so that instructions in flight are read again after a restore. Cores that
+// are not given a trace are saved at the start of their trace.
+void save_environment(std::ostream& stream, environment& env, const clock_calendar& calendar, const std::vector<tracereader>& traces,
+                      const std::vector<std::size_t>& trace_index);
+
+// Restore an environment saved by save_environment(), and advance each core's trace to its saved position
+void load_environment(std::istream& stream, environment& env, clock_calendar& calendar, std::vector<tracereader>& traces,
+                      const std::vector<std::size_t>& trace_index);
+} // namespace checkpoint
+} // namespace champsim
+
+#endif
@@ -0,0 +1,63 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CLOCK_CALENDAR_H
+#define CLOCK_CALENDAR_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "operable.h"
+
+namespace champsim
+{
+
+/**
+ * A repeating schedule of the operables that are due on each tick of the fastest clock.
+ *
+ * The schedule is built once from the integer clock periods, and repeats after the least common multiple of their tick counts.
+ * Within each tick, operables run in order of how far their clock edge lags the tick. Ties keep the order of the previous tick,
+ * starting from the order the operables were given.
+ */
+class clock_calendar
+{
+  using value_type = std::vector<std::reference_wrapper<operable>>;
+  std::vector<value_type> schedule;
+  std::size_t period_length = 1;
+  std::size_t repeat_from = 0;
+  std::size_t position = 0;
+  uint64_t ticks_elapsed = 0;
+
+public:
+  explicit clock_calendar(value_type operables);
+
+  // The number of ticks before the schedule repeats
+  std::size_t hyperperiod() const;
+
+  // The operables due on the next tick, in the order they should operate
+  const value_type& next_tick();
+
+  // The number of ticks issued so far
+  uint64_t elapsed() const;
+
+  // Continue the schedule as if the given number of ticks had been issued. Calendars built from subsets of the same operables stay in step this way.
+  void seek(uint64_t tick);
+};
+
+} // namespace champsim
+
+#endif
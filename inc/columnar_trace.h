@@ -0,0 +1,266 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef COLUMNAR_TRACE_H
+#define COLUMNAR_TRACE_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "trace_instruction.h"
+
+/**
+ * The columnar trace format stores instructions in blocks. Within a block, each field of the instructions is stored together with the same field of
+ * the others, so that a general-purpose compressor sees similar bytes next to each other:
+ *
+ *  - the instruction pointers, as varint differences from the previous instruction,
+ *  - the branch flags and the number of each kind of operand, in two bytes for each instruction,
+ *  - the registers, one byte each,
+ *  - the memory addresses, as varint differences from the previous address in the block,
+ *  - for cloudsuite traces, the address space identifiers.
+ *
+ * Empty (zero) register and memory slots are not stored. Each block starts over from zero, so that whole blocks can be skipped without being decoded.
+ * The file is usually compressed further, as any other trace.
+ */
+namespace champsim::columnar
+{
+constexpr std::array<char, 4> magic{'C', 'S', 'T', 'R'};
+constexpr uint8_t version = 2;
+constexpr std::size_t header_size = std::size(magic) + 2;
+constexpr std::size_t default_block_instructions = 4096;
+
+enum class record_kind : uint8_t { standard = 0, cloudsuite = 1 };
+
+namespace detail
+{
+inline void put_varint(std::vector<char>& dest, uint64_t value)
+{
+  for (; value >= 0x80; value >>= 7)
+    dest.push_back(static_cast<char>((value & 0x7f) | 0x80));
+  dest.push_back(static_cast<char>(value));
+}
+
+// Read a varint from a stream, one byte at a time. Returns false if the stream ends first.
+template <typename IStrm>
+bool read_varint(IStrm& src, uint64_t& value)
+{
+  value = 0;
+  for (unsigned shift = 0; shift < 64; shift += 7) {
+    char byte;
+    src.read(&byte, 1);
+    if (src.gcount() != 1)
+      return false;
+    value |= uint64_t{static_cast<unsigned char>(byte) & 0x7fu} << shift;
+    if ((static_cast<unsigned char>(byte) & 0x80) == 0)
+      return true;
+  }
+  throw std::runtime_error{"Malformed columnar trace"};
+}
+
+inline bool valid_header(const std::array<char, header_size>& header)
+{
+  return std::equal(std::begin(magic), std::end(magic), std::begin(header)) && static_cast<uint8_t>(header[std::size(magic)]) == version;
+}
+} // namespace detail
+
+// Decode a block body into records. Throws std::runtime_error if the body is malformed.
+void decode_block(const char* body, std::size_t size, uint64_t count, std::vector<input_instr>& dest);
+void decode_block(const char* body, std::size_t size, uint64_t count, std::vector<cloudsuite_instr>& dest);
+
+// Check whether a stream starts with the header of a columnar trace
+template <typename IStrm>
+bool has_header(IStrm&& src)
+{
+  std::array<char, header_size> header;
+  src.read(std::data(header), std::size(header));
+  return src.gcount() == static_cast<std::streamsize>(std::size(header)) && detail::valid_header(header);
+}
+
+/**
+ * A stream whose first bytes are read when it is opened, to check for the header of a columnar trace. Those bytes are returned again before the rest
+ * of the stream, so that a trace in either format is read from the stream that was checked.
+ */
+template <typename IStrm>
+class peeked_stream
+{
+  IStrm source;
+  std::array<char, header_size> prefix{};
+  std::size_t prefix_begin = 0;
+  std::size_t prefix_end = 0;
+  std::streamsize gcount_ = 0;
+
+  // Take up to count bytes from the prefix, and copy them to the destination if it is not null
+  std::size_t take_prefix(char* dest, std::streamsize count)
+  {
+    auto taken = std::min(static_cast<std::size_t>(count), prefix_end - prefix_begin);
+    if (dest != nullptr)
+      std::copy_n(std::next(std::begin(prefix), static_cast<std::ptrdiff_t>(prefix_begin)), taken, dest);
+    prefix_begin += taken;
+    return taken;
+  }
+
+public:
+  explicit peeked_stream(IStrm&& src) : source(std::move(src))
+  {
+    source.read(std::data(prefix), std::size(prefix));
+    prefix_end = static_cast<std::size_t>(source.gcount());
+  }
+  explicit peeked_stream(std::string name) : peeked_stream(IStrm{name}) {}
+
+  bool has_header() const { return prefix_end == header_size && detail::valid_header(prefix); }
+
+  peeked_stream& read(char* s, std::streamsize count)
+  {
+    auto taken = take_prefix(s, count);
+    gcount_ = static_cast<std::streamsize>(taken);
+    if (static_cast<std::streamsize>(taken) < count) {
+      source.read(s + taken, count - static_cast<std::streamsize>(taken));
+      gcount_ += source.gcount();
+    }
+    return *this;
+  }
+
+  peeked_stream& ignore(std::streamsize count)
+  {
+    auto taken = take_prefix(nullptr, count);
+    gcount_ = static_cast<std::streamsize>(taken);
+    if (static_cast<std::streamsize>(taken) < count) {
+      source.ignore(count - static_cast<std::streamsize>(taken));
+      gcount_ += source.gcount();
+    }
+    return *this;
+  }
+
+  bool eof() const { return prefix_begin == prefix_end && source.eof(); }
+  std::streamsize gcount() const { return gcount_; }
+};
+
+/**
+ * Writes a columnar trace. The records are kept until a block is full, or until flush() is called.
+ */
+class writer
+{
+  std::ostream& dest;
+  record_kind kind_;
+  std::size_t block_instructions;
+
+  uint64_t count = 0;
+  uint64_t last_ip = 0;
+  uint64_t last_address = 0;
+  std::vector<char> ip_column{};
+  std::vector<char> shape_column{};
+  std::vector<char> register_column{};
+  std::vector<char> memory_column{};
+  std::vector<char> asid_column{};
+
+  template <typename T>
+  void append(const T& instr);
+
+public:
+  writer(std::ostream& d, record_kind k, std::size_t block_instr = default_block_instructions);
+
+  record_kind kind() const { return kind_; }
+
+  // Throws std::invalid_argument if the record does not match the kind of the trace
+  void write(const input_instr& instr);
+  void write(const cloudsuite_instr& instr);
+
+  // Write the records that are kept as a block
+  void flush();
+};
+
+/**
+ * Reads a columnar trace block by block. The header of each block is read when the block before it is, so that the end of the trace is known as
+ * soon as the last block is read.
+ */
+template <typename IStrm>
+class block_reader
+{
+  IStrm source;
+  record_kind kind_ = record_kind::standard;
+  uint64_t next_count = 0;
+  uint64_t next_size = 0;
+  bool eof_ = false;
+  std::vector<char> body{};
+
+  void read_block_header()
+  {
+    eof_ = !detail::read_varint(source, next_count) || !detail::read_varint(source, next_size);
+    if (eof_)
+      next_count = next_size = 0;
+  }
+
+public:
+  // Throws std::runtime_error if the stream is not a columnar trace
+  explicit block_reader(IStrm&& src) : source(std::move(src))
+  {
+    std::array<char, header_size> header;
+    source.read(std::data(header), std::size(header));
+    if (source.gcount() != static_cast<std::streamsize>(std::size(header)) || !detail::valid_header(header))
+      throw std::runtime_error{"The trace is not in the columnar format"};
+
+    kind_ = static_cast<record_kind>(header[std::size(magic) + 1]);
+    if (kind_ != record_kind::standard && kind_ != record_kind::cloudsuite)
+      throw std::runtime_error{"The columnar trace holds an unknown kind of record"};
+
+    read_block_header();
+  }
+
+  record_kind kind() const { return kind_; }
+
+  // The number of instructions in the next block
+  uint64_t next_block_count() const { return next_count; }
+
+  // Decode the next block and append its records. A block that is cut short ends the trace.
+  template <typename T>
+  void read_block(std::vector<T>& dest)
+  {
+    if (eof_)
+      return;
+
+    body.resize(next_size);
+    source.read(std::data(body), static_cast<std::streamsize>(next_size));
+    if (static_cast<uint64_t>(source.gcount()) == next_size)
+      decode_block(std::data(body), std::size(body), next_count, dest);
+    read_block_header();
+  }
+
+  // Discard the next block without decoding it. Returns the number of instructions that were discarded.
+  uint64_t skip_block()
+  {
+    if (eof_)
+      return 0;
+
+    auto count = next_count;
+    source.ignore(static_cast<std::streamsize>(next_size));
+    if (static_cast<uint64_t>(source.gcount()) != next_size)
+      count = 0;
+    read_block_header();
+    return count;
+  }
+
+  bool eof() const { return eof_; }
+};
+} // namespace champsim::columnar
+
+#endif
@@ -0,0 +1,118 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef COLUMNAR_TRACEREADER_H
+#define COLUMNAR_TRACEREADER_H
+
+#include <algorithm>
+#include <deque>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "columnar_trace.h"
+#include "instruction.h"
+#include "tracereader.h"
+
+namespace champsim
+{
+/**
+ * Reads traces in the columnar format. The format of the records is read from the trace, so the same reader serves standard and cloudsuite traces.
+ */
+template <typename F>
+class columnar_tracereader
+{
+  uint8_t cpu;
+  columnar::block_reader<F> blocks;
+
+  constexpr static std::size_t refresh_thresh = 1;
+  std::deque<ooo_model_instr> instr_buffer;
+
+  template <typename T>
+  void decode_next()
+  {
+    std::vector<T> records;
+    blocks.read_block(records);
+    std::transform(std::begin(records), std::end(records), std::back_inserter(instr_buffer), [cpu = this->cpu](T t) { return ooo_model_instr{cpu, t}; });
+  }
+
+  void refill()
+  {
+    // The last instruction that was kept is the first whose branch target can now be set
+    auto first_unset = std::empty(instr_buffer) ? std::size_t{0} : std::size(instr_buffer) - 1;
+    while (std::size(instr_buffer) <= refresh_thresh && !blocks.eof()) {
+      if (blocks.kind() == columnar::record_kind::cloudsuite)
+        decode_next<cloudsuite_instr>();
+      else
+        decode_next<input_instr>();
+    }
+
+    // As in set_branch_targets(), but in place, and only for the new instructions
+    for (auto i = first_unset; i + 1 < std::size(instr_buffer); ++i) {
+      auto& branch = instr_buffer[i];
+      branch.branch_target = (branch.is_branch && branch.branch_taken) ? instr_buffer[i + 1].ip : 0;
+    }
+  }
+
+public:
+  columnar_tracereader(uint8_t cpu_idx, std::string tf) : cpu(cpu_idx), blocks(F{tf}) {}
+  columnar_tracereader(uint8_t cpu_idx, F&& file) : cpu(cpu_idx), blocks(std::move(file)) {}
+
+  ooo_model_instr operator()()
+  {
+    if (std::size(instr_buffer) <= refresh_thresh)
+      refill();
+
+    if (std::empty(instr_buffer))
+      return ooo_model_instr{cpu, input_instr{}};
+
+    auto retval = std::move(instr_buffer.front());
+    instr_buffer.pop_front();
+    return retval;
+  }
+
+  // Whole blocks are skipped without being decoded
+  uint64_t skip(uint64_t count)
+  {
+    uint64_t skipped = 0;
+    for (; skipped < count && !std::empty(instr_buffer); ++skipped)
+      instr_buffer.pop_front();
+
+    while (!blocks.eof() && blocks.next_block_count() <= count - skipped) {
+      auto progress = blocks.skip_block();
+      if (progress == 0)
+        break;
+      skipped += progress;
+    }
+
+    for (; skipped < count; ++skipped) {
+      if (std::empty(instr_buffer))
+        refill();
+      if (std::empty(instr_buffer))
+        break;
+      instr_buffer.pop_front();
+    }
+
+    return skipped;
+  }
+
+  // The last instruction is kept, like the last buffered instruction of a bulk_tracereader, since its successor is unknown
+  bool eof() const { return blocks.eof() && std::size(instr_buffer) <= refresh_thresh; }
+};
+} // namespace champsim
+
+#endif
@@ -0,0 +1,230 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef DECODED_CACHE_H
+#define DECODED_CACHE_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "instruction.h"
+#include "mapped_tracereader.h"
+
+/**
+ * The decoded cache holds instructions as the trace readers produce them: with their empty slots removed, their branch type found, and their branch
+ * target set. A run that finds no cache for its trace records the instructions that it reads. Later runs replay them from the cache, without
+ * inflating or decoding the trace, and continue from the trace itself if they read further.
+ *
+ * The cache of a trace is named after a hash of the contents of the trace file, so that a changed trace is not replayed from a stale cache.
+ */
+namespace champsim::decoded_cache
+{
+constexpr std::array<char, 4> magic{'C', 'S', 'D', 'C'};
+constexpr uint8_t version = 1;
+constexpr std::size_t header_size = 32;
+constexpr std::size_t fixed_record_size = 22;
+
+struct header {
+  bool cloudsuite = false;
+  bool complete = false; // The cache holds every instruction of the trace
+  uint32_t source_crc = 0;
+  uint64_t source_size = 0;
+  uint64_t count = 0;
+};
+
+std::array<char, header_size> encode_header(const header& info);
+std::optional<header> decode_header(const char* data, std::size_t size);
+
+struct entry {
+  std::string name; // The file that holds the cache
+  header expected;  // The trace that the cache must match
+  bool exists = false;
+};
+
+// Find the cache of a trace in the given directory. The whole trace file is read, to hash it. Returns nothing if the trace cannot be read.
+std::optional<entry> find(const std::string& directory, const std::string& trace_name, bool cloudsuite);
+
+// Whether the cache of the entry holds instructions of its trace. The trace is not read again.
+bool published(const entry& e);
+
+// Encode an instruction at the end of the buffer
+void append_record(std::vector<char>& dest, const ooo_model_instr& instr);
+
+// The size of the record that starts at the given position, which holds at least the fixed part of a record
+inline std::size_t record_size(const char* record)
+{
+  auto registers = static_cast<unsigned char>(record[20]);
+  auto memory = static_cast<unsigned char>(record[21]);
+  return fixed_record_size + (registers & 0xfu) + (registers >> 4) + sizeof(uint64_t) * ((memory & 0xfu) + (memory >> 4));
+}
+
+// Decode the record at the given position. Standard traces take their address space from the cpu.
+ooo_model_instr read_record(const char* record, uint8_t cpu, bool cloudsuite);
+
+/**
+ * Writes the instructions that are read from a trace into a temporary file, which becomes the cache when the recording is destroyed.
+ */
+class recording
+{
+  entry target;
+  std::string temp_name;
+  std::ofstream file;
+  std::vector<char> buffer{};
+  uint64_t count = 0;
+  bool stopped = false;
+  bool complete = false;
+
+  void write_buffer();
+
+public:
+  explicit recording(entry e);
+  recording(const recording&) = delete;
+  recording& operator=(const recording&) = delete;
+  ~recording();
+
+  // Instructions that are read after the end of the trace are not recorded
+  void append(const ooo_model_instr& instr);
+
+  // The cache holds only the instructions before the first skip, since those after it are not decoded
+  void stop() { stopped = true; }
+
+  // The trace ended, so every instruction was recorded
+  void finish() { complete = !stopped; }
+};
+
+/**
+ * Passes the instructions of a reader through, and records them into the cache.
+ */
+template <typename R>
+class recording_reader
+{
+  R source;
+  std::unique_ptr<recording> out;
+
+public:
+  recording_reader(entry e, R&& reader) : source(std::move(reader)), out(std::make_unique<recording>(std::move(e))) {}
+
+  ooo_model_instr operator()()
+  {
+    auto retval = source();
+    out->append(retval);
+    return retval;
+  }
+
+  uint64_t skip(uint64_t count)
+  {
+    out->stop();
+    return source.skip(count);
+  }
+
+  bool eof() const
+  {
+    auto result = source.eof();
+    if (result)
+      out->finish();
+    return result;
+  }
+};
+
+/**
+ * Replays the instructions in the cache, then continues from the reader of the trace. The reader is moved past the cached instructions only if they
+ * are all read.
+ */
+template <typename R>
+class replay_reader
+{
+  uint8_t cpu;
+  mapped_file file;
+  header info{};
+  std::size_t position = header_size;
+  uint64_t remaining = 0;
+  R source;
+  bool caught_up = false;
+
+  void next_record()
+  {
+    // A record that does not fit ends the cache early, so the rest is read from the trace
+    if (position + fixed_record_size > file.size() || position + record_size(file.data() + position) > file.size()) {
+      info.count -= remaining;
+      info.complete = false;
+      remaining = 0;
+    }
+  }
+
+  void catch_up()
+  {
+    if (!caught_up)
+      source.skip(info.count);
+    caught_up = true;
+  }
+
+public:
+  replay_reader(const entry& e, uint8_t cpu_idx, R&& reader) : cpu(cpu_idx), file(e.name), source(std::move(reader))
+  {
+    auto found = decode_header(file.data(), file.size());
+    if (found.has_value() && found->cloudsuite == e.expected.cloudsuite && found->source_crc == e.expected.source_crc
+        && found->source_size == e.expected.source_size) {
+      info = *found;
+      remaining = info.count;
+    }
+    if (remaining > 0)
+      next_record();
+  }
+
+  ooo_model_instr operator()()
+  {
+    if (remaining == 0) {
+      catch_up();
+      return source();
+    }
+
+    file.advance_to(position);
+    auto retval = read_record(file.data() + position, cpu, info.cloudsuite);
+    position += record_size(file.data() + position);
+    if (--remaining > 0)
+      next_record();
+    return retval;
+  }
+
+  uint64_t skip(uint64_t count)
+  {
+    uint64_t skipped = 0;
+    for (; skipped < count && remaining > 0; ++skipped) {
+      position += record_size(file.data() + position);
+      if (--remaining > 0)
+        next_record();
+    }
+
+    if (skipped < count && !(info.complete && remaining == 0)) {
+      catch_up();
+      skipped += source.skip(count - skipped);
+    }
+    return skipped;
+  }
+
+  // An incomplete cache ends before the last instruction of the trace, so the trace has not ended until it is read
+  bool eof() const { return remaining == 0 && (info.complete || (caught_up && source.eof())); }
+};
+} // namespace champsim::decoded_cache
+
+#endif
@@ -19,9 +19,11 @@
 
 #include <array>
 #include <cmath>
+#include <iosfwd>
 #include <limits>
 #include <optional>
 #include <string>
+#include <tuple>
 
 #include "champsim_constants.h"
 #include "channel.h"
@@ -32,8 +34,21 @@ struct dram_stats {
   uint64_t dbus_cycle_congested = 0, dbus_count_congested = 0;
 
   unsigned WQ_ROW_BUFFER_HIT = 0, WQ_ROW_BUFFER_MISS = 0, RQ_ROW_BUFFER_HIT = 0, RQ_ROW_BUFFER_MISS = 0, WQ_FULL = 0;
+
+  // The members to transfer with the checkpoint serializer
+  auto checkpoint_fields() const
+  {
+    return std::tie(name, dbus_cycle_congested, dbus_count_congested, WQ_ROW_BUFFER_HIT, WQ_ROW_BUFFER_MISS, RQ_ROW_BUFFER_HIT, RQ_ROW_BUFFER_MISS, WQ_FULL);
+  }
+  auto checkpoint_fields()
+  {
+    return std::tie(name, dbus_cycle_congested, dbus_count_congested, WQ_ROW_BUFFER_HIT, WQ_ROW_BUFFER_MISS, RQ_ROW_BUFFER_HIT, RQ_ROW_BUFFER_MISS, WQ_FULL);
+  }
 };
 
+// Combine the stats of two phases, as if they had run back to back
+dram_stats operator+(dram_stats lhs, const dram_stats& rhs);
+
 struct DRAM_CHANNEL {
   using response_type = typename champsim::channel::response_type;
   struct request_type {
@@ -87,8 +102,11 @@ class MEMORY_CONTROLLER : public champsim::operable
   using channel_type = champsim::channel;
   using request_type = typename channel_type::request_type;
   using response_type = typename channel_type::response_type;
+
+public:
   std::vector<channel_type*> queues;
 
+private:
   // Latencies
   const uint64_t tRP, tRCD, tCAS, DRAM_DBUS_TURN_AROUND_TIME, DRAM_DBUS_RETURN_TIME;
 
@@ -104,21 +122,29 @@ class MEMORY_CONTROLLER : public champsim::operable
 public:
   std::array<DRAM_CHANNEL, DRAM_CHANNELS> channels;
 
-  MEMORY_CONTROLLER(double freq_scale, int io_freq, double t_rp, double t_rcd, double t_cas, double turnaround, std::vector<channel_type*>&& ul);
+  MEMORY_CONTROLLER(champsim::clock_period freq_scale, int io_freq, double t_rp, double t_rcd, double t_cas, double turnaround, std::vector<channel_type*>&& ul);
 
   void initialize() override final;
   long operate() override final;
+  uint64_t next_event_cycle() const override final;
+  std::size_t input_occupancy() const override final;
+  long skip_operate() override final;
   void begin_phase() override final;
   void end_phase(unsigned cpu) override final;
   void print_deadlock() override final;
+  void save_checkpoint(std::ostream& stream) override final;
+  void load_checkpoint(std::istream& stream) override final;
+  void clear_inflight() override final;
+  void save_inflight(std::ostream& stream) override final;
+  std::vector<std::pair<std::string, champsim::profiler::region>> profile() const override final;
 
   std::size_t size() const;
 
-  uint32_t dram_get_channel(uint64_t address);
-  uint32_t dram_get_rank(uint64_t address);
-  uint32_t dram_get_bank(uint64_t address);
-  uint32_t dram_get_row(uint64_t address);
-  uint32_t dram_get_column(uint64_t address);
+  uint32_t dram_get_channel(uint64_t address) const;
+  uint32_t dram_get_rank(uint64_t address) const;
+  uint32_t dram_get_bank(uint64_t address) const;
+  uint32_t dram_get_row(uint64_t address) const;
+  uint32_t dram_get_column(uint64_t address) const;
 };
 
 #endif
@@ -0,0 +1,54 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef FORKING_H
+#define FORKING_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace champsim
+{
+/**
+ * A forked child shares the offset of every file that it inherits, so a trace read by both processes would be read by neither. Before forking, this
+ * opens a second description of each file that the process is reading, at the same offset. The parent adopts these afterward, leaving the originals
+ * to the child.
+ */
+class file_offsets
+{
+  std::vector<std::pair<int, int>> copies; // The original descriptor, and its copy
+
+public:
+  file_offsets();
+  ~file_offsets();
+
+  file_offsets(const file_offsets&) = delete;
+  file_offsets& operator=(const file_offsets&) = delete;
+
+  // Replace each original descriptor with its copy
+  void adopt();
+};
+
+// Write all of the data to the descriptor, retrying partial and interrupted writes. Returns false if the write fails.
+bool write_all(int fd, const std::string& data);
+
+// Read from the descriptor until the end of the file, retrying interrupted reads
+std::string read_all(int fd);
+} // namespace champsim
+
+#endif
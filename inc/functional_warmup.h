@@ -0,0 +1,72 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FUNCTIONAL_WARMUP_H
+#define FUNCTIONAL_WARMUP_H
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <vector>
+
+#include "channel.h"
+#include "environment.h"
+#include "instruction.h"
+
+namespace champsim
+{
+/**
+ * Functional warming streams instructions through the branch predictors, TLBs, and caches without the pipeline, and without the passage of time.
+ * An access goes down the hierarchy as far as it misses, and fills each level on the way back up, so that tags, replacement state, and prefetchers
+ * are trained in program order. The last-level TLB walks the page table directly, and the page table entries it reads are accessed like data.
+ */
+class functional_warmup
+{
+  using request_type = channel::request_type;
+
+  struct level {
+    CACHE* cache;
+    level* lower = nullptr;            // The next cache, or nullptr if misses go to memory
+    level* translation = nullptr;      // The first TLB, for caches that are accessed by virtual address
+    PageTableWalker* walker = nullptr; // The page table walker behind a last-level TLB
+    level* walker_lower = nullptr;     // The cache that the page table walker reads from
+  };
+
+  struct core {
+    O3_CPU* cpu;
+    level* l1i;
+    level* l1d;
+    uint64_t last_fetch_block = std::numeric_limits<uint64_t>::max();
+  };
+
+  std::deque<level> levels;
+  std::vector<core> cores;
+
+  // Each returns the data of the block, which the TLBs use to hold translations
+  uint64_t access(level& lvl, const request_type& req, bool local_prefetch = false);
+  uint64_t miss(level& lvl, const request_type& req);
+  uint64_t translate(level& lvl, uint32_t cpu, uint64_t v_address);
+  request_type access_packet(level& lvl, uint32_t cpu, const ooo_model_instr& instr, uint64_t v_address, access_type type);
+
+public:
+  explicit functional_warmup(environment& env);
+
+  // Warm the core's predictors and caches with the instruction, and count it as retired
+  void operate(O3_CPU& cpu, ooo_model_instr& instr);
+};
+} // namespace champsim
+
+#endif
@@ -17,15 +17,23 @@
 #ifndef INF_STREAM_H
 #define INF_STREAM_H
 
+#include <array>
+#include <atomic>
 #include <bzlib.h>
 #include <cassert>
+#include <cstring>
 #include <iostream>
+#include <limits>
 #include <lzma.h>
 #include <memory>
 #include <zlib.h>
+#include <zstd.h>
 
 namespace champsim
 {
+// The number of threads that may inflate each trace. Only xz traces of several blocks, and gzip traces of several members, are inflated in parallel.
+inline std::atomic<unsigned> inflate_threads{1};
+
 namespace decomp_tags
 {
 enum class status_t { CAN_CONTINUE, END, ERROR };
@@ -40,6 +48,29 @@ struct end_deleter {
     delete s;
   }
 };
+
+// zstd keeps its buffers outside of its stream state. This gathers them, so that it can be driven like the other libraries.
+template <typename Context>
+struct zstd_stream {
+  Context* context;
+  const char* next_in = nullptr;
+  std::size_t avail_in = 0;
+  char* next_out = nullptr;
+  std::size_t avail_out = 0;
+  std::size_t total_out = 0;
+
+  void advance(const ZSTD_inBuffer& in, const ZSTD_outBuffer& out)
+  {
+    next_in += in.pos;
+    avail_in -= in.pos;
+    next_out += out.pos;
+    avail_out -= out.pos;
+    total_out += out.pos;
+  }
+};
+
+inline std::size_t free_zstd_stream(zstd_stream<ZSTD_CStream>* s) { return ::ZSTD_freeCStream(s->context); }
+inline std::size_t free_zstd_stream(zstd_stream<ZSTD_DStream>* s) { return ::ZSTD_freeDStream(s->context); }
 } // namespace detail
 
 struct bzip2_tag_t {
@@ -102,9 +133,19 @@ struct gzip_tag_t {
     return status_type::ERROR;
   }
 
+  // A stream of several gzip members is inflated as if it were one. Anything after the last member that is not another member ends the stream.
   static status_type inflate(inflate_state_type& x)
   {
-    ::inflate(x.get(), Z_BLOCK);
+    auto ret = ::inflate(x.get(), Z_BLOCK);
+    if (ret == Z_STREAM_END) {
+      auto total_in = x->total_in;
+      auto total_out = x->total_out;
+      ::inflateReset(x.get());
+      x->total_in = total_in;
+      x->total_out = total_out;
+    }
+    if (ret == Z_DATA_ERROR || ret == Z_STREAM_ERROR || ret == Z_MEM_ERROR || ret == Z_NEED_DICT)
+      return status_type::ERROR;
     return status_type::CAN_CONTINUE;
   }
 
@@ -169,11 +210,74 @@ struct lzma_tag_t {
   {
     inflate_state_type state{new state_type};
     *state = LZMA_STREAM_INIT;
+#if LZMA_VERSION >= 50040002
+    // The threaded decoder inflates the blocks of a stream in parallel, if the sizes of the blocks are recorded in their headers. It falls back to a
+    // single thread otherwise.
+    if (auto threads = inflate_threads.load(std::memory_order_relaxed); threads > 1) {
+      lzma_mt options{};
+      options.flags = flags;
+      options.threads = threads;
+      options.memlimit_threading = ::lzma_physmem() / 4;
+      options.memlimit_stop = std::numeric_limits<uint64_t>::max();
+      auto ret = ::lzma_stream_decoder_mt(state.get(), &options);
+      assert(ret == LZMA_OK);
+      return state;
+    }
+#endif
     auto ret = ::lzma_stream_decoder(state.get(), std::numeric_limits<uint64_t>::max(), flags);
     assert(ret == LZMA_OK);
     return state;
   }
 };
+
+template <int level = 19>
+struct zstd_tag_t {
+  using deflate_stream_type = detail::zstd_stream<ZSTD_CStream>;
+  using inflate_stream_type = detail::zstd_stream<ZSTD_DStream>;
+  using in_char_type = char;
+  using out_char_type = char;
+  using deflate_state_type = std::unique_ptr<deflate_stream_type, detail::end_deleter<deflate_stream_type, std::size_t, detail::free_zstd_stream>>;
+  using inflate_state_type = std::unique_ptr<inflate_stream_type, detail::end_deleter<inflate_stream_type, std::size_t, detail::free_zstd_stream>>;
+  using status_type = status_t;
+
+  static status_type deflate(deflate_state_type& x, bool flush)
+  {
+    ZSTD_inBuffer in{x->next_in, x->avail_in, 0};
+    ZSTD_outBuffer out{x->next_out, x->avail_out, 0};
+    auto ret = ::ZSTD_compressStream2(x->context, &out, &in, flush ? ZSTD_e_end : ZSTD_e_continue);
+    x->advance(in, out);
+    if (::ZSTD_isError(ret))
+      return status_type::ERROR;
+    return (flush && ret == 0) ? status_type::END : status_type::CAN_CONTINUE;
+  }
+
+  // The stream may hold several frames, which are inflated one after another
+  static status_type inflate(inflate_state_type& x)
+  {
+    ZSTD_inBuffer in{x->next_in, x->avail_in, 0};
+    ZSTD_outBuffer out{x->next_out, x->avail_out, 0};
+    auto ret = ::ZSTD_decompressStream(x->context, &out, &in);
+    x->advance(in, out);
+    if (::ZSTD_isError(ret))
+      return status_type::ERROR;
+    return (ret == 0) ? status_type::END : status_type::CAN_CONTINUE;
+  }
+
+  static deflate_state_type new_deflate_state()
+  {
+    deflate_state_type state{new deflate_stream_type{::ZSTD_createCStream()}};
+    ::ZSTD_CCtx_setParameter(state->context, ZSTD_c_compressionLevel, level);
+    return state;
+  }
+
+  static inflate_state_type new_inflate_state()
+  {
+    inflate_state_type state{new inflate_stream_type{::ZSTD_createDStream()}};
+    auto ret = ::ZSTD_initDStream(state->context);
+    assert(!::ZSTD_isError(ret));
+    return state;
+  }
+};
 } // namespace decomp_tags
 
 template <typename Tag, typename StreamType = std::ifstream>
@@ -219,6 +323,24 @@ struct inf_istream {
     return *this;
   }
 
+  inf_istream& ignore(std::streamsize count)
+  {
+    std::istream inflated{buffer.get()};
+    inflated.ignore(count);
+    gcount_ = inflated.gcount();
+    eof_ = inflated.eof();
+    return *this;
+  }
+
+  // Inflate again from the given offset of the underlying stream, which must be the start of an independently compressed frame
+  void restart_at(std::streamoff offset)
+  {
+    underlying->clear();
+    underlying->seekg(offset);
+    buffer = std::make_unique<inf_streambuf<StreamType>>(underlying.get());
+    eof_ = false;
+  }
+
   bool eof() const { return eof_; }
   std::streamsize gcount() const { return gcount_; }
 
@@ -236,13 +358,7 @@ auto inf_istream<T, S>::inf_streambuf<I>::underflow() -> int_type
   strm->next_out = uns_out_buf.data();
   do {
     // Check to see if we have consumed all available input
-    if (strm->avail_in == 0) {
-      // Check to see if the input stream is sane
-      if (src->fail()) {
-        this->setg(this->out_buf.data(), this->out_buf.data(), this->out_buf.data());
-        return base_type::underflow();
-      }
-
+    if (strm->avail_in == 0 && !src->fail()) {
       // Read data from the stream and convert to zlib-appropriate format
       std::array<char_type, std::tuple_size<decltype(in_buf)>::value> sig_in_buf;
       src->read(sig_in_buf.data(), sig_in_buf.size());
@@ -253,17 +369,18 @@ auto inf_istream<T, S>::inf_streambuf<I>::underflow() -> int_type
       // Record that bytes are available in in_buf
       strm->avail_in = static_cast<unsigned>(src->gcount());
       strm->next_in = in_buf.data();
-
-      // If we failed to get any data
-      if (strm->avail_in == 0) {
-        this->setg(this->out_buf.data(), this->out_buf.data(), this->out_buf.data());
-        return base_type::underflow();
-      }
     }
 
-    // Perform inflation
+    // Perform inflation. Without new input, this drains the output that the inflater may still hold from input it has already consumed. Input that
+    // cannot be inflated ends the stream.
     auto result = T::inflate(strm);
-    assert(result == T::status_type::CAN_CONTINUE || result == T::status_type::END);
+    bool at_end = (strm->avail_in == 0 && src->fail()) || result == T::status_type::ERROR;
+    if (at_end && strm->avail_out == uns_out_buf.size()) {
+      this->setg(this->out_buf.data(), this->out_buf.data(), this->out_buf.data());
+      return base_type::underflow();
+    }
+    if (result == T::status_type::ERROR)
+      break;
   }
   // Repeat until we actually get new output
   while (strm->avail_out == uns_out_buf.size());
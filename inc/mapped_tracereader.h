@@ -0,0 +1,117 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef MAPPED_TRACEREADER_H
+#define MAPPED_TRACEREADER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+#include "instruction.h"
+
+namespace champsim
+{
+/**
+ * A read-only mapping of a whole file. Processes that map the same file share its pages in the page cache.
+ */
+class mapped_file
+{
+  const char* data_ = nullptr;
+  std::size_t size_ = 0;
+  std::size_t advised_ = 0; // The end of the region that the kernel was asked to read ahead
+
+public:
+  // The kernel is asked to read this far ahead of the reader
+  constexpr static std::size_t readahead_size = std::size_t{16} << 20;
+
+  explicit mapped_file(const std::string& fname);
+  mapped_file(const mapped_file&) = delete;
+  mapped_file(mapped_file&& other) noexcept;
+  mapped_file& operator=(const mapped_file&) = delete;
+  mapped_file& operator=(mapped_file&& other) noexcept;
+  ~mapped_file();
+
+  const char* data() const { return data_; }
+  std::size_t size() const { return size_; }
+
+  // Keep the readahead window ahead of the given offset
+  void advance_to(std::size_t offset)
+  {
+    if (offset + readahead_size / 2 > advised_ && advised_ < size_)
+      advise_next();
+  }
+
+private:
+  void advise_next();
+};
+
+/**
+ * Reads uncompressed traces by mapping them into memory. The records are read where they are mapped, without being copied through intermediate
+ * buffers.
+ */
+template <typename T>
+class mapped_tracereader
+{
+  static_assert(std::is_trivial_v<T>);
+  static_assert(std::is_standard_layout_v<T>);
+
+  uint8_t cpu;
+  mapped_file file;
+  std::size_t length = file.size() / sizeof(T);
+  std::size_t position = 0;
+
+  T record(std::size_t idx) const
+  {
+    T result;
+    std::memcpy(&result, file.data() + idx * sizeof(T), sizeof(T));
+    return result;
+  }
+
+public:
+  mapped_tracereader(uint8_t cpu_idx, std::string tf) : cpu(cpu_idx), file(tf) {}
+
+  ooo_model_instr operator()()
+  {
+    if (position >= length)
+      return ooo_model_instr{cpu, T{}};
+
+    file.advance_to(position * sizeof(T));
+    ooo_model_instr retval{cpu, record(position)};
+
+    // The branch target is the address of the next instruction, as in set_branch_targets()
+    if (position + 1 < length)
+      retval.branch_target = (retval.is_branch && retval.branch_taken) ? record(position + 1).ip : 0;
+
+    ++position;
+    return retval;
+  }
+
+  uint64_t skip(uint64_t count)
+  {
+    auto skipped = std::min<uint64_t>(count, length - position);
+    position += skipped;
+    return skipped;
+  }
+
+  // The last instruction is kept, like the last buffered instruction of a bulk_tracereader, since its successor is unknown
+  bool eof() const { return position + 1 >= length; }
+};
+} // namespace champsim
+
+#endif
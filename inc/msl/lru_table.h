@@ -21,6 +21,7 @@
 #include <cassert>
 #include <cstdint>
 #include <optional>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -128,6 +129,10 @@ public:
     return std::exchange(*hit, {}).data;
   }
 
+  // The members that describe the contents of the table, for use with checkpoints
+  auto checkpoint_fields() const { return std::tie(access_count, block); }
+  auto checkpoint_fields() { return std::tie(access_count, block); }
+
   lru_table(std::size_t sets, std::size_t ways, SetProj set_proj, TagProj tag_proj)
       : set_projection(set_proj), tag_projection(tag_proj), NUM_SET(sets), NUM_WAY(ways)
   {
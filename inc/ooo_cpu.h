@@ -25,11 +25,13 @@
 #include <array>
 #include <bitset>
 #include <deque>
+#include <iosfwd>
 #include <limits>
 #include <memory>
 #include <optional>
 #include <queue>
 #include <stdexcept>
+#include <tuple>
 #include <vector>
 
 #include "champsim.h"
@@ -38,6 +40,8 @@
 #include "instruction.h"
 #include "module_impl.h"
 #include "operable.h"
+#include "profiler.h"
+#include "util/bits.h"
 #include "util/lru_table.h"
 #include <type_traits>
 
@@ -50,13 +54,14 @@ class CacheBus
   using request_type = typename channel_type::request_type;
   using response_type = typename channel_type::response_type;
 
-  channel_type* lower_level;
   uint32_t cpu;
 
   friend class O3_CPU;
 
 public:
-  CacheBus(uint32_t cpu_idx, champsim::channel* ll) : lower_level(ll), cpu(cpu_idx) {}
+  channel_type* lower_level;
+
+  CacheBus(uint32_t cpu_idx, champsim::channel* ll) : cpu(cpu_idx), lower_level(ll) {}
   bool issue_read(request_type packet);
   bool issue_write(request_type packet);
 };
@@ -72,8 +77,23 @@ struct cpu_stats {
 
   uint64_t instrs() const { return end_instrs - begin_instrs; }
   uint64_t cycles() const { return end_cycles - begin_cycles; }
+
+  // The members to transfer with the checkpoint serializer
+  auto checkpoint_fields() const
+  {
+    return std::tie(name, begin_instrs, begin_cycles, end_instrs, end_cycles, total_rob_occupancy_at_branch_mispredict, total_branch_types,
+                    branch_type_misses);
+  }
+  auto checkpoint_fields()
+  {
+    return std::tie(name, begin_instrs, begin_cycles, end_instrs, end_cycles, total_rob_occupancy_at_branch_mispredict, total_branch_types,
+                    branch_type_misses);
+  }
 };
 
+// Combine the stats of two phases, as if they had run back to back
+cpu_stats operator+(cpu_stats lhs, const cpu_stats& rhs);
+
 struct LSQ_ENTRY {
   uint64_t instr_id = 0;
   uint64_t virtual_address = 0;
@@ -110,6 +130,10 @@ public:
 
   bool show_heartbeat = true;
 
+  // The cumulative IPC of the phase at each of the most recent heartbeats, for detecting convergence. None are kept unless a length is set.
+  std::deque<double> heartbeat_ipc{};
+  std::size_t heartbeat_history = 0;
+
   using stats_type = cpu_stats;
 
   stats_type roi_stats{}, sim_stats{};
@@ -150,10 +174,21 @@ public:
   CacheBus L1I_bus, L1D_bus;
   CACHE* l1i;
 
+  // The stages of operate(), each timed by the self-profiler
+  enum class stage : std::size_t { retire, complete, execute, schedule, memory_return, lsq, dispatch, decode, promote, fetch, dib, initialize, num_stages };
+  std::array<champsim::profiler::region, champsim::to_underlying(stage::num_stages)> stage_profile{};
+
   void initialize() override final;
   long operate() override final;
   void begin_phase() override final;
   void end_phase(unsigned cpu) override final;
+  uint64_t next_event_cycle() const override final;
+  std::size_t input_occupancy() const override final;
+  void save_checkpoint(std::ostream& stream) override final;
+  void load_checkpoint(std::istream& stream) override final;
+  void clear_inflight() override final;
+  void save_inflight(std::ostream& stream) override final;
+  std::vector<std::pair<std::string, champsim::profiler::region>> profile() const override final;
 
   void initialize_instruction();
   long check_dib();
@@ -198,10 +233,14 @@ public:
     virtual void impl_initialize_branch_predictor() = 0;
     virtual void impl_last_branch_result(uint64_t ip, uint64_t target, uint8_t taken, uint8_t branch_type) = 0;
     virtual uint8_t impl_predict_branch(uint64_t ip) = 0;
+    virtual void impl_checkpoint_branch_predictor(std::ostream& stream) = 0;
+    virtual void impl_restore_branch_predictor(std::istream& stream) = 0;
 
     virtual void impl_initialize_btb() = 0;
     virtual void impl_update_btb(uint64_t ip, uint64_t predicted_target, uint8_t taken, uint8_t branch_type) = 0;
     virtual std::pair<uint64_t, uint8_t> impl_btb_prediction(uint64_t ip) = 0;
+    virtual void impl_checkpoint_btb(std::ostream& stream) = 0;
+    virtual void impl_restore_btb(std::istream& stream) = 0;
   };
 
   template <unsigned long long B_FLAG, unsigned long long T_FLAG>
@@ -212,10 +251,14 @@ public:
     void impl_initialize_branch_predictor();
     void impl_last_branch_result(uint64_t ip, uint64_t target, uint8_t taken, uint8_t branch_type);
     uint8_t impl_predict_branch(uint64_t ip);
+    void impl_checkpoint_branch_predictor(std::ostream& stream);
+    void impl_restore_branch_predictor(std::istream& stream);
 
     void impl_initialize_btb();
     void impl_update_btb(uint64_t ip, uint64_t predicted_target, uint8_t taken, uint8_t branch_type);
     std::pair<uint64_t, uint8_t> impl_btb_prediction(uint64_t ip);
+    void impl_checkpoint_btb(std::ostream& stream);
+    void impl_restore_btb(std::istream& stream);
   };
 
   std::unique_ptr<module_concept> module_pimpl;
@@ -226,6 +269,8 @@ public:
     module_pimpl->impl_last_branch_result(ip, target, taken, branch_type);
   }
   uint8_t impl_predict_branch(uint64_t ip) { return module_pimpl->impl_predict_branch(ip); }
+  void impl_checkpoint_branch_predictor(std::ostream& stream) { module_pimpl->impl_checkpoint_branch_predictor(stream); }
+  void impl_restore_branch_predictor(std::istream& stream) { module_pimpl->impl_restore_branch_predictor(stream); }
 
   void impl_initialize_btb() { module_pimpl->impl_initialize_btb(); }
   void impl_update_btb(uint64_t ip, uint64_t predicted_target, uint8_t taken, uint8_t branch_type)
@@ -233,6 +278,8 @@ public:
     module_pimpl->impl_update_btb(ip, predicted_target, taken, branch_type);
   }
   std::pair<uint64_t, uint8_t> impl_btb_prediction(uint64_t ip) { return module_pimpl->impl_btb_prediction(ip); }
+  void impl_checkpoint_btb(std::ostream& stream) { module_pimpl->impl_checkpoint_btb(stream); }
+  void impl_restore_btb(std::istream& stream) { module_pimpl->impl_restore_btb(stream); }
 
   class builder_conversion_tag
   {
@@ -243,7 +290,7 @@ public:
     using self_type = Builder<B_FLAG, T_FLAG>;
 
     uint32_t m_cpu{};
-    double m_freq_scale{};
+    champsim::clock_period m_freq_scale{};
     std::size_t m_dib_set{};
     std::size_t m_dib_way{};
     std::size_t m_dib_window{};
@@ -296,7 +343,7 @@ public:
       m_cpu = cpu_;
       return *this;
     }
-    self_type& frequency(double freq_scale_)
+    self_type& frequency(champsim::clock_period freq_scale_)
     {
       m_freq_scale = freq_scale_;
       return *this;
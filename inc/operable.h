@@ -17,41 +17,106 @@
 #ifndef OPERABLE_H
 #define OPERABLE_H
 
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "profiler.h"
+
 namespace champsim
 {
 
+// The period of a clock domain, measured in ticks of the fastest clock in the system.
+// A period of 5/4 operates on four of every five ticks.
+struct clock_period {
+  uint64_t ticks = 1;
+  uint64_t cycles = 1;
+
+  clock_period() = default;
+  clock_period(uint64_t ticks_, uint64_t cycles_);
+  clock_period(double scale); // Converts to the simplest exact ratio
+};
+
 class operable
 {
 public:
-  const double CLOCK_SCALE;
+  const clock_period CLOCK_PERIOD;
 
-  double leap_operation = 0;
   uint64_t current_cycle = 0;
+  uint64_t skip_until = 0;
+  std::size_t skip_occupancy = 0;
   bool warmup = true;
 
-  explicit operable(double scale) : CLOCK_SCALE(scale - 1) {}
+  profiler::region operate_profile{};
+
+  explicit operable(clock_period period) : CLOCK_PERIOD(period) {}
 
   long _operate()
   {
-    // skip periodically
-    if (leap_operation >= 1) {
-      leap_operation -= 1;
-      return 0;
-    }
-
+    profiler::timer<> timed{operate_profile};
     auto result = operate();
-
-    leap_operation += CLOCK_SCALE;
     ++current_cycle;
+    return result;
+  }
+
+  // Advance the clock by one cycle without operating. This may only be used while can_skip() is true.
+  long _skip()
+  {
+    auto result = skip_operate();
+
+    // Any progress may have created new work, so wake up on the next cycle
+    if (result > 0)
+      wake();
 
+    ++current_cycle;
     return result;
   }
 
+  // Go dormant until the next cycle with work due, or until a packet arrives on a consumed queue.
+  // Returns whether the next cycle may be skipped.
+  bool prepare_skip()
+  {
+    skip_until = next_event_cycle();
+    skip_occupancy = input_occupancy();
+    return can_skip();
+  }
+
+  bool can_skip() const { return current_cycle < skip_until && input_occupancy() == skip_occupancy; }
+
+  void wake() { skip_until = 0; }
+
+  // The earliest cycle in which operate() would do anything other than skip_operate(). The default never skips.
+  virtual uint64_t next_event_cycle() const { return current_cycle; }
+
+  // The total number of packets waiting in the queues this operable consumes. Only the consumer removes packets from these queues, so any change while
+  // dormant means that a packet has arrived.
+  virtual std::size_t input_occupancy() const { return 0; }
+
+  // Perform the work of a cycle before next_event_cycle(), such as retrying blocked requests
+  virtual long skip_operate() { return 0; }
+
   virtual void initialize() {} // LCOV_EXCL_LINE
   virtual long operate() = 0;
   virtual void begin_phase() {}       // LCOV_EXCL_LINE
   virtual void end_phase(unsigned) {} // LCOV_EXCL_LINE
   virtual void print_deadlock() {}    // LCOV_EXCL_LINE
+
+  // Save and restore the state that outlives the packets in flight, such as the contents of tables. The clock is saved separately.
+  virtual void save_checkpoint(std::ostream&) {} // LCOV_EXCL_LINE
+  virtual void load_checkpoint(std::istream&) {} // LCOV_EXCL_LINE
+
+  // Discard the work in flight, such as the packets in the queues this operable consumes and the contents of the pipeline
+  virtual void clear_inflight() {} // LCOV_EXCL_LINE
+
+  // Write the identity of the work in flight, such as the addresses in the queues this operable consumes and in its pipeline. This is hashed by the
+  // determinism checker, and is never read back.
+  virtual void save_inflight(std::ostream&) {} // LCOV_EXCL_LINE
+
+  // The named regions of the self-profiler, including operate_profile. The default is unnamed, and is not reported.
+  virtual std::vector<std::pair<std::string, profiler::region>> profile() const { return {}; } // LCOV_EXCL_LINE
 };
 
 } // namespace champsim
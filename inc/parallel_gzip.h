@@ -0,0 +1,85 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PARALLEL_GZIP_H
+#define PARALLEL_GZIP_H
+
+#include <atomic>
+#include <cstddef>
+#include <ios>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * A gzip trace of several members, such as one that was compressed in pieces and concatenated, can be inflated in parallel. The compressed trace is
+ * divided into spans. Worker threads inflate the members that begin in each span ahead of the reader, and the reader takes their output in order.
+ *
+ * The members are found by their headers, which may also appear by chance inside a member. The output of a span is only taken if the member before it
+ * ends exactly where the span's first member begins. Otherwise, the reader inflates the span itself, so that the output is always the same as if it
+ * were inflated on one thread.
+ */
+namespace champsim::parallel_gzip
+{
+constexpr std::size_t default_span = std::size_t{1} << 20;
+
+// The output of a span that is larger than this is dropped, and the reader inflates the span itself
+constexpr std::size_t default_output_limit = std::size_t{32} << 20;
+
+// Whether the bytes at the offset could begin a gzip member
+bool is_member_start(const char* data, std::size_t size, std::size_t offset);
+
+// The first offset in [from, until) that could begin a gzip member, or the size if there is none
+std::size_t find_member_start(const char* data, std::size_t size, std::size_t from, std::size_t until);
+
+struct members {
+  std::size_t begin;
+  std::size_t end = begin; // The offset after the last member that was inflated
+  std::vector<char> inflated{};
+  bool valid = false; // Whether every member was inflated to its end, within the output limit
+};
+
+// Inflate whole members from the beginning, until one ends at or after the given offset. Stops early if the flag is raised.
+members inflate_members(const char* data, std::size_t size, std::size_t begin, std::size_t until, std::size_t output_limit,
+                        const std::atomic<bool>* cancelled = nullptr);
+
+class istream
+{
+public:
+  class state;
+
+private:
+  std::unique_ptr<state> state_;
+  std::streamsize gcount_ = 0;
+  bool eof_ = false;
+
+public:
+  // The trace is inflated with the given number of threads, counting the reading thread, or with champsim::inflate_threads
+  explicit istream(const std::string& trace_name);
+  istream(const std::string& trace_name, unsigned threads, std::size_t span = default_span, std::size_t output_limit = default_output_limit);
+  istream(istream&&) noexcept;
+  istream& operator=(istream&&) noexcept;
+  ~istream();
+
+  istream& read(char* s, std::streamsize count);
+  istream& ignore(std::streamsize count);
+
+  bool eof() const { return eof_; }
+  std::streamsize gcount() const { return gcount_; }
+};
+} // namespace champsim::parallel_gzip
+
+#endif
@@ -0,0 +1,44 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef PHASE_FILE_H
+#define PHASE_FILE_H
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "phase_info.h"
+
+namespace champsim
+{
+/**
+ * Read a JSON description of a sequence of phases, to be run back to back on the same simulator.
+ *
+ * The file holds an object with a list of "phases" and, optionally, a list of "traces" that replaces the given trace names. Each phase has a "length",
+ * and may have a "name", a "warmup" flag, a "functional" flag, a position to "skip_to", and a "checkpoint" file to save at its end. Its "traces" list the
+ * trace of each core, either by index into the trace names or by name. A name that is not yet known is added to the trace names. By default, core i
+ * runs trace i.
+ *
+ * Warmup phases are copied from the warmup template, and measured phases from the simulation template. Throws std::runtime_error if the file is not valid.
+ */
+std::vector<phase_info> read_phase_file(std::istream& file, std::vector<std::string> trace_names, std::size_t num_cpus, const phase_info& warmup,
+                                        const phase_info& simulation);
+} // namespace champsim
+
+#endif
@@ -20,6 +20,8 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #include "cache.h"
@@ -36,6 +38,56 @@ struct phase_info {
   uint64_t length;
   std::vector<std::size_t> trace_index;
   std::vector<std::string> trace_names;
+  uint64_t parallel_quantum = 0; // If nonzero, run each core's private slice on its own thread, synchronizing after this many ticks
+  std::string checkpoint_file{}; // If not empty, save a checkpoint to this file at the end of the phase
+  bool is_functional = false;     // If true, warm the predictors and caches from the traces without modeling the pipeline or timing
+
+  // If sample_period is nonzero, each period of the phase is warmed functionally, except for a detailed warmup and a measured window at its end
+  uint64_t sample_period = 0;
+  uint64_t sample_warmup = 0;
+  uint64_t sample_length = 0;
+
+  uint64_t skip_to = 0; // Before the phase begins, skip each trace forward to this instruction without simulating the instructions in between
+  double weight = 0;    // If nonzero, the weight of this phase in a weighted aggregate of regions, such as SimPoints
+
+  // If convergence_intervals is nonzero, the phase ends early once the cumulative IPC of every core, and optionally the LLC MPKI, has stayed within the
+  // relative tolerance over that many heartbeat intervals
+  uint64_t convergence_intervals = 0;
+  double convergence_tolerance = 0;
+  bool convergence_llc = false;
+
+  // If fork_interval is nonzero, the phase is warmed functionally, and each interval of this many instructions is simulated in detail by a child process
+  // forked at its start. Up to fork_jobs children run at once.
+  uint64_t fork_interval = 0;
+  std::size_t fork_jobs = 1;
+
+  // If state_hash_period is nonzero, the state of each component is hashed and appended to state_hash_file whenever the clock passes a multiple of this
+  // many ticks of the fastest clock
+  uint64_t state_hash_period = 0;
+  std::string state_hash_file{};
+};
+
+// The headline results of one measured window of a sampled phase
+struct sample_stats {
+  std::vector<double> cpu_ipc;
+  std::vector<std::pair<std::string, double>> cache_mpki;
+  std::vector<std::pair<std::string, double>> dram_apki;
+
+  // The members to transfer with the checkpoint serializer
+  auto checkpoint_fields() const { return std::tie(cpu_ipc, cache_mpki, dram_apki); }
+  auto checkpoint_fields() { return std::tie(cpu_ipc, cache_mpki, dram_apki); }
+};
+
+// The host time spent in a region of the simulator during a phase, if the simulator is built with CHAMPSIM_PROFILE
+struct profile_stats {
+  std::string name;
+  uint64_t calls = 0;
+  uint64_t ticks = 0;
+  double seconds = 0;
+
+  // The members to transfer with the checkpoint serializer
+  auto checkpoint_fields() const { return std::tie(name, calls, ticks, seconds); }
+  auto checkpoint_fields() { return std::tie(name, calls, ticks, seconds); }
 };
 
 struct phase_stats {
@@ -44,6 +96,22 @@ struct phase_stats {
   std::vector<O3_CPU::stats_type> roi_cpu_stats, sim_cpu_stats;
   std::vector<CACHE::stats_type> roi_cache_stats, sim_cache_stats;
   std::vector<DRAM_CHANNEL::stats_type> roi_dram_stats, sim_dram_stats;
+  std::vector<sample_stats> samples; // One for each measured window, if the phase was sampled
+  double weight = 0;
+  std::string stop_reason{}; // Why the phase ended before its length, if it did
+  std::vector<profile_stats> profile{}; // The total for the phase, followed by each region of the simulator that was called
+
+  // The members to transfer with the checkpoint serializer
+  auto checkpoint_fields() const
+  {
+    return std::tie(name, trace_names, roi_cpu_stats, sim_cpu_stats, roi_cache_stats, sim_cache_stats, roi_dram_stats, sim_dram_stats, samples, weight,
+                    stop_reason, profile);
+  }
+  auto checkpoint_fields()
+  {
+    return std::tie(name, trace_names, roi_cpu_stats, sim_cpu_stats, roi_cache_stats, sim_cache_stats, roi_dram_stats, sim_dram_stats, samples, weight,
+                    stop_reason, profile);
+  }
 };
 
 } // namespace champsim
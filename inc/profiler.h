@@ -0,0 +1,82 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace champsim
+{
+#ifdef CHAMPSIM_PROFILE
+constexpr bool self_profile = true;
+#else
+constexpr bool self_profile = false;
+#endif
+
+namespace profiler
+{
+// The host time and calls accumulated by a profiled region of the simulator. Time is measured in ticks of the time stamp counter, where there is one.
+struct region {
+  uint64_t calls = 0;
+  uint64_t ticks = 0;
+};
+
+inline uint64_t now()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// Adds the time from its construction to its destruction to the region. If profiling is not enabled, it does nothing, and is compiled out.
+template <bool Enabled = self_profile>
+class timer
+{
+  region& into;
+  uint64_t start = now();
+
+public:
+  explicit timer(region& r) : into(r) {}
+  ~timer()
+  {
+    into.ticks += now() - start;
+    ++into.calls;
+  }
+
+  timer(const timer&) = delete;
+  timer& operator=(const timer&) = delete;
+};
+
+template <>
+class timer<false>
+{
+public:
+  explicit timer(region&) {}
+  ~timer() {} // Not trivial, so that an unused timer does not warn
+};
+} // namespace profiler
+} // namespace champsim
+
+#endif
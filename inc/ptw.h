@@ -19,7 +19,9 @@
 
 #include <array>
 #include <deque>
+#include <iosfwd>
 #include <string>
+#include <vector>
 
 #include "channel.h"
 #include "operable.h"
@@ -66,9 +68,11 @@ class PageTableWalker : public champsim::operable
   std::deque<mshr_type> finished;
   std::deque<mshr_type> completed;
 
+public:
   std::vector<channel_type*> upper_levels;
   channel_type* lower_level;
 
+private:
   std::optional<mshr_type> handle_read(const request_type& pkt, channel_type* ul);
   std::optional<mshr_type> handle_fill(const mshr_type& pkt);
   std::optional<mshr_type> step_translation(const mshr_type& source);
@@ -89,7 +93,7 @@ public:
   class Builder
   {
     std::string_view m_name{};
-    double m_freq_scale{};
+    champsim::clock_period m_freq_scale{};
     uint32_t m_cpu{};
     std::array<std::array<uint32_t, 3>, 16> m_pscl{}; // fixed size for now
     uint32_t m_mshr_size{};
@@ -108,7 +112,7 @@ public:
       m_name = name_;
       return *this;
     }
-    Builder& frequency(double freq_scale_)
+    Builder& frequency(champsim::clock_period freq_scale_)
     {
       m_freq_scale = freq_scale_;
       return *this;
@@ -163,9 +167,20 @@ public:
   explicit PageTableWalker(Builder builder);
 
   long operate() override final;
+  uint64_t next_event_cycle() const override final;
+  std::size_t input_occupancy() const override final;
 
   void begin_phase() override final;
   void print_deadlock() override final;
+
+  // Functional warming walks the page table without modeling time, filling the paging structure caches. Returns the addresses of the page table
+  // entries that the walk reads.
+  std::vector<uint64_t> warm_walk(uint32_t cpu, uint64_t v_address);
+  void save_checkpoint(std::ostream& stream) override final;
+  void load_checkpoint(std::istream& stream) override final;
+  void clear_inflight() override final;
+  void save_inflight(std::ostream& stream) override final;
+  std::vector<std::pair<std::string, champsim::profiler::region>> profile() const override final;
 };
 
 #endif
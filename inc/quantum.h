@@ -0,0 +1,105 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef QUANTUM_H
+#define QUANTUM_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "channel.h"
+#include "environment.h"
+#include "operable.h"
+#include "phase_info.h"
+
+namespace champsim
+{
+
+// A group of operables that only communicate with the rest of the system through the channels at its boundary
+struct slice {
+  std::vector<std::reference_wrapper<operable>> operables;
+  std::vector<std::reference_wrapper<O3_CPU>> cpus;
+};
+
+// Partition the environment into a private slice for each core, holding the core and every cache and page table walker that only that core can reach,
+// followed by a shared slice holding everything else. Each slice keeps the order of the environment's operables.
+std::vector<slice> partition_slices(environment& env);
+
+/**
+ * While in scope, each channel that crosses from a private slice into the shared slice is split in two. The private side issues into a staging
+ * channel of the same size, and reads responses from it. At the end of each quantum, exchange() moves requests down as far as the shared side has
+ * room, and moves responses up. This way, no channel is touched by two slices during a quantum.
+ */
+class slice_boundary
+{
+  struct crossing {
+    channel* shared;
+    channel** producer_link;
+    channel staged;
+  };
+  std::deque<crossing> crossings;
+
+public:
+  slice_boundary(environment& env, const std::vector<slice>& slices);
+  ~slice_boundary();
+
+  slice_boundary(const slice_boundary&) = delete;
+  slice_boundary& operator=(const slice_boundary&) = delete;
+
+  // Returns the number of packets moved
+  long exchange();
+
+  // The number of channels that cross the boundary
+  std::size_t size() const;
+};
+
+// A reusable barrier for a fixed number of threads. The last thread to arrive runs the completion before any thread is released.
+class quantum_barrier
+{
+  std::mutex mutex;
+  std::condition_variable released;
+  const std::size_t expected;
+  std::size_t arrived = 0;
+  uint64_t generation = 0;
+  std::function<void()> completion;
+
+public:
+  quantum_barrier(std::size_t count, std::function<void()> on_completion);
+  void arrive_and_wait();
+};
+
+// The headline results of a phase, used to measure how far the parallel engine deviates from the serial engine
+struct phase_summary {
+  std::string name;
+  std::vector<double> cpu_ipc;
+  std::vector<std::pair<std::string, uint64_t>> cache_misses;
+};
+
+std::vector<phase_summary> summarize(const std::vector<phase_stats>& stats);
+std::string serialize(const std::vector<phase_summary>& summaries);
+std::vector<phase_summary> deserialize(const std::string& data);
+
+void print_deviation(std::ostream& stream, uint64_t quantum, const std::vector<phase_summary>& parallel, const std::vector<phase_summary>& serial);
+
+} // namespace champsim
+
+#endif
@@ -27,12 +27,17 @@ namespace champsim
 {
 template <typename T, typename... Args>
 struct repeatable {
+  using reader_type = T;
+
   static_assert(std::is_move_constructible_v<T>);
   static_assert(std::is_move_assignable_v<T>);
   std::tuple<Args...> args_;
   T intern_{std::apply([](auto... x) { return T{x...}; }, args_)};
   explicit repeatable(Args... args) : args_(args...) {}
 
+  // Begin with a reader that is already open. It is reopened from the arguments at the end of the trace.
+  repeatable(T&& first, Args... args) : args_(args...), intern_(std::move(first)) {}
+
   auto operator()()
   {
     // Reopen trace if we've reached the end of the file
@@ -44,6 +49,23 @@ struct repeatable {
     return intern_();
   }
 
+  uint64_t skip(uint64_t count)
+  {
+    uint64_t skipped = 0;
+    while (skipped < count) {
+      if (intern_.eof()) {
+        fmt::print("*** Reached end of trace: {}\n", args_);
+        intern_ = T{std::apply([](auto... x) { return T{x...}; }, args_)};
+      }
+
+      auto progress = intern_.skip(count - skipped);
+      if (progress == 0)
+        break;
+      skipped += progress;
+    }
+    return skipped;
+  }
+
   bool eof() const { return false; }
 };
 } // namespace champsim
@@ -0,0 +1,50 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SAMPLING_H
+#define SAMPLING_H
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+#include "phase_info.h"
+
+namespace champsim
+{
+// An estimate of the mean of a population from a sample of it, with the half-width of its confidence interval
+struct sample_estimate {
+  std::size_t count;
+  double mean;
+  double half_width;
+};
+
+// Take the headline results of one measured window from its stats
+sample_stats measure_sample(const phase_stats& window);
+
+// Combine the headline results of the phases that have weights. IPC is averaged through CPI, so that each region contributes its share of the cycles.
+sample_stats weighted_mean(const std::vector<phase_stats>& regions);
+
+// Whether a series of cumulative measurements has settled, that is, whether the last (intervals + 1) values all lie within the relative tolerance of
+// the latest one
+bool has_converged(const std::deque<double>& history, std::size_t intervals, double tolerance);
+
+// Estimate the mean with a 95% confidence interval from Student's t-distribution. The half-width is NaN if there are fewer than two values.
+sample_estimate estimate_mean(const std::vector<double>& values);
+} // namespace champsim
+
+#endif
@@ -0,0 +1,105 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SEEK_INDEX_H
+#define SEEK_INDEX_H
+
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * A seek index is kept in a sidecar file next to a gzip or xz trace. It lists points in the compressed trace at which inflation can start over, so
+ * that a reader can skip to an instruction by inflating only from the nearest point before it.
+ *
+ * For gzip, a point is the start of a deflate block, with the 32 KiB of inflated data before it that the block may refer back to. For xz, a point is
+ * the start of a block. A trace that was compressed by a single-threaded xz has only one block, so it cannot be skipped into.
+ */
+namespace champsim::seek_index
+{
+enum class format : uint8_t { gzip = 1, xz = 2 };
+
+struct restart_point {
+  uint64_t inflated_offset;
+  uint64_t compressed_offset;
+  uint8_t bits = 0;                    // For gzip, the number of bits of the byte before the compressed offset that begin the block
+  uint8_t check = 0;                   // For xz, the integrity check of the stream that holds the block
+  std::vector<unsigned char> window{}; // For gzip, the inflated data before the point, deflated to save space
+};
+
+struct index {
+  format fmt;
+  uint64_t compressed_size; // The size of the trace that was indexed, to recognize a stale index
+  std::vector<restart_point> points;
+};
+
+constexpr uint64_t default_span = uint64_t{64} << 20;
+
+// The name of the sidecar file that holds the index of the given trace
+std::string sidecar_name(const std::string& trace_name);
+
+// Build the index of a trace, with gzip points at least span inflated bytes apart. Throws std::runtime_error if the trace cannot be read.
+index build_gzip(std::istream& compressed, uint64_t span = default_span);
+index build_xz(std::istream& compressed);
+
+void write(std::ostream& stream, const index& idx);
+
+// Throws std::runtime_error if the stream does not hold an index
+index read(std::istream& stream);
+
+// Read the sidecar of the given trace, if it exists and matches the trace
+std::optional<index> load_sidecar(const std::string& trace_name);
+
+/**
+ * An input stream over a gzip or xz trace. When it ignores input, it starts inflating again from the last restart point before its target, if that
+ * point is ahead of it.
+ */
+class istream
+{
+public:
+  class decoder;
+
+private:
+  std::unique_ptr<std::istream> src;
+  index idx;
+  std::unique_ptr<decoder> inflater;
+  uint64_t position = 0;
+  std::streamsize gcount_ = 0;
+  bool eof_ = false;
+
+public:
+  // The index is read from the sidecar of the trace. The format is known from the name of the trace.
+  explicit istream(const std::string& trace_name);
+  istream(std::unique_ptr<std::istream> compressed, index i);
+  istream(istream&&) noexcept;
+  istream& operator=(istream&&) noexcept;
+  ~istream();
+
+  istream& read(char* s, std::streamsize count);
+  istream& ignore(std::streamsize count);
+
+  bool eof() const { return eof_; }
+  std::streamsize gcount() const { return gcount_; }
+};
+} // namespace champsim::seek_index
+
+#endif
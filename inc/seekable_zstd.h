@@ -0,0 +1,198 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SEEKABLE_ZSTD_H
+#define SEEKABLE_ZSTD_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <zstd.h>
+
+#include "inf_stream.h"
+
+/**
+ * The seekable zstd layout is a sequence of independently compressed frames, followed by a skippable frame that holds a table of the compressed and
+ * inflated size of each frame. An ordinary zstd decoder reads the file as one stream, and skips the table.
+ *
+ * See https://github.com/facebook/zstd/blob/dev/contrib/seekable_format/zstd_seekable_compression_format.md
+ */
+namespace champsim::seekable_zstd
+{
+constexpr uint32_t skippable_magic = 0x184D2A5E;
+constexpr uint32_t seekable_magic = 0x8F92EAB1;
+constexpr std::size_t footer_size = 9;
+constexpr std::size_t header_size = 8;
+
+namespace detail
+{
+inline uint32_t load_le32(const unsigned char* bytes)
+{
+  return uint32_t{bytes[0]} | (uint32_t{bytes[1]} << 8) | (uint32_t{bytes[2]} << 16) | (uint32_t{bytes[3]} << 24);
+}
+
+inline void store_le32(std::ostream& dest, uint32_t value)
+{
+  std::array<char, 4> bytes{static_cast<char>(value), static_cast<char>(value >> 8), static_cast<char>(value >> 16), static_cast<char>(value >> 24)};
+  dest.write(std::data(bytes), std::size(bytes));
+}
+} // namespace detail
+
+struct frame {
+  uint64_t compressed_offset;
+  uint64_t inflated_offset;
+};
+
+/**
+ * Read the seek table from the end of the stream. The table is empty if the stream cannot seek, or if it does not end with a seek table. The stream
+ * is returned to its start.
+ */
+template <typename IStrm>
+std::vector<frame> read_seek_table(IStrm& src)
+{
+  std::vector<frame> result;
+
+  std::array<unsigned char, footer_size> footer;
+  src.seekg(-static_cast<std::streamoff>(footer_size), std::ios::end);
+  src.read(reinterpret_cast<char*>(std::data(footer)), std::size(footer));
+
+  // The low two bits of the descriptor are unused, and the rest are reserved except for the checksum flag
+  if (src.gcount() == static_cast<std::streamsize>(std::size(footer)) && detail::load_le32(&footer[5]) == seekable_magic && (footer[4] & 0x7c) == 0) {
+    auto num_frames = detail::load_le32(&footer[0]);
+    auto entry_size = ((footer[4] & 0x80) != 0) ? 12u : 8u;
+    auto table_size = uint64_t{num_frames} * entry_size;
+
+    std::vector<unsigned char> table(header_size + table_size);
+    src.seekg(-static_cast<std::streamoff>(header_size + table_size + footer_size), std::ios::end);
+    src.read(reinterpret_cast<char*>(std::data(table)), static_cast<std::streamsize>(std::size(table)));
+
+    if (src.gcount() == static_cast<std::streamsize>(std::size(table)) && detail::load_le32(&table[0]) == skippable_magic
+        && detail::load_le32(&table[4]) == table_size + footer_size) {
+      frame next{0, 0};
+      for (auto entry = std::next(std::begin(table), header_size); entry != std::end(table); entry += entry_size) {
+        result.push_back(next);
+        next.compressed_offset += detail::load_le32(&*entry);
+        next.inflated_offset += detail::load_le32(&*std::next(entry, 4));
+      }
+    }
+  }
+
+  src.clear();
+  src.seekg(0);
+  return result;
+}
+
+/**
+ * A zstd input stream that seeks to the frame nearest a target when it ignores input, if the file has a seek table. Otherwise, it inflates the
+ * whole stream like an inf_istream.
+ */
+template <typename StreamType = std::ifstream>
+class istream
+{
+  inf_istream<decomp_tags::zstd_tag_t<>, StreamType> inflated;
+  std::vector<frame> frames = read_seek_table(*inflated.underlying);
+  uint64_t position = 0;
+  std::streamsize gcount_ = 0;
+
+public:
+  explicit istream(std::string s) : inflated(s) {}
+  explicit istream(StreamType&& str) : inflated(std::move(str)) {}
+
+  istream& read(char* s, std::streamsize count)
+  {
+    inflated.read(s, count);
+    gcount_ = inflated.gcount();
+    position += static_cast<uint64_t>(gcount_);
+    return *this;
+  }
+
+  istream& ignore(std::streamsize count)
+  {
+    auto target = position + static_cast<uint64_t>(count);
+
+    // Jump to the last frame that starts at or before the target, if it is ahead of the current position
+    auto jumped = uint64_t{0};
+    auto found = std::upper_bound(std::begin(frames), std::end(frames), target, [](uint64_t t, const frame& f) { return t < f.inflated_offset; });
+    if (found != std::begin(frames) && std::prev(found)->inflated_offset > position) {
+      auto start = std::prev(found);
+      inflated.restart_at(static_cast<std::streamoff>(start->compressed_offset));
+      jumped = start->inflated_offset - position;
+      position = start->inflated_offset;
+    }
+
+    inflated.ignore(static_cast<std::streamsize>(target - position));
+    gcount_ = static_cast<std::streamsize>(jumped) + inflated.gcount();
+    position += static_cast<uint64_t>(inflated.gcount());
+    return *this;
+  }
+
+  bool eof() const { return inflated.eof(); }
+  std::streamsize gcount() const { return gcount_; }
+  std::size_t num_frames() const { return std::size(frames); }
+};
+
+/**
+ * Writes a seekable zstd stream. Each call to write_frame() compresses its data as one frame, and finish() writes the seek table.
+ */
+class writer
+{
+  std::unique_ptr<ZSTD_CCtx, std::size_t (*)(ZSTD_CCtx*)> context{::ZSTD_createCCtx(), ::ZSTD_freeCCtx};
+  std::vector<char> compressed{};
+  std::vector<std::array<uint32_t, 2>> entries{};
+  std::ostream& dest;
+
+public:
+  writer(std::ostream& d, int level) : dest(d) { ::ZSTD_CCtx_setParameter(context.get(), ZSTD_c_compressionLevel, level); }
+
+  // Returns false if the frame could not be compressed
+  bool write_frame(const char* data, std::size_t size)
+  {
+    // The seek table holds 32-bit sizes
+    assert(size <= UINT32_MAX);
+    compressed.resize(::ZSTD_compressBound(size));
+    auto compressed_size = ::ZSTD_compress2(context.get(), std::data(compressed), std::size(compressed), data, size);
+    if (::ZSTD_isError(compressed_size))
+      return false;
+
+    dest.write(std::data(compressed), static_cast<std::streamsize>(compressed_size));
+    entries.push_back({static_cast<uint32_t>(compressed_size), static_cast<uint32_t>(size)});
+    return true;
+  }
+
+  void finish()
+  {
+    detail::store_le32(dest, skippable_magic);
+    detail::store_le32(dest, static_cast<uint32_t>(std::size(entries) * 8 + footer_size));
+    for (auto [compressed_size, inflated_size] : entries) {
+      detail::store_le32(dest, compressed_size);
+      detail::store_le32(dest, inflated_size);
+    }
+    detail::store_le32(dest, static_cast<uint32_t>(std::size(entries)));
+    dest.put(0);
+    detail::store_le32(dest, seekable_magic);
+  }
+};
+} // namespace champsim::seekable_zstd
+
+#endif
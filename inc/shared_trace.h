@@ -0,0 +1,190 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SHARED_TRACE_H
+#define SHARED_TRACE_H
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "instruction.h"
+#include "tracereader.h"
+
+/**
+ * Cores that read the same trace share one reader of it. Each core has its own cursor into the instructions that were read. The instructions between
+ * the slowest and the fastest cursor are held in the encoding of the decoded cache, and each cursor decodes its own copy as it reads them.
+ *
+ * If the held instructions grow past the capacity, the slowest cursor is evicted. It opens a reader of its own and skips it to its position.
+ */
+namespace champsim::shared_trace
+{
+// A shared trace is read with this cpu, and each cursor gives its instructions the address space of its own cpu
+constexpr uint8_t anonymous_cpu = std::numeric_limits<uint8_t>::max();
+
+constexpr std::size_t default_capacity = std::size_t{64} << 20;
+constexpr std::size_t chunk_size = 1024;
+
+/**
+ * The instructions of the first pass through a repeating trace, in the encoding of the decoded cache. If they fit in the capacity, the later passes are
+ * replayed from memory instead of reading the trace again.
+ */
+class loop
+{
+  std::vector<char> bytes{};
+  std::size_t capacity;
+  bool overflowed = false;
+
+public:
+  explicit loop(std::size_t cap) : capacity(cap) {}
+
+  // Hold the next instruction of the pass. If the pass grows past the capacity, it is dropped.
+  void record(const ooo_model_instr& instr);
+
+  bool holds() const { return !overflowed; }
+  const std::vector<char>& data() const { return bytes; }
+};
+
+/**
+ * A reader of one pass of a loop
+ */
+class loop_reader
+{
+  std::shared_ptr<const loop> pass;
+  std::size_t offset = 0;
+
+public:
+  explicit loop_reader(std::shared_ptr<const loop> p) : pass(std::move(p)) {}
+
+  ooo_model_instr operator()();
+  uint64_t skip(uint64_t count);
+  bool eof() const { return offset == std::size(pass->data()); }
+};
+
+class source
+{
+public:
+  // Opens a reader of the trace for the cpu, which repeats the trace if asked
+  using opener = std::function<any_reader(uint8_t, bool)>;
+
+private:
+  struct chunk {
+    uint64_t first;                    // The position of the first instruction in the chunk
+    std::vector<char> bytes{};         // The encoded instructions
+    std::vector<std::size_t> starts{}; // The offset of each instruction, and the end of the last one
+    uint64_t end() const { return first + std::size(starts) - 1; }
+  };
+
+  struct slot {
+    uint64_t position = 0;     // The first instruction that the cursor has not taken
+    std::size_t next_wrap = 0; // The first start of the trace that the cursor has not been told of
+    bool attached = true;
+    bool evicted = false;
+  };
+
+  std::mutex mutex{};
+  any_reader reader;
+  opener reopen;
+  std::string trace_name;
+  bool repeat;
+  std::size_t capacity;
+
+  std::deque<chunk> chunks{};
+  uint64_t end = 0; // The position after the last instruction that was read
+  std::size_t held_bytes = 0;
+  std::vector<slot> slots{};
+  std::vector<uint64_t> wraps{}; // The positions at which a repeating trace started over
+  std::shared_ptr<loop> first_pass{};
+
+  uint64_t min_other_position(std::size_t self) const;
+  void trim();
+  void evict_slowest(std::size_t self);
+  bool recording() const { return first_pass != nullptr && std::empty(wraps) && first_pass->holds(); }
+  ooo_model_instr read_next();
+  bool exhausted(uint64_t position);
+  void advance(uint64_t position);
+  void read_chunk(std::size_t self);
+  bool reach(std::size_t self, uint64_t position);
+  void take_wraps(slot& this_slot, uint64_t before, std::deque<uint64_t>& wrap_points) const;
+
+public:
+  source(any_reader r, opener reopen_fn, std::string name, bool repeat_trace, std::size_t cap = default_capacity, std::size_t loop_cap = 0);
+
+  const std::string& name() const { return trace_name; }
+
+  // Whether a new cursor can start at the beginning of the trace
+  bool joinable();
+
+  std::size_t attach();
+  void detach(std::size_t idx);
+
+  // Append up to max_count instructions, starting at the position, to the destination. Returns the number of instructions, which is zero at the end
+  // of the trace, or nothing if the cursor was evicted. The positions at which the trace started over, up to the last instruction, are appended to the
+  // wrap points.
+  std::optional<std::size_t> fetch(std::size_t idx, uint64_t position, std::size_t max_count, std::deque<ooo_model_instr>& dest,
+                                   std::deque<uint64_t>& wrap_points);
+
+  // Whether there is no instruction at the position, or nothing if the cursor was evicted
+  std::optional<bool> eof_at(std::size_t idx, uint64_t position);
+
+  // A reader of the trace of its own for an evicted cursor, skipped to the position
+  any_reader open_private(std::size_t idx, uint8_t cpu, uint64_t position, std::deque<uint64_t>& wrap_points);
+};
+
+/**
+ * A cursor of one core into a shared trace
+ */
+class reader
+{
+  std::shared_ptr<source> src;
+  std::size_t idx = 0;
+  uint8_t cpu;
+  uint64_t position = 0; // The position after the last instruction that was taken from the source, or read from the private reader
+  std::deque<ooo_model_instr> instr_buffer{};
+  mutable std::deque<uint64_t> wrap_points{};
+  mutable std::optional<any_reader> private_reader{};
+
+  ooo_model_instr stamp(ooo_model_instr instr) const;
+  void go_private() const;
+
+public:
+  reader(std::shared_ptr<source> s, uint8_t cpu_idx);
+  reader(reader&& other) noexcept;
+  reader& operator=(reader&& other) noexcept;
+  ~reader();
+
+  ooo_model_instr operator()();
+
+  // A skip ahead of the shared reader is counted in full, and the trace is skipped forward when the next instruction is read
+  uint64_t skip(uint64_t count);
+
+  std::size_t fill(std::vector<ooo_model_instr>& dest, std::size_t count);
+
+  bool eof() const;
+};
+
+// Find the source of a trace that other cursors can join, or create a new one
+std::shared_ptr<source> find_or_open(const std::string& key, const std::function<std::shared_ptr<source>()>& create);
+} // namespace champsim::shared_trace
+
+#endif
@@ -0,0 +1,44 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SIMPOINT_H
+#define SIMPOINT_H
+
+#include <cstdint>
+#include <istream>
+#include <vector>
+
+#include "phase_info.h"
+
+namespace champsim
+{
+// A region of a trace chosen by SimPoint, and the fraction of the program that it represents
+struct simpoint {
+  std::size_t cluster;
+  uint64_t interval;
+  double weight;
+};
+
+// Read the output of SimPoint. Each line of the simpoints file holds "<interval> <cluster>", and each line of the weights file holds "<weight> <cluster>".
+std::vector<simpoint> read_simpoints(std::istream& simpoints, std::istream& weights);
+
+// Build the phases that skip to each region, warm it, and simulate it, in the order that the regions appear in the trace. The warmup and simulation
+// phases are copied from the given templates, with the lengths taken from the warmup template and the interval length.
+std::vector<phase_info> simpoint_phases(std::vector<simpoint> regions, uint64_t interval_length, const phase_info& warmup, const phase_info& simulation);
+} // namespace champsim
+
+#endif
@@ -0,0 +1,78 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef STATE_HASH_H
+#define STATE_HASH_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "environment.h"
+
+namespace champsim
+{
+/**
+ * The determinism checker hashes the state of each component of the simulator at regular points in a run, so that two runs, such as one before and
+ * one after an optimization of the engine, can be shown to have simulated the same behavior.
+ *
+ * The hash of a component covers its clock, the state it would save to a checkpoint, such as cache tags, dirty bits, and predictor tables, and the
+ * identity of its work in flight, such as the contents of the ROB, the MSHR addresses, and the DRAM queues. Modules take part through their
+ * checkpoints, so their tables should not hold padding.
+ */
+namespace state_hash
+{
+// One line of the log
+struct record {
+  std::string phase;
+  uint64_t tick = 0;
+  std::string component;
+  uint64_t hash = 0;
+};
+
+// The hash of each component, named as in the stats
+std::vector<std::pair<std::string, uint64_t>> hash_components(environment& env);
+
+// Append a record for each component to the log
+void write(std::ostream& log, std::string_view phase, uint64_t tick, environment& env);
+
+// Read the next record of the log, or nothing at its end. Throws std::runtime_error if the line is malformed.
+std::optional<record> read(std::istream& log);
+
+struct comparison {
+  uint64_t matched = 0; // The number of records that matched before the first divergence
+
+  // The first records that differ. Either is empty if its log ended first, and both are empty if the logs match.
+  std::optional<record> reference{};
+  std::optional<record> actual{};
+
+  bool diverged() const { return reference.has_value() || actual.has_value(); }
+};
+
+// Find the first record at which a log differs from the reference log
+comparison compare(std::istream& reference, std::istream& actual);
+
+// A description of the result of a comparison, naming the first divergent cycle and component
+std::string describe(const comparison& result);
+} // namespace state_hash
+} // namespace champsim
+
+#endif
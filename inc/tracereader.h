@@ -17,23 +17,31 @@
 #ifndef TRACEREADER_H
 #define TRACEREADER_H
 
+#include <atomic>
+#include <cstddef>
 #include <cstring>
 #include <deque>
 #include <memory>
 #include <numeric>
 #include <string>
+#include <vector>
 
 #include "instruction.h"
+#include "profiler.h"
 #include "util/detect.h"
 
 namespace champsim
 {
-class tracereader
+/**
+ * A reader of any type. Its instructions are not numbered, so that it can be read on behalf of other readers.
+ */
+class any_reader
 {
-  static uint64_t instr_unique_id;
   struct reader_concept {
     virtual ~reader_concept() = default;
     virtual ooo_model_instr operator()() = 0;
+    virtual uint64_t skip(uint64_t count) = 0;
+    virtual std::size_t fill(std::vector<ooo_model_instr>& dest, std::size_t count) = 0;
     virtual bool eof() const = 0;
   };
 
@@ -45,7 +53,35 @@ class tracereader
     template <typename U>
     using has_eof = decltype(std::declval<U>().eof());
 
+    template <typename U>
+    using has_skip = decltype(std::declval<U>().skip(uint64_t{}));
+
+    template <typename U>
+    using has_fill = decltype(std::declval<U>().fill(std::declval<std::vector<ooo_model_instr>&>(), std::size_t{}));
+
     ooo_model_instr operator()() override { return intern_(); }
+    uint64_t skip(uint64_t count) override
+    {
+      if constexpr (champsim::is_detected_v<has_skip, T>)
+        return intern_.skip(count);
+
+      // If a skip() member function is not provided, read and discard each instruction
+      uint64_t skipped = 0;
+      for (; skipped < count && !eof(); ++skipped)
+        intern_();
+      return skipped;
+    }
+    std::size_t fill(std::vector<ooo_model_instr>& dest, std::size_t count) override
+    {
+      if constexpr (champsim::is_detected_v<has_fill, T>)
+        return intern_.fill(dest, count);
+
+      // If a fill() member function is not provided, read each instruction
+      std::size_t filled = 0;
+      for (; filled < count && !eof(); ++filled)
+        dest.push_back(intern_());
+      return filled;
+    }
     bool eof() const override
     {
       if constexpr (champsim::is_detected_v<has_eof, T>)
@@ -58,18 +94,78 @@ class tracereader
 
 public:
   template <typename T>
-  tracereader(T&& val) : pimpl_(std::make_unique<reader_model<T>>(std::move(val)))
+  any_reader(T&& val) : pimpl_(std::make_unique<reader_model<T>>(std::move(val)))
+  {
+  }
+
+  ooo_model_instr operator()() { return (*pimpl_)(); }
+  uint64_t skip(uint64_t count) { return pimpl_->skip(count); }
+
+  // Append up to count instructions to the destination. Returns the number that were appended, which is smaller than the count only at the end of the
+  // trace.
+  std::size_t fill(std::vector<ooo_model_instr>& dest, std::size_t count) { return pimpl_->fill(dest, count); }
+
+  bool eof() const { return pimpl_->eof(); }
+};
+
+class tracereader
+{
+  static std::atomic<uint64_t> instr_unique_id;
+
+  any_reader reader_;
+  uint64_t num_read_ = 0;
+  profiler::region read_profile_{};
+  std::vector<ooo_model_instr> batch_{};
+
+public:
+  template <typename T>
+  tracereader(T&& val) : reader_(std::move(val))
   {
   }
 
   auto operator()()
   {
-    auto retval = (*pimpl_)();
+    profiler::timer<> timed{read_profile_};
+    auto retval = reader_();
     retval.instr_id = instr_unique_id++;
+    ++num_read_;
     return retval;
   }
 
-  auto eof() const { return pimpl_->eof(); }
+  // Write up to count instructions to the output, with one call into the underlying reader. Stops early only at the end of the trace.
+  template <typename OutputIt>
+  OutputIt fill(OutputIt out, std::size_t count)
+  {
+    profiler::timer<> timed{read_profile_};
+    batch_.clear();
+    reader_.fill(batch_, count);
+
+    auto id = instr_unique_id.fetch_add(std::size(batch_));
+    for (auto& instr : batch_) {
+      instr.instr_id = id++;
+      *out = std::move(instr);
+      ++out;
+    }
+    num_read_ += std::size(batch_);
+    return out;
+  }
+
+  // Discard the next instructions without simulating them. Returns the number that were discarded, which is smaller than the count only at the end
+  // of the trace.
+  uint64_t skip(uint64_t count)
+  {
+    auto skipped = reader_.skip(count);
+    num_read_ += skipped;
+    return skipped;
+  }
+
+  // The number of instructions that have been read or skipped
+  uint64_t num_read() const { return num_read_; }
+
+  // The host time spent reading and decoding instructions, for the self-profiler
+  const profiler::region& profile() const { return read_profile_; }
+
+  auto eof() const { return reader_.eof(); }
 };
 
 template <typename T, typename F>
@@ -89,6 +185,9 @@ class bulk_tracereader
 public:
   ooo_model_instr operator()();
 
+  // Discard instructions without inflating them
+  uint64_t skip(uint64_t count);
+
   bulk_tracereader(uint8_t cpu_idx, std::string tf) : cpu(cpu_idx), trace_file(tf) {}
   bulk_tracereader(uint8_t cpu_idx, F&& file) : cpu(cpu_idx), trace_file(std::move(file)) {}
 
@@ -135,9 +234,30 @@ ooo_model_instr bulk_tracereader<T, F>::operator()()
   return retval;
 }
 
+template <typename T, typename F>
+uint64_t bulk_tracereader<T, F>::skip(uint64_t count)
+{
+  // The last buffered instruction is usually kept until its successor is read, to set its branch target. A skipped instruction needs no target.
+  uint64_t skipped = 0;
+  for (; skipped < count && !std::empty(instr_buffer); ++skipped)
+    instr_buffer.pop_front();
+
+  if (skipped < count) {
+    trace_file.ignore(static_cast<std::streamsize>((count - skipped) * sizeof(T)));
+    skipped += static_cast<uint64_t>(trace_file.gcount()) / sizeof(T);
+    eof_ = trace_file.eof();
+  }
+
+  return skipped;
+}
+
 std::string get_fptr_cmd(std::string_view fname);
 } // namespace champsim
 
-champsim::tracereader get_tracereader(std::string fname, uint8_t cpu, bool is_cloudsuite, bool repeat);
+// If read_ahead is nonzero, the trace is read on a background thread, up to that many batches ahead of the simulation. If decoded_cache_dir is not
+// empty, the decoded instructions are replayed from a cache in that directory, or recorded into it. A repeating trace whose first pass fits in
+// loop_memory bytes is replayed from memory on its later passes.
+champsim::tracereader get_tracereader(std::string fname, uint8_t cpu, bool is_cloudsuite, bool repeat, std::size_t read_ahead = 0,
+                                      const std::string& decoded_cache_dir = {}, std::size_t loop_memory = 0);
 
 #endif
@@ -0,0 +1,67 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef UTIL_SPSC_RING_H
+#define UTIL_SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace champsim
+{
+// A ring of values passed from one producer thread to one consumer thread without locks. One slot is always left empty, to tell a full ring from an
+// empty one.
+template <typename T>
+class spsc_ring
+{
+  std::vector<T> slots;
+  alignas(64) std::atomic<std::size_t> head{0}; // The next slot to pop, written only by the consumer
+  alignas(64) std::atomic<std::size_t> tail{0}; // The next slot to push, written only by the producer
+
+public:
+  explicit spsc_ring(std::size_t capacity) : slots(capacity + 1) {}
+
+  // Move the value into the ring, unless it is full. Called only by the producer.
+  bool try_push(T& value)
+  {
+    auto slot = tail.load(std::memory_order_relaxed);
+    auto next = (slot + 1) % std::size(slots);
+    if (next == head.load(std::memory_order_acquire))
+      return false;
+    slots[slot] = std::move(value);
+    tail.store(next, std::memory_order_release);
+    return true;
+  }
+
+  // Move the oldest value out of the ring, unless it is empty. Called only by the consumer.
+  bool try_pop(T& value)
+  {
+    auto slot = head.load(std::memory_order_relaxed);
+    if (slot == tail.load(std::memory_order_acquire))
+      return false;
+    value = std::move(slots[slot]);
+    head.store((slot + 1) % std::size(slots), std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+  bool full() const { return (tail.load(std::memory_order_acquire) + 1) % std::size(slots) == head.load(std::memory_order_acquire); }
+};
+} // namespace champsim
+
+#endif
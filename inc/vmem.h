@@ -17,8 +17,11 @@
 #ifndef VMEM_H
 #define VMEM_H
 
+#include <array>
 #include <cstdint>
+#include <iosfwd>
 #include <map>
+#include <mutex>
 
 #include "champsim_constants.h"
 
@@ -35,13 +38,17 @@ private:
   std::map<std::pair<uint32_t, uint64_t>, uint64_t> vpage_to_ppage_map;
   std::map<std::tuple<uint32_t, uint64_t, uint32_t>, uint64_t> page_table;
 
-  uint64_t next_pte_page = 0;
-
-  uint64_t next_ppage;
+  // Each core takes every NUM_CPUS-th page, starting from its own, so that the pages it is given do not depend on the order in which the cores
+  // translate. The cores of a parallel phase translate on their own threads.
+  std::array<uint64_t, NUM_CPUS> next_pte_page{};
+  std::array<uint64_t, NUM_CPUS> next_ppage;
   uint64_t last_ppage;
 
-  uint64_t ppage_front() const;
-  void ppage_pop();
+  // Page table walkers in different slices may translate concurrently during parallel phases
+  std::mutex allocation_mutex;
+
+  uint64_t ppage_front(uint32_t cpu_num) const;
+  void ppage_pop(uint32_t cpu_num);
 
 public:
   const uint64_t minor_fault_penalty;
@@ -55,6 +62,10 @@ public:
   std::size_t available_ppages() const;
   std::pair<uint64_t, uint64_t> va_to_pa(uint32_t cpu_num, uint64_t vaddr);
   std::pair<uint64_t, uint64_t> get_pte_pa(uint32_t cpu_num, uint64_t vaddr, std::size_t level);
+
+  // Save and restore the page mappings, so that a restored simulation translates each address as before
+  void save_checkpoint(std::ostream& stream);
+  void load_checkpoint(std::istream& stream);
 };
 
 #endif
@@ -4,6 +4,7 @@
 #include <optional>
 
 #include "cache.h"
+#include "checkpoint.h"
 #include "msl/lru_table.h"
 
 namespace
@@ -33,6 +34,9 @@ struct tracker {
   champsim::msl::lru_table<tracker_entry> table{TRACKER_SETS, TRACKER_WAYS};
 
 public:
+  auto checkpoint_fields() const { return std::tie(active_lookahead, table); }
+  auto checkpoint_fields() { return std::tie(active_lookahead, table); }
+
   void initiate_lookahead(uint64_t ip, uint64_t cl_addr)
   {
     int64_t stride = 0;
@@ -86,7 +90,7 @@ public:
 std::map<CACHE*, tracker> trackers;
 } // namespace
 
-void CACHE::prefetcher_initialize() {}
+void CACHE::prefetcher_initialize() { ::trackers[this] = {}; }
 
 void CACHE::prefetcher_cycle_operate() { ::trackers[this].advance_lookahead(this); }
 
@@ -102,3 +106,7 @@ uint32_t CACHE::prefetcher_cache_fill(uint64_t addr, uint32_t set, uint32_t way,
 }
 
 void CACHE::prefetcher_final_stats() {}
+
+void CACHE::prefetcher_checkpoint(std::ostream& stream) { champsim::checkpoint::save(stream, ::trackers.at(this)); }
+
+void CACHE::prefetcher_restore(std::istream& stream) { champsim::checkpoint::load(stream, ::trackers.at(this)); }
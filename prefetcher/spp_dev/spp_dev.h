@@ -47,6 +47,8 @@ constexpr std::size_t MAX_GHR_ENTRY = 8;
 enum FILTER_REQUEST { SPP_L2C_PREFETCH, SPP_LLC_PREFETCH, L2C_DEMAND, L2C_EVICT }; // Request type for prefetch filter
 uint64_t get_hash(uint64_t key);
 
+class GLOBAL_REGISTER;
+
 class SIGNATURE_TABLE
 {
 public:
@@ -65,7 +67,7 @@ public:
       }
   };
 
-  void read_and_update_sig(uint64_t page, uint32_t page_offset, uint32_t& last_sig, uint32_t& curr_sig, int32_t& delta);
+  void read_and_update_sig(uint64_t page, uint32_t page_offset, uint32_t& last_sig, uint32_t& curr_sig, int32_t& delta, GLOBAL_REGISTER& GHR);
 };
 
 class PATTERN_TABLE
@@ -86,7 +88,8 @@ public:
   }
 
   void update_pattern(uint32_t last_sig, int curr_delta), read_pattern(uint32_t curr_sig, std::vector<int>&prefetch_delta, std::vector<uint32_t>&confidence_q,
-                                                                       uint32_t&lookahead_way, uint32_t&lookahead_conf, uint32_t&pf_q_tail, uint32_t&depth);
+                                                                       uint32_t&lookahead_way, uint32_t&lookahead_conf, uint32_t&pf_q_tail, uint32_t&depth,
+                                                                       const GLOBAL_REGISTER& GHR);
 };
 
 class PREFETCH_FILTER
@@ -105,7 +108,7 @@ public:
     }
   }
 
-  bool check(uint64_t pf_addr, FILTER_REQUEST filter_request);
+  bool check(uint64_t pf_addr, FILTER_REQUEST filter_request, GLOBAL_REGISTER& GHR);
 };
 
 class GLOBAL_REGISTER
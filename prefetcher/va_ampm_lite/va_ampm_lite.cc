@@ -1,8 +1,10 @@
+#include <atomic>
 #include <bitset>
 #include <map>
 #include <vector>
 
 #include "cache.h"
+#include "checkpoint.h"
 
 namespace
 {
@@ -16,12 +18,12 @@ struct region_type {
   std::bitset<PAGE_SIZE / BLOCK_SIZE> prefetch_map{};
   uint64_t lru;
 
-  static uint64_t region_lru;
+  static std::atomic<uint64_t> region_lru;
 
   region_type() : region_type(0) {}
   explicit region_type(uint64_t allocate_vpn) : vpn(allocate_vpn), lru(region_lru++) {}
 };
-uint64_t region_type::region_lru = 0;
+std::atomic<uint64_t> region_type::region_lru = 0;
 
 std::map<CACHE*, std::array<region_type, REGION_COUNT>> regions;
 
@@ -107,3 +109,17 @@ uint32_t CACHE::prefetcher_cache_fill(uint64_t addr, uint32_t set, uint32_t way,
 
 void CACHE::prefetcher_cycle_operate() {}
 void CACHE::prefetcher_final_stats() {}
+
+void CACHE::prefetcher_checkpoint(std::ostream& stream) { champsim::checkpoint::save(stream, ::regions.at(this)); }
+
+void CACHE::prefetcher_restore(std::istream& stream)
+{
+  champsim::checkpoint::load(stream, ::regions.at(this));
+
+  // Regions allocated from now on must be younger than every restored region
+  for (const auto& region : ::regions.at(this)) {
+    auto current = ::region_type::region_lru.load();
+    while (current <= region.lru && !::region_type::region_lru.compare_exchange_weak(current, region.lru + 1)) {
+    }
+  }
+}
@@ -4,6 +4,7 @@
 #include <utility>
 
 #include "cache.h"
+#include "checkpoint.h"
 #include "msl/fwcounter.h"
 
 namespace
@@ -39,6 +40,9 @@ void CACHE::initialize_replacement()
   }
 
   ::rrpv.insert({this, std::vector<unsigned>(NUM_SET * NUM_WAY)});
+  ::bip_counter[this] = 0;
+  for (std::size_t cpu_idx = 0; cpu_idx < NUM_CPUS; ++cpu_idx)
+    ::PSEL[std::make_pair(this, cpu_idx)] = {};
 }
 
 // called on every cache hit and cache fill
@@ -108,3 +112,18 @@ uint32_t CACHE::find_victim(uint32_t triggering_cpu, uint64_t instr_id, uint32_t
 
 // use this function to print out your own stats at the end of simulation
 void CACHE::replacement_final_stats() {}
+
+void CACHE::checkpoint_replacement(std::ostream& stream)
+{
+  champsim::checkpoint::save(stream, std::tie(::bip_counter.at(this), ::rrpv.at(this)));
+  for (std::size_t cpu_idx = 0; cpu_idx < NUM_CPUS; ++cpu_idx)
+    champsim::checkpoint::save(stream, ::PSEL.at(std::make_pair(this, cpu_idx)));
+}
+
+void CACHE::restore_replacement(std::istream& stream)
+{
+  auto fields = std::tie(::bip_counter.at(this), ::rrpv.at(this));
+  champsim::checkpoint::load(stream, fields);
+  for (std::size_t cpu_idx = 0; cpu_idx < NUM_CPUS; ++cpu_idx)
+    champsim::checkpoint::load(stream, ::PSEL.at(std::make_pair(this, cpu_idx)));
+}
@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "cache.h"
+#include "checkpoint.h"
 
 namespace
 {
@@ -33,3 +34,7 @@ void CACHE::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint
 }
 
 void CACHE::replacement_final_stats() {}
+
+void CACHE::checkpoint_replacement(std::ostream& stream) { champsim::checkpoint::save(stream, ::last_used_cycles.at(this)); }
+
+void CACHE::restore_replacement(std::istream& stream) { champsim::checkpoint::load(stream, ::last_used_cycles.at(this)); }
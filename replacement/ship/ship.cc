@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "cache.h"
+#include "checkpoint.h"
 #include "msl/bits.h"
 
 namespace
@@ -57,6 +58,9 @@ void CACHE::initialize_replacement()
   sampler.emplace(this, ::SAMPLER_SET * NUM_WAY);
 
   ::rrpv_values[this] = std::vector<int>(NUM_SET * NUM_WAY, ::maxRRPV);
+
+  for (std::size_t cpu_idx = 0; cpu_idx < NUM_CPUS; ++cpu_idx)
+    ::SHCT[std::make_pair(this, cpu_idx)] = {};
 }
 
 // find replacement victim
@@ -137,3 +141,18 @@ void CACHE::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint
 
 // use this function to print out your own stats at the end of simulation
 void CACHE::replacement_final_stats() {}
+
+void CACHE::checkpoint_replacement(std::ostream& stream)
+{
+  champsim::checkpoint::save(stream, std::tie(::sampler.at(this), ::rrpv_values.at(this)));
+  for (std::size_t cpu_idx = 0; cpu_idx < NUM_CPUS; ++cpu_idx)
+    champsim::checkpoint::save(stream, ::SHCT.at(std::make_pair(this, cpu_idx)));
+}
+
+void CACHE::restore_replacement(std::istream& stream)
+{
+  auto fields = std::tie(::sampler.at(this), ::rrpv_values.at(this));
+  champsim::checkpoint::load(stream, fields);
+  for (std::size_t cpu_idx = 0; cpu_idx < NUM_CPUS; ++cpu_idx)
+    champsim::checkpoint::load(stream, ::SHCT.at(std::make_pair(this, cpu_idx)));
+}
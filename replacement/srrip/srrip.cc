@@ -1,6 +1,7 @@
 #include <cassert>
 
 #include "cache.h"
+#include "checkpoint.h"
 #include <unordered_map>
 
 namespace
@@ -43,3 +44,7 @@ void CACHE::update_replacement_state(uint32_t triggering_cpu, uint32_t set, uint
 
 // use this function to print out your own stats at the end of simulation
 void CACHE::replacement_final_stats() {}
+
+void CACHE::checkpoint_replacement(std::ostream& stream) { champsim::checkpoint::save(stream, ::rrpv_values.at(this)); }
+
+void CACHE::restore_replacement(std::istream& stream) { champsim::checkpoint::load(stream, ::rrpv_values.at(this)); }
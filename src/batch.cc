@@ -0,0 +1,70 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "batch.h"
+
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+#include "checkpoint.h"
+#include "operable.h"
+#include <fmt/core.h>
+
+std::vector<champsim::batch_job> champsim::read_batch_manifest(std::istream& manifest, std::size_t num_cpus)
+{
+  std::vector<batch_job> result;
+  std::string line;
+  for (std::size_t line_number = 1; std::getline(manifest, line); ++line_number) {
+    std::istringstream line_stream{line};
+    std::vector<std::string> fields{std::istream_iterator<std::string>{line_stream}, std::istream_iterator<std::string>{}};
+    if (std::empty(fields) || fields.front().front() == '#')
+      continue;
+
+    if (std::size(fields) != num_cpus + 1)
+      throw std::runtime_error(fmt::format("Line {} of the batch manifest should hold {} traces and a JSON file name", line_number, num_cpus));
+
+    auto& job = result.emplace_back();
+    job.json_file_name = fields.back();
+    fields.pop_back();
+    job.trace_names = std::move(fields);
+  }
+
+  return result;
+}
+
+champsim::batch::batch(environment& env_) : env(env_), calendar(env_.operable_view())
+{
+  for (operable& op : env.operable_view())
+    op.initialize();
+
+  // The initial state is kept in memory as a checkpoint, before any trace is read
+  std::ostringstream stream;
+  checkpoint::save_environment(stream, env, calendar, {}, {});
+  initial_state = stream.str();
+}
+
+void champsim::batch::reset(std::vector<tracereader>& traces, const std::vector<std::size_t>& trace_index)
+{
+  for (operable& op : env.operable_view()) {
+    op.clear_inflight();
+    op.wake();
+  }
+
+  std::istringstream stream{initial_state};
+  checkpoint::load_environment(stream, env, calendar, traces, trace_index);
+}
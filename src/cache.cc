@@ -19,6 +19,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <functional>
 #include <iomanip>
 #include <numeric>
 #include <fmt/core.h>
@@ -26,6 +27,7 @@
 
 #include "champsim.h"
 #include "champsim_constants.h"
+#include "checkpoint.h"
 #include "deadlock.h"
 #include "instruction.h"
 #include "util/algorithm.h"
@@ -79,11 +81,8 @@ CACHE::BLOCK::BLOCK(mshr_type mshr)
 {
 }
 
-bool CACHE::handle_fill(const mshr_type& fill_mshr)
+std::size_t CACHE::find_fill_way(const mshr_type& fill_mshr)
 {
-  cpu = fill_mshr.cpu;
-
-  // find victim
   auto [set_begin, set_end] = get_set_span(fill_mshr.address);
   auto way = std::find_if_not(set_begin, set_end, [](auto x) { return x.valid; });
   if (way == set_end)
@@ -91,57 +90,47 @@ bool CACHE::handle_fill(const mshr_type& fill_mshr)
                                                 fill_mshr.address, champsim::to_underlying(fill_mshr.type)));
   assert(set_begin <= way);
   assert(way <= set_end);
-  const auto way_idx = static_cast<std::size_t>(std::distance(set_begin, way)); // cast protected by earlier assertion
-
-  if constexpr (champsim::debug_print) {
-    fmt::print(
-        "[{}] {} instr_id: {} address: {:#x} v_address: {:#x} set: {} way: {} type: {} prefetch_metadata: {} cycle_enqueued: {} cycle: {}\n",
-        NAME, __func__, fill_mshr.instr_id, fill_mshr.address, fill_mshr.v_address, get_set_index(fill_mshr.address), way_idx,
-        access_type_names.at(champsim::to_underlying(fill_mshr.type)), fill_mshr.pf_metadata, fill_mshr.cycle_enqueued, current_cycle);
-  }
+  return static_cast<std::size_t>(std::distance(set_begin, way)); // cast protected by earlier assertion
+}
 
-  bool success = true;
-  auto metadata_thru = fill_mshr.pf_metadata;
-  auto pkt_address = (virtual_prefetch ? fill_mshr.v_address : fill_mshr.address) & ~champsim::bitmask(match_offset_bits ? 0 : OFFSET_BITS);
-  if (way != set_end) {
-    if (way->valid && way->dirty) {
-      request_type writeback_packet;
-
-      writeback_packet.cpu = fill_mshr.cpu;
-      writeback_packet.address = way->address;
-      writeback_packet.data = way->data;
-      writeback_packet.instr_id = fill_mshr.instr_id;
-      writeback_packet.ip = 0;
-      writeback_packet.type = access_type::WRITE;
-      writeback_packet.pf_metadata = way->pf_metadata;
-      writeback_packet.response_requested = false;
+auto CACHE::writeback_of(const BLOCK& victim, const mshr_type& fill_mshr) const -> request_type
+{
+  request_type writeback_packet;
 
-      if constexpr (champsim::debug_print) {
-        fmt::print("[{}] {} evict address: {:#x} v_address: {:#x} prefetch_metadata: {}\n", NAME,
-            __func__, writeback_packet.address, writeback_packet.v_address, fill_mshr.pf_metadata);
-      }
+  writeback_packet.cpu = fill_mshr.cpu;
+  writeback_packet.address = victim.address;
+  writeback_packet.data = victim.data;
+  writeback_packet.instr_id = fill_mshr.instr_id;
+  writeback_packet.ip = 0;
+  writeback_packet.type = access_type::WRITE;
+  writeback_packet.pf_metadata = victim.pf_metadata;
+  writeback_packet.response_requested = false;
 
-      success = lower_level->add_wq(writeback_packet);
-    }
+  return writeback_packet;
+}
 
-    if (success) {
-      auto evicting_address = (ever_seen_data ? way->address : way->v_address) & ~champsim::bitmask(match_offset_bits ? 0 : OFFSET_BITS);
+uint32_t CACHE::fill_way(const mshr_type& fill_mshr, std::size_t way_idx)
+{
+  auto metadata_thru = fill_mshr.pf_metadata;
+  auto pkt_address = (virtual_prefetch ? fill_mshr.v_address : fill_mshr.address) & ~champsim::bitmask(match_offset_bits ? 0 : OFFSET_BITS);
+  if (way_idx < NUM_WAY) {
+    auto way = std::next(get_set_span(fill_mshr.address).first, static_cast<set_type::difference_type>(way_idx));
+    auto evicting_address = (ever_seen_data ? way->address : way->v_address) & ~champsim::bitmask(match_offset_bits ? 0 : OFFSET_BITS);
 
-      if (way->prefetch)
-        ++sim_stats.pf_useless;
+    if (way->prefetch)
+      ++sim_stats.pf_useless;
 
-      if (fill_mshr.type == access_type::PREFETCH)
-        ++sim_stats.pf_fill;
+    if (fill_mshr.type == access_type::PREFETCH)
+      ++sim_stats.pf_fill;
 
-      *way = BLOCK{fill_mshr};
+    *way = BLOCK{fill_mshr};
 
-      metadata_thru = impl_prefetcher_cache_fill(pkt_address, get_set_index(fill_mshr.address), way_idx, fill_mshr.type == access_type::PREFETCH,
-                                                 evicting_address, metadata_thru);
-      impl_update_replacement_state(fill_mshr.cpu, get_set_index(fill_mshr.address), way_idx, fill_mshr.address, fill_mshr.ip, evicting_address,
-                                    champsim::to_underlying(fill_mshr.type), false);
+    metadata_thru = impl_prefetcher_cache_fill(pkt_address, get_set_index(fill_mshr.address), way_idx, fill_mshr.type == access_type::PREFETCH,
+                                               evicting_address, metadata_thru);
+    impl_update_replacement_state(fill_mshr.cpu, get_set_index(fill_mshr.address), way_idx, fill_mshr.address, fill_mshr.ip, evicting_address,
+                                  champsim::to_underlying(fill_mshr.type), false);
 
-      way->pf_metadata = metadata_thru;
-    }
+    way->pf_metadata = metadata_thru;
   } else {
     // Bypass
     assert(fill_mshr.type != access_type::WRITE);
@@ -152,7 +141,41 @@ bool CACHE::handle_fill(const mshr_type& fill_mshr)
                                   champsim::to_underlying(fill_mshr.type), false);
   }
 
+  return metadata_thru;
+}
+
+bool CACHE::handle_fill(const mshr_type& fill_mshr)
+{
+  cpu = fill_mshr.cpu;
+
+  // find victim
+  const auto way_idx = find_fill_way(fill_mshr);
+
+  if constexpr (champsim::debug_print) {
+    fmt::print(
+        "[{}] {} instr_id: {} address: {:#x} v_address: {:#x} set: {} way: {} type: {} prefetch_metadata: {} cycle_enqueued: {} cycle: {}\n",
+        NAME, __func__, fill_mshr.instr_id, fill_mshr.address, fill_mshr.v_address, get_set_index(fill_mshr.address), way_idx,
+        access_type_names.at(champsim::to_underlying(fill_mshr.type)), fill_mshr.pf_metadata, fill_mshr.cycle_enqueued, current_cycle);
+  }
+
+  bool success = true;
+  if (way_idx < NUM_WAY) {
+    const auto& way = *std::next(get_set_span(fill_mshr.address).first, static_cast<set_type::difference_type>(way_idx));
+    if (way.valid && way.dirty) {
+      auto writeback_packet = writeback_of(way, fill_mshr);
+
+      if constexpr (champsim::debug_print) {
+        fmt::print("[{}] {} evict address: {:#x} v_address: {:#x} prefetch_metadata: {}\n", NAME,
+            __func__, writeback_packet.address, writeback_packet.v_address, fill_mshr.pf_metadata);
+      }
+
+      success = lower_level->add_wq(writeback_packet);
+    }
+  }
+
   if (success) {
+    auto metadata_thru = fill_way(fill_mshr, way_idx);
+
     // COLLECT STATS
     sim_stats.total_miss_latency += current_cycle - (fill_mshr.cycle_enqueued + 1);
 
@@ -331,17 +354,25 @@ auto CACHE::initiate_tag_check(champsim::channel* ul)
 long CACHE::operate()
 {
   long progress{0};
+  auto timed = [this](stage which) { return champsim::profiler::timer<>{stage_profile[champsim::to_underlying(which)]}; };
 
-  for (auto ul : upper_levels)
-    ul->check_collision();
+  {
+    auto stage_timer = timed(stage::collision);
+    for (auto ul : upper_levels)
+      ul->check_collision();
+  }
 
   // Finish returns
-  std::for_each(std::cbegin(lower_level->returned), std::cend(lower_level->returned), [this](const auto& pkt) { this->finish_packet(pkt); });
-  progress += std::distance(std::cbegin(lower_level->returned), std::cend(lower_level->returned));
-  lower_level->returned.clear();
+  {
+    auto stage_timer = timed(stage::returns);
+    std::for_each(std::cbegin(lower_level->returned), std::cend(lower_level->returned), [this](const auto& pkt) { this->finish_packet(pkt); });
+    progress += std::distance(std::cbegin(lower_level->returned), std::cend(lower_level->returned));
+    lower_level->returned.clear();
+  }
 
   // Finish translations
   if (lower_translate != nullptr) {
+    auto stage_timer = timed(stage::translation);
     std::for_each(std::cbegin(lower_translate->returned), std::cend(lower_translate->returned), [this](const auto& pkt) { this->finish_translation(pkt); });
     progress += std::distance(std::cbegin(lower_translate->returned), std::cend(lower_translate->returned));
     lower_translate->returned.clear();
@@ -349,39 +380,51 @@ long CACHE::operate()
 
   // Perform fills
   auto fill_bw = MAX_FILL;
-  for (auto q : {std::ref(MSHR), std::ref(inflight_writes)}) {
-    auto [fill_begin, fill_end] =
-        champsim::get_span_p(std::cbegin(q.get()), std::cend(q.get()), fill_bw, [cycle = current_cycle](const auto& x) { return x.event_cycle <= cycle; });
-    auto complete_end = std::find_if_not(fill_begin, fill_end, [this](const auto& x) { return this->handle_fill(x); });
-    fill_bw -= std::distance(fill_begin, complete_end);
-    q.get().erase(fill_begin, complete_end);
+  {
+    auto stage_timer = timed(stage::fill);
+    for (auto q : {std::ref(MSHR), std::ref(inflight_writes)}) {
+      auto [fill_begin, fill_end] =
+          champsim::get_span_p(std::cbegin(q.get()), std::cend(q.get()), fill_bw, [cycle = current_cycle](const auto& x) { return x.event_cycle <= cycle; });
+      auto complete_end = std::find_if_not(fill_begin, fill_end, [this](const auto& x) { return this->handle_fill(x); });
+      fill_bw -= std::distance(fill_begin, complete_end);
+      q.get().erase(fill_begin, complete_end);
+    }
+    progress += MAX_FILL - fill_bw;
   }
-  progress += MAX_FILL - fill_bw;
 
   // Initiate tag checks
   auto tag_bw = std::max(0ll, std::min<long long>(static_cast<long long>(MAX_TAG), MAX_TAG * HIT_LATENCY - std::size(inflight_tag_check)));
-  auto can_translate = [avail = (std::size(translation_stash) < static_cast<std::size_t>(MSHR_SIZE))](const auto& entry) {
-    return avail || entry.is_translated;
-  };
-  auto stash_bandwidth_consumed = champsim::transform_while_n(
-      translation_stash, std::back_inserter(inflight_tag_check), tag_bw, [](const auto& entry) { return entry.is_translated; }, initiate_tag_check<false>());
-  tag_bw -= stash_bandwidth_consumed;
-  progress += stash_bandwidth_consumed;
+  long stash_bandwidth_consumed{0}, pq_bandwidth_consumed{0};
   std::vector<long long> channels_bandwidth_consumed{};
-  for (auto* ul : upper_levels) {
-    for (auto q : {std::ref(ul->WQ), std::ref(ul->RQ), std::ref(ul->PQ)}) {
-      auto bandwidth_consumed = champsim::transform_while_n(q.get(), std::back_inserter(inflight_tag_check), tag_bw, can_translate, initiate_tag_check<true>(ul));
-      channels_bandwidth_consumed.push_back(bandwidth_consumed);
-      tag_bw -= bandwidth_consumed;
-      progress += bandwidth_consumed;
+  {
+    auto stage_timer = timed(stage::tag_check);
+    auto can_translate = [avail = (std::size(translation_stash) < static_cast<std::size_t>(MSHR_SIZE))](const auto& entry) {
+      return avail || entry.is_translated;
+    };
+    stash_bandwidth_consumed = champsim::transform_while_n(
+        translation_stash, std::back_inserter(inflight_tag_check), tag_bw, [](const auto& entry) { return entry.is_translated; }, initiate_tag_check<false>());
+    tag_bw -= stash_bandwidth_consumed;
+    progress += stash_bandwidth_consumed;
+    for (auto* ul : upper_levels) {
+      for (auto q : {std::ref(ul->WQ), std::ref(ul->RQ), std::ref(ul->PQ)}) {
+        auto bandwidth_consumed =
+            champsim::transform_while_n(q.get(), std::back_inserter(inflight_tag_check), tag_bw, can_translate, initiate_tag_check<true>(ul));
+        channels_bandwidth_consumed.push_back(bandwidth_consumed);
+        tag_bw -= bandwidth_consumed;
+        progress += bandwidth_consumed;
+      }
     }
+    pq_bandwidth_consumed =
+        champsim::transform_while_n(internal_PQ, std::back_inserter(inflight_tag_check), tag_bw, can_translate, initiate_tag_check<false>());
+    tag_bw -= pq_bandwidth_consumed;
+    progress += pq_bandwidth_consumed;
   }
-  auto pq_bandwidth_consumed = champsim::transform_while_n(internal_PQ, std::back_inserter(inflight_tag_check), tag_bw, can_translate, initiate_tag_check<false>());
-  tag_bw -= pq_bandwidth_consumed;
-  progress += pq_bandwidth_consumed;
 
   // Issue translations
-  issue_translation();
+  {
+    auto stage_timer = timed(stage::translation);
+    issue_translation();
+  }
 
   // Find entries that would be ready except that they have not finished translation, move them to the stash
   auto [last_not_missed, stash_end] =
@@ -391,6 +434,30 @@ long CACHE::operate()
   inflight_tag_check.erase(last_not_missed, std::end(inflight_tag_check));
 
   // Perform tag checks
+  long tag_bw_consumed{0};
+  {
+    auto stage_timer = timed(stage::tag_check);
+    tag_bw_consumed = perform_tag_checks();
+    progress += tag_bw_consumed;
+  }
+
+  {
+    auto stage_timer = timed(stage::prefetcher);
+    impl_prefetcher_cycle_operate();
+  }
+
+  if constexpr (champsim::debug_print) {
+    fmt::print("[{}] {} cycle completed: {} tags checked: {} remaining: {} stash consumed: {} remaining: {} channel consumed: {} pq consumed {} unused consume bw {}\n", NAME, __func__, current_cycle,
+        tag_bw_consumed, std::size(inflight_tag_check),
+        stash_bandwidth_consumed, std::size(translation_stash),
+        channels_bandwidth_consumed, pq_bandwidth_consumed, tag_bw);
+  }
+
+  return progress;
+}
+
+long CACHE::perform_tag_checks()
+{
   auto do_tag_check = [this](const auto& pkt) {
     if (this->try_hit(pkt))
       return true;
@@ -404,18 +471,68 @@ long CACHE::operate()
                            [cycle = current_cycle](const auto& pkt) { return pkt.event_cycle <= cycle && pkt.is_translated; });
   auto finish_tag_check_end = std::find_if_not(tag_check_ready_begin, tag_check_ready_end, do_tag_check);
   auto tag_bw_consumed = std::distance(tag_check_ready_begin, finish_tag_check_end);
-  progress += std::distance(tag_check_ready_begin, finish_tag_check_end);
   inflight_tag_check.erase(tag_check_ready_begin, finish_tag_check_end);
 
-  impl_prefetcher_cycle_operate();
+  return tag_bw_consumed;
+}
 
-  if constexpr (champsim::debug_print) {
-    fmt::print("[{}] {} cycle completed: {} tags checked: {} remaining: {} stash consumed: {} remaining: {} channel consumed: {} pq consumed {} unused consume bw {}\n", NAME, __func__, current_cycle,
-        tag_bw_consumed, std::size(inflight_tag_check),
-        stash_bandwidth_consumed, std::size(translation_stash),
-        channels_bandwidth_consumed, pq_bandwidth_consumed, tag_bw);
+uint64_t CACHE::next_event_cycle() const
+{
+  if (!std::empty(lower_level->returned) || (lower_translate != nullptr && !std::empty(lower_translate->returned)))
+    return current_cycle;
+
+  // Collision checks and tag check initiation
+  auto tag_bw = std::max(0ll, std::min<long long>(static_cast<long long>(MAX_TAG), MAX_TAG * HIT_LATENCY - std::size(inflight_tag_check)));
+  auto can_initiate = [tag_bw, avail = (std::size(translation_stash) < static_cast<std::size_t>(MSHR_SIZE))](const auto& q) {
+    return tag_bw > 0 && !std::empty(q) && (avail || q.front().is_translated);
+  };
+  for (auto* ul : upper_levels) {
+    for (auto q : {std::cref(ul->WQ), std::cref(ul->RQ), std::cref(ul->PQ)}) {
+      if (can_initiate(q.get()) || std::any_of(std::begin(q.get()), std::end(q.get()), std::not_fn(&request_type::forward_checked)))
+        return current_cycle;
+    }
+  }
+
+  if (can_initiate(internal_PQ) || (tag_bw > 0 && !std::empty(translation_stash) && translation_stash.front().is_translated))
+    return current_cycle;
+
+  uint64_t next_event = std::numeric_limits<uint64_t>::max();
+  auto consider = [&next_event](uint64_t cycle) { next_event = std::min(next_event, cycle); };
+
+  // Untranslated tag checks move to the stash after their event cycle. Other tag checks and translations are handled by skip_operate().
+  for (const auto& entry : inflight_tag_check) {
+    if (!entry.is_translated)
+      consider(entry.event_cycle + 1);
   }
 
+  for (const auto& entry : MSHR)
+    consider(entry.event_cycle);
+  for (const auto& entry : inflight_writes)
+    consider(entry.event_cycle);
+
+  return std::max(next_event, current_cycle);
+}
+
+std::size_t CACHE::input_occupancy() const
+{
+  auto occupancy = std::accumulate(std::begin(upper_levels), std::end(upper_levels), std::size(internal_PQ) + std::size(lower_level->returned),
+                                   [](std::size_t acc, const auto* ul) { return acc + ul->rq_occupancy() + ul->wq_occupancy() + ul->pq_occupancy(); });
+  if (lower_translate != nullptr)
+    occupancy += std::size(lower_translate->returned);
+  return occupancy;
+}
+
+long CACHE::skip_operate()
+{
+  // Translations and tag checks that are blocked by full queues are retried on every cycle
+  if (lower_translate != nullptr)
+    issue_translation();
+
+  auto progress = perform_tag_checks();
+
+  // The prefetcher observes every cycle. New prefetches wake this cache through internal_PQ.
+  impl_prefetcher_cycle_operate();
+
   return progress;
 }
 
@@ -495,6 +612,53 @@ int CACHE::prefetch_line(uint64_t, uint64_t, uint64_t pf_addr, bool fill_this_le
 }
 // LCOV_EXCL_STOP
 
+auto CACHE::warm_access(const request_type& req, bool local_prefetch) -> std::optional<uint64_t>
+{
+  if (!try_hit(tag_lookup_type{req, local_prefetch, false})) {
+    ++sim_stats.misses[champsim::to_underlying(req.type)][req.cpu];
+    return std::nullopt;
+  }
+
+  auto [set_begin, set_end] = get_set_span(req.address);
+  auto way = std::find_if(set_begin, set_end, [match = req.address >> OFFSET_BITS, shamt = OFFSET_BITS](const auto& entry) { return (entry.address >> shamt) == match; });
+  return way->data;
+}
+
+auto CACHE::warm_fill(const request_type& req, bool local_prefetch) -> std::optional<request_type>
+{
+  mshr_type fill_mshr{tag_lookup_type{req, local_prefetch, false}, current_cycle};
+  cpu = fill_mshr.cpu;
+
+  const auto way_idx = find_fill_way(fill_mshr);
+  std::optional<request_type> writeback{};
+  if (way_idx < NUM_WAY) {
+    const auto& way = *std::next(get_set_span(fill_mshr.address).first, static_cast<set_type::difference_type>(way_idx));
+    if (way.valid && way.dirty)
+      writeback = writeback_of(way, fill_mshr);
+  }
+
+  fill_way(fill_mshr, way_idx);
+  return writeback;
+}
+
+auto CACHE::warm_prefetches() -> std::vector<request_type>
+{
+  std::vector<request_type> issued;
+  std::transform(std::begin(internal_PQ), std::end(internal_PQ), std::back_inserter(issued), [](const tag_lookup_type& entry) {
+    request_type pf_packet;
+    pf_packet.type = entry.type;
+    pf_packet.pf_metadata = entry.pf_metadata;
+    pf_packet.cpu = entry.cpu;
+    pf_packet.address = entry.address;
+    pf_packet.v_address = entry.v_address;
+    pf_packet.is_translated = entry.is_translated;
+    pf_packet.response_requested = !entry.skip_fill;
+    return pf_packet;
+  });
+  internal_PQ.clear();
+  return issued;
+}
+
 void CACHE::finish_packet(const response_type& packet)
 {
   // check MSHR information
@@ -676,6 +840,67 @@ void CACHE::initialize()
   impl_initialize_replacement();
 }
 
+void CACHE::save_checkpoint(std::ostream& stream)
+{
+  champsim::checkpoint::save(stream, std::tie(block, ever_seen_data));
+  impl_prefetcher_checkpoint(stream);
+  impl_checkpoint_replacement(stream);
+}
+
+void CACHE::load_checkpoint(std::istream& stream)
+{
+  auto fields = std::tie(block, ever_seen_data);
+  champsim::checkpoint::load(stream, fields);
+  if (std::size(block) != NUM_SET * NUM_WAY)
+    throw std::runtime_error("Checkpoint does not match the configuration of " + NAME);
+
+  impl_prefetcher_restore(stream);
+  impl_restore_replacement(stream);
+}
+
+std::vector<std::pair<std::string, champsim::profiler::region>> CACHE::profile() const
+{
+  constexpr std::array<std::string_view, std::tuple_size_v<decltype(stage_profile)>> stage_names{
+      {"collision check", "returns", "translation", "fill", "tag check", "prefetcher"}};
+
+  std::vector<std::pair<std::string, champsim::profiler::region>> result{{NAME, operate_profile}};
+  for (std::size_t i = 0; i < std::size(stage_profile); ++i)
+    result.emplace_back(fmt::format("{} {}", NAME, stage_names[i]), stage_profile[i]);
+  return result;
+}
+
+void CACHE::clear_inflight()
+{
+  internal_PQ.clear();
+  inflight_tag_check.clear();
+  translation_stash.clear();
+  MSHR.clear();
+  inflight_writes.clear();
+  for (auto ul : upper_levels)
+    ul->clear();
+}
+
+void CACHE::save_inflight(std::ostream& stream)
+{
+  for (const auto* queue : {&internal_PQ, &inflight_tag_check, &translation_stash}) {
+    champsim::checkpoint::save(stream, std::size(*queue));
+    for (const auto& entry : *queue)
+      champsim::checkpoint::save(stream, std::tie(entry.address, entry.v_address, entry.type, entry.is_translated, entry.event_cycle));
+  }
+  for (const auto* queue : {&MSHR, &inflight_writes}) {
+    champsim::checkpoint::save(stream, std::size(*queue));
+    for (const auto& entry : *queue)
+      champsim::checkpoint::save(stream, std::tie(entry.address, entry.v_address, entry.type, entry.event_cycle));
+  }
+  for (auto ul : upper_levels) {
+    for (const auto* queue : {&ul->RQ, &ul->PQ, &ul->WQ}) {
+      champsim::checkpoint::save(stream, std::size(*queue));
+      for (const auto& entry : *queue)
+        champsim::checkpoint::save(stream, std::tie(entry.address, entry.v_address, entry.type));
+    }
+  }
+}
+
 void CACHE::begin_phase()
 {
   stats_type new_roi_stats, new_sim_stats;
@@ -735,6 +960,26 @@ void CACHE::end_phase(unsigned finished_cpu)
   }
 }
 
+cache_stats operator+(cache_stats lhs, const cache_stats& rhs)
+{
+  lhs.pf_requested += rhs.pf_requested;
+  lhs.pf_issued += rhs.pf_issued;
+  lhs.pf_useful += rhs.pf_useful;
+  lhs.pf_useless += rhs.pf_useless;
+  lhs.pf_fill += rhs.pf_fill;
+
+  auto total_miss = 0ull;
+  for (std::size_t type = 0; type < std::size(lhs.hits); ++type) {
+    std::transform(std::begin(lhs.hits[type]), std::end(lhs.hits[type]), std::begin(rhs.hits[type]), std::begin(lhs.hits[type]), std::plus<>{});
+    std::transform(std::begin(lhs.misses[type]), std::end(lhs.misses[type]), std::begin(rhs.misses[type]), std::begin(lhs.misses[type]), std::plus<>{});
+    total_miss = std::accumulate(std::begin(lhs.misses[type]), std::end(lhs.misses[type]), total_miss);
+  }
+
+  lhs.total_miss_latency += rhs.total_miss_latency;
+  lhs.avg_miss_latency = std::ceil(lhs.total_miss_latency) / std::ceil(total_miss);
+  return lhs;
+}
+
 template <typename T>
 bool CACHE::should_activate_prefetcher(const T& pkt) const
 {
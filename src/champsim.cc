@@ -18,13 +18,35 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <istream>
+#include <iterator>
 #include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
 #include <vector>
 
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "batch.h"
+#include "checkpoint.h"
+#include "clock_calendar.h"
 #include "environment.h"
+#include "forking.h"
+#include "functional_warmup.h"
 #include "ooo_cpu.h"
 #include "operable.h"
 #include "phase_info.h"
+#include "profiler.h"
+#include "quantum.h"
+#include "sampling.h"
+#include "state_hash.h"
 #include "tracereader.h"
 #include <fmt/chrono.h>
 #include <fmt/core.h>
@@ -35,33 +57,116 @@ auto start_time = std::chrono::steady_clock::now();
 
 std::chrono::seconds elapsed_time() { return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now() - start_time); }
 
+namespace
+{
+// Operate one tick of the given calendar, skipping dormant operables
+long operate_tick(champsim::clock_calendar& calendar)
+{
+  long progress{0};
+  for (champsim::operable& op : calendar.next_tick()) {
+    if (op.can_skip()) {
+      progress += op._skip();
+    } else {
+      auto op_progress = op._operate();
+      if (op_progress == 0)
+        op.prepare_skip();
+      else
+        op.wake();
+      progress += op_progress;
+    }
+  }
+  return progress;
+}
+
+// Fill the core's input queue from its trace. Returns whether the trace has reached EOF.
+bool read_trace(O3_CPU& cpu, champsim::tracereader& trace)
+{
+  if (auto pkt_count = cpu.IN_QUEUE_SIZE - static_cast<long>(std::size(cpu.input_queue)); pkt_count > 0)
+    trace.fill(std::back_inserter(cpu.input_queue), static_cast<std::size_t>(pkt_count));
+  return trace.eof();
+}
+
+// The named regions of the self-profiler, in an order that does not change during a run
+std::vector<std::pair<std::string, champsim::profiler::region>> profile_regions(champsim::environment& env, const std::vector<champsim::tracereader>& traces,
+                                                                                 const std::vector<std::size_t>& unique_traces)
+{
+  std::vector<std::pair<std::string, champsim::profiler::region>> result;
+  for (champsim::operable& op : env.operable_view()) {
+    auto regions = op.profile();
+    result.insert(std::end(result), std::begin(regions), std::end(regions));
+  }
+  for (auto idx : unique_traces)
+    result.emplace_back(fmt::format("Trace {} read", idx), traces.at(idx).profile());
+  return result;
+}
+
+// Parallel phases require that no two slices read from the same trace
+bool traces_are_private(const std::vector<champsim::slice>& slices, const std::vector<std::size_t>& trace_index)
+{
+  std::vector<std::size_t> owner(std::size(trace_index), std::size(slices));
+  for (std::size_t i = 0; i < std::size(slices); ++i) {
+    for (O3_CPU& cpu : slices[i].cpus) {
+      auto& trace_owner = owner.at(trace_index.at(cpu.cpu));
+      if (trace_owner != std::size(slices) && trace_owner != i)
+        return false;
+      trace_owner = i;
+    }
+  }
+  return true;
+}
+} // namespace
+
 namespace champsim
 {
-phase_stats do_phase(phase_info phase, environment& env, std::vector<tracereader>& traces)
+phase_stats do_phase(phase_info phase, environment& env, clock_calendar& calendar, std::vector<slice>& slices, std::vector<clock_calendar>& slice_calendars,
+                     std::vector<tracereader>& traces)
 {
-  auto [phase_name, is_warmup, length, trace_index, trace_names] = phase;
   auto operables = env.operable_view();
 
+  // Skip forward in each trace, without simulating. Traces that are already past the point are not moved.
+  auto unique_traces = phase.trace_index;
+  std::sort(std::begin(unique_traces), std::end(unique_traces));
+  unique_traces.erase(std::unique(std::begin(unique_traces), std::end(unique_traces)), std::end(unique_traces));
+  uint64_t skipped{0};
+  for (auto idx : unique_traces) {
+    auto& trace = traces.at(idx);
+    if (trace.num_read() < phase.skip_to)
+      skipped += trace.skip(phase.skip_to - trace.num_read());
+  }
+  if (skipped > 0)
+    fmt::print("{} skipped to instruction {} (Simulation time: {:%H hr %M min %S sec})\n", phase.name, phase.skip_to, elapsed_time());
+
+  // The self-profiler reports the host time spent in each region during the phase
+  decltype(profile_regions(env, traces, unique_traces)) profile_begin;
+  auto profile_begin_ticks = profiler::now();
+  auto profile_begin_time = std::chrono::steady_clock::now();
+  if constexpr (self_profile)
+    profile_begin = profile_regions(env, traces, unique_traces);
+
   // Initialize phase
   for (champsim::operable& op : operables) {
-    op.warmup = is_warmup;
+    op.warmup = phase.is_warmup || phase.is_functional;
     op.begin_phase();
+    op.wake();
   }
 
-  // Perform phase
   int stalled_cycle{0};
   std::vector<bool> phase_complete(std::size(env.cpu_view()), false);
-  while (!std::accumulate(std::begin(phase_complete), std::end(phase_complete), true, std::logical_and{})) {
-    auto next_phase_complete = phase_complete;
 
-    // Operate
-    long progress{0};
-    for (champsim::operable& op : operables) {
-      progress += op._operate();
+  // Functional phases do not advance the clock, so they have no IPC to report
+  auto print_progress = [&](std::string_view event, const O3_CPU& cpu) {
+    if (phase.is_functional) {
+      fmt::print("{} {} CPU {} instructions: {} (functional) (Simulation time: {:%H hr %M min %S sec})\n", phase.name, event, cpu.cpu, cpu.sim_instr(),
+                 elapsed_time());
+    } else {
+      fmt::print("{} {} CPU {} instructions: {} cycles: {} cumulative IPC: {:.4g} (Simulation time: {:%H hr %M min %S sec})\n", phase.name, event, cpu.cpu,
+                 cpu.sim_instr(), cpu.sim_cycle(), std::ceil(cpu.sim_instr()) / std::ceil(cpu.sim_cycle()), elapsed_time());
     }
+  };
 
+  auto check_deadlock = [&](long progress, uint64_t ticks) {
     if (progress == 0) {
-      ++stalled_cycle;
+      stalled_cycle += static_cast<int>(ticks);
     } else {
       stalled_cycle = 0;
     }
@@ -70,25 +175,74 @@ phase_stats do_phase(phase_info phase, environment& env, std::vector<tracereader
       std::for_each(std::begin(operables), std::end(operables), [](champsim::operable& c) { c.print_deadlock(); });
       abort();
     }
+  };
 
-    std::sort(std::begin(operables), std::end(operables),
-              [](const champsim::operable& lhs, const champsim::operable& rhs) { return lhs.leap_operation < rhs.leap_operation; });
+  // Convergence is judged on the heartbeat. Each core keeps the cumulative IPC at its recent heartbeats, and the LLC MPKI is sampled on the first core's.
+  const bool check_convergence = (phase.convergence_intervals > 0) && !phase.is_functional;
+  for (O3_CPU& cpu : env.cpu_view())
+    cpu.heartbeat_history = check_convergence ? phase.convergence_intervals + 1 : 0;
 
-    // Read from trace
-    for (O3_CPU& cpu : env.cpu_view()) {
-      auto& trace = traces.at(trace_index.at(cpu.cpu));
-      for (auto pkt_count = cpu.IN_QUEUE_SIZE - static_cast<long>(std::size(cpu.input_queue)); !trace.eof() && pkt_count > 0; --pkt_count)
-        cpu.input_queue.push_back(trace());
+  std::vector<std::reference_wrapper<CACHE>> llcs;
+  auto dram_queues = env.dram_view().queues;
+  for (CACHE& cache : env.cache_view()) {
+    if (std::find(std::begin(dram_queues), std::end(dram_queues), cache.lower_level) != std::end(dram_queues))
+      llcs.push_back(cache);
+  }
 
-      // If any trace reaches EOF, terminate all phases
-      if (trace.eof())
-        std::fill(std::begin(next_phase_complete), std::end(next_phase_complete), true);
+  std::deque<double> llc_mpki;
+  auto last_llc_sample = env.cpu_view().front().get().next_print_instruction;
+  auto sample_llc = [&] {
+    auto& first_cpu = env.cpu_view().front().get();
+    if (first_cpu.next_print_instruction == last_llc_sample)
+      return;
+    last_llc_sample = first_cpu.next_print_instruction;
+
+    uint64_t misses{0}, instrs{0};
+    for (CACHE& llc : llcs) {
+      for (const auto& per_cpu : llc.sim_stats.misses)
+        misses = std::accumulate(std::begin(per_cpu), std::end(per_cpu), misses);
+    }
+    for (O3_CPU& cpu : env.cpu_view())
+      instrs += cpu.sim_instr();
+
+    llc_mpki.push_back(1000.0 * std::ceil(misses) / std::ceil(instrs));
+    while (std::size(llc_mpki) > phase.convergence_intervals + 1)
+      llc_mpki.pop_front();
+  };
+
+  auto converged = [&] {
+    auto cpus = env.cpu_view();
+    bool ipc_converged = std::all_of(std::begin(cpus), std::end(cpus), [&](const O3_CPU& cpu) {
+      return has_converged(cpu.heartbeat_ipc, phase.convergence_intervals, phase.convergence_tolerance);
+    });
+    return ipc_converged && (!phase.convergence_llc || has_converged(llc_mpki, phase.convergence_intervals, phase.convergence_tolerance));
+  };
+
+  std::string stop_reason;
+  auto check_phase_finish = [&](bool any_eof) {
+    // If any trace reaches EOF, terminate all phases
+    auto next_phase_complete = phase_complete;
+    auto any_incomplete = [](const auto& complete) { return std::find(std::begin(complete), std::end(complete), false) != std::end(complete); };
+    if (any_eof) {
+      if (any_incomplete(next_phase_complete) && std::empty(stop_reason))
+        stop_reason = "end of trace";
+      std::fill(std::begin(next_phase_complete), std::end(next_phase_complete), true);
     }
 
-    // Check for phase finish
     for (O3_CPU& cpu : env.cpu_view()) {
       // Phase complete
-      next_phase_complete[cpu.cpu] = next_phase_complete[cpu.cpu] || (cpu.sim_instr() >= length);
+      next_phase_complete[cpu.cpu] = next_phase_complete[cpu.cpu] || (cpu.sim_instr() >= phase.length);
+    }
+
+    // End the phase early once it has converged
+    if (check_convergence && any_incomplete(next_phase_complete)) {
+      if (phase.convergence_llc)
+        sample_llc();
+      if (converged()) {
+        stop_reason = fmt::format("converged within {:.3g}% over {} heartbeat intervals", 100 * phase.convergence_tolerance, phase.convergence_intervals);
+        fmt::print("{} {}\n", phase.name, stop_reason);
+        std::fill(std::begin(next_phase_complete), std::end(next_phase_complete), true);
+      }
     }
 
     for (O3_CPU& cpu : env.cpu_view()) {
@@ -96,24 +250,152 @@ phase_stats do_phase(phase_info phase, environment& env, std::vector<tracereader
         for (champsim::operable& op : operables)
           op.end_phase(cpu.cpu);
 
-        fmt::print("{} finished CPU {} instructions: {} cycles: {} cumulative IPC: {:.4g} (Simulation time: {:%H hr %M min %S sec})\n", phase_name, cpu.cpu,
-                   cpu.sim_instr(), cpu.sim_cycle(), std::ceil(cpu.sim_instr()) / std::ceil(cpu.sim_cycle()), elapsed_time());
+        print_progress("finished", cpu);
       }
     }
 
     phase_complete = next_phase_complete;
+  };
+
+  auto all_complete = [&] { return std::accumulate(std::begin(phase_complete), std::end(phase_complete), true, std::logical_and{}); };
+
+  // The determinism checker logs the state of the components at the first tick on or after each multiple of the period
+  std::ofstream state_log;
+  uint64_t next_state_hash{0};
+  if (phase.state_hash_period > 0) {
+    state_log.open(phase.state_hash_file, std::ios::app);
+    next_state_hash = (calendar.elapsed() + phase.state_hash_period - 1) / phase.state_hash_period * phase.state_hash_period;
   }
+  auto log_state = [&](uint64_t tick) {
+    if (phase.state_hash_period > 0 && tick >= next_state_hash) {
+      state_hash::write(state_log, phase.name, tick, env);
+      next_state_hash = (tick / phase.state_hash_period + 1) * phase.state_hash_period;
+    }
+  };
 
-  for (O3_CPU& cpu : env.cpu_view()) {
-    fmt::print("{} complete CPU {} instructions: {} cycles: {} cumulative IPC: {:.4g} (Simulation time: {:%H hr %M min %S sec})\n", phase_name, cpu.cpu,
-               cpu.sim_instr(), cpu.sim_cycle(), std::ceil(cpu.sim_instr()) / std::ceil(cpu.sim_cycle()), elapsed_time());
+  if (!phase.is_functional && phase.parallel_quantum > 0 && !traces_are_private(slices, phase.trace_index)) {
+    fmt::print("WARNING: {} phase runs serially because slices share a trace\n", phase.name);
+    phase.parallel_quantum = 0;
+  }
+
+  if (phase.is_functional) {
+    // Each core's instructions go straight from its trace through its predictors and caches
+    functional_warmup warmer{env};
+    auto cpus = env.cpu_view();
+
+    // The clocks keep running at one instruction per core cycle, since replacement policies may order blocks by the cycle of their last use
+    uint64_t ticks_per_instr{1};
+    for (const O3_CPU& cpu : cpus)
+      ticks_per_instr = std::max(ticks_per_instr, (cpu.CLOCK_PERIOD.ticks + cpu.CLOCK_PERIOD.cycles - 1) / cpu.CLOCK_PERIOD.cycles);
+
+    auto has_input = [](const O3_CPU& cpu) { return !std::empty(cpu.input_queue); };
+    while (!all_complete()) {
+      bool any_eof = false;
+      for (O3_CPU& cpu : cpus)
+        any_eof = read_trace(cpu, traces.at(phase.trace_index.at(cpu.cpu))) || any_eof;
+
+      while (std::any_of(std::begin(cpus), std::end(cpus), has_input)) {
+        for (O3_CPU& cpu : cpus) {
+          if (has_input(cpu)) {
+            warmer.operate(cpu, cpu.input_queue.front());
+            cpu.input_queue.pop_front();
+          }
+        }
+
+        for (uint64_t i = 0; i < ticks_per_instr; ++i) {
+          for (champsim::operable& op : calendar.next_tick())
+            ++op.current_cycle;
+        }
+        log_state(calendar.elapsed());
+      }
+
+      check_phase_finish(any_eof);
+    }
+  } else if (phase.parallel_quantum > 0) {
+    // Each private slice runs on its own thread for a quantum, and the shared slice runs on this one. The barrier's completion exchanges the traffic
+    // that crossed between slices, then checks for the end of the phase while every thread is waiting.
+    slice_boundary boundary{env, slices};
+    for (auto& slice_calendar : slice_calendars)
+      slice_calendar.seek(calendar.elapsed());
+
+    std::vector<long> slice_progress(std::size(slices), 0);
+    std::vector<char> slice_eof(std::size(slices), false);
+    bool done = all_complete();
+    quantum_barrier barrier{std::size(slices), [&] {
+                              check_deadlock(boundary.exchange() + std::accumulate(std::begin(slice_progress), std::end(slice_progress), long{0}),
+                                             phase.parallel_quantum);
+                              check_phase_finish(std::find(std::begin(slice_eof), std::end(slice_eof), true) != std::end(slice_eof));
+                              log_state(slice_calendars.back().elapsed());
+                              done = all_complete();
+                            }};
+
+    auto run_slice = [&](std::size_t idx) {
+      while (!done) {
+        slice_progress[idx] = 0;
+        for (uint64_t i = 0; i < phase.parallel_quantum; ++i) {
+          slice_progress[idx] += operate_tick(slice_calendars[idx]);
+          for (O3_CPU& cpu : slices[idx].cpus)
+            slice_eof[idx] = read_trace(cpu, traces.at(phase.trace_index.at(cpu.cpu))) || slice_eof[idx];
+        }
+        barrier.arrive_and_wait();
+      }
+    };
+
+    std::vector<std::thread> workers;
+    for (std::size_t idx = 0; idx + 1 < std::size(slices); ++idx)
+      workers.emplace_back(run_slice, idx);
+    run_slice(std::size(slices) - 1);
+    std::for_each(std::begin(workers), std::end(workers), [](std::thread& t) { t.join(); });
+
+    calendar.seek(slice_calendars.back().elapsed());
+  } else {
+    // Perform phase
+    while (!all_complete()) {
+      check_deadlock(operate_tick(calendar), 1);
+      log_state(calendar.elapsed());
+
+      // Read from trace
+      bool any_eof = false;
+      for (O3_CPU& cpu : env.cpu_view())
+        any_eof = read_trace(cpu, traces.at(phase.trace_index.at(cpu.cpu))) || any_eof;
+
+      // Check for phase finish
+      check_phase_finish(any_eof);
+    }
+  }
+
+  for (O3_CPU& cpu : env.cpu_view())
+    print_progress("complete", cpu);
+
+  if (!std::empty(phase.checkpoint_file)) {
+    std::ofstream checkpoint{phase.checkpoint_file, std::ios::binary};
+    checkpoint::save_environment(checkpoint, env, calendar, traces, phase.trace_index);
+    fmt::print("{} checkpoint saved to {}\n", phase.name, phase.checkpoint_file);
   }
 
   phase_stats stats;
   stats.name = phase.name;
+  stats.weight = phase.weight;
+  stats.stop_reason = stop_reason;
+
+  if constexpr (self_profile) {
+    // Ticks are converted to seconds by the rate at which they passed during the phase
+    auto host_ticks = profiler::now() - profile_begin_ticks;
+    auto host_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - profile_begin_time).count();
+    auto to_seconds = [&](uint64_t ticks) { return host_ticks > 0 ? host_seconds * static_cast<double>(ticks) / static_cast<double>(host_ticks) : 0.0; };
+
+    stats.profile.push_back(profile_stats{"Total", 1, host_ticks, host_seconds});
+    auto profile_end = profile_regions(env, traces, unique_traces);
+    for (std::size_t i = 0; i < std::size(profile_end); ++i) {
+      const auto& [name, end] = profile_end.at(i);
+      const auto& begin = profile_begin.at(i).second;
+      if (end.calls > begin.calls)
+        stats.profile.push_back(profile_stats{name, end.calls - begin.calls, end.ticks - begin.ticks, to_seconds(end.ticks - begin.ticks)});
+    }
+  }
 
-  for (std::size_t i = 0; i < std::size(trace_index); ++i)
-    stats.trace_names.push_back(trace_names.at(trace_index.at(i)));
+  for (std::size_t i = 0; i < std::size(phase.trace_index); ++i)
+    stats.trace_names.push_back(phase.trace_names.at(phase.trace_index.at(i)));
 
   auto cpus = env.cpu_view();
   std::transform(std::begin(cpus), std::end(cpus), std::back_inserter(stats.sim_cpu_stats), [](const O3_CPU& cpu) { return cpu.sim_stats; });
@@ -132,19 +414,227 @@ phase_stats do_phase(phase_info phase, environment& env, std::vector<tracereader
   return stats;
 }
 
-// simulation entry point
-std::vector<phase_stats> main(environment& env, std::vector<phase_info>& phases, std::vector<tracereader>& traces)
+namespace
 {
-  for (champsim::operable& op : env.operable_view())
-    op.initialize();
+// A plain phase that simulates part of a sampled or forked phase
+phase_info part_of(const phase_info& phase, std::string name, bool is_warmup, bool is_functional, uint64_t length)
+{
+  auto result = phase;
+  result.name = name;
+  result.is_warmup = is_warmup;
+  result.is_functional = is_functional;
+  result.length = length;
+  result.checkpoint_file.clear();
+  result.sample_period = 0;
+  result.convergence_intervals = 0;
+  result.fork_interval = 0;
+  return result;
+}
+
+// Add the stats of a part of a phase to the stats of the whole
+void combine_stats(phase_stats& into, const phase_stats& from)
+{
+  auto combine = [](auto& lhs, const auto& rhs) { std::transform(std::begin(lhs), std::end(lhs), std::begin(rhs), std::begin(lhs), std::plus<>{}); };
+  combine(into.roi_cpu_stats, from.roi_cpu_stats);
+  combine(into.sim_cpu_stats, from.sim_cpu_stats);
+  combine(into.roi_cache_stats, from.roi_cache_stats);
+  combine(into.sim_cache_stats, from.sim_cache_stats);
+  combine(into.roi_dram_stats, from.roi_dram_stats);
+  combine(into.sim_dram_stats, from.sim_dram_stats);
+
+  // Both parts profile the same regions, but a region is omitted from either if it was not called
+  for (const auto& region : from.profile) {
+    auto found = std::find_if(std::begin(into.profile), std::end(into.profile), [&region](const auto& x) { return x.name == region.name; });
+    if (found == std::end(into.profile)) {
+      into.profile.push_back(region);
+    } else {
+      found->calls += region.calls;
+      found->ticks += region.ticks;
+      found->seconds += region.seconds;
+    }
+  }
+}
+
+bool any_trace_eof(const phase_info& phase, const std::vector<tracereader>& traces)
+{
+  return std::any_of(std::begin(phase.trace_index), std::end(phase.trace_index), [&traces](auto idx) { return traces.at(idx).eof(); });
+}
+
+// Each period of a sampled phase is warmed functionally, then in detail, and then measured. The stats of the measured windows are combined.
+phase_stats do_sampled_phase(const phase_info& phase, environment& env, clock_calendar& calendar, std::vector<slice>& slices,
+                             std::vector<clock_calendar>& slice_calendars, std::vector<tracereader>& traces)
+{
+  auto any_eof = [&] { return any_trace_eof(phase, traces); };
+
+  const auto detailed_length = phase.sample_warmup + phase.sample_length;
+  const auto functional_length = phase.sample_period - std::min(phase.sample_period, detailed_length);
+
+  phase_stats result;
+  for (uint64_t covered = 0; covered < phase.length && !any_eof(); covered += std::max(phase.sample_period, detailed_length)) {
+    auto window_name = fmt::format("{} sample {}", phase.name, std::size(result.samples));
+    if (functional_length > 0)
+      do_phase(part_of(phase, window_name + " warming", true, true, functional_length), env, calendar, slices, slice_calendars, traces);
+    // The detailed warmup is timed like the measured window, and its stats are discarded
+    if (phase.sample_warmup > 0 && !any_eof())
+      do_phase(part_of(phase, window_name + " warmup", false, false, phase.sample_warmup), env, calendar, slices, slice_calendars, traces);
+    if (any_eof())
+      break;
+
+    auto window = do_phase(part_of(phase, window_name, false, false, phase.sample_length), env, calendar, slices, slice_calendars, traces);
+    if (std::empty(result.samples)) {
+      result = window;
+      result.name = phase.name;
+    } else {
+      combine_stats(result, window);
+    }
+    result.samples.push_back(measure_sample(window));
+  }
+
+  fmt::print("{} sampled {} windows\n", phase.name, std::size(result.samples));
+  return result;
+}
+
+// The parent warms each interval of a forked phase functionally, after forking a child to simulate the interval in detail from the same state. The
+// children return their stats through pipes, and the stats of the intervals are combined.
+phase_stats do_forked_phase(const phase_info& phase, environment& env, clock_calendar& calendar, std::vector<slice>& slices,
+                            std::vector<clock_calendar>& slice_calendars, std::vector<tracereader>& traces)
+{
+  struct child {
+    std::string name;
+    pid_t pid;
+    int fd;
+  };
+  std::deque<child> running;
+
+  phase_stats result;
+  uint64_t intervals{0};
+  auto collect = [&] {
+    auto oldest = running.front();
+    running.pop_front();
+
+    auto data = read_all(oldest.fd);
+    close(oldest.fd);
+    int status{0};
+    waitpid(oldest.pid, &status, 0);
+    if (std::empty(data) || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+      throw std::runtime_error(oldest.name + " did not complete");
+
+    phase_stats interval;
+    std::istringstream stream{data};
+    checkpoint::load(stream, interval);
+    fmt::print("{} simulated (Simulation time: {:%H hr %M min %S sec})\n", oldest.name, elapsed_time());
+
+    if (intervals++ == 0) {
+      result = interval;
+      result.name = phase.name;
+    } else {
+      combine_stats(result, interval);
+    }
+  };
+
+  uint64_t forked{0};
+  for (uint64_t covered = 0; covered < phase.length && !any_trace_eof(phase, traces); covered += phase.fork_interval) {
+    auto length = std::min(phase.fork_interval, phase.length - covered);
+    auto name = fmt::format("{} interval {}", phase.name, forked++);
+    while (std::size(running) >= std::max<std::size_t>(phase.fork_jobs, 1))
+      collect();
+
+    std::fflush(stdout);
+    file_offsets offsets;
+    int stats_pipe[2];
+    if (pipe(stats_pipe) != 0)
+      throw std::runtime_error("Could not create a pipe for " + name);
+
+    auto pid = fork();
+    if (pid < 0)
+      throw std::runtime_error("Could not fork a process for " + name);
+
+    if (pid == 0) {
+      // The child keeps the original file offsets, and reports only its stats
+      close(stats_pipe[0]);
+      std::freopen("/dev/null", "w", stdout);
+      bool written = false;
+      try {
+        // Only the parent logs state hashes, so that the log is not interleaved
+        auto interval = part_of(phase, name, false, false, length);
+        interval.state_hash_period = 0;
+        std::ostringstream stream;
+        checkpoint::save(stream, do_phase(interval, env, calendar, slices, slice_calendars, traces));
+        written = write_all(stats_pipe[1], stream.str());
+      } catch (...) {
+      }
+      std::_Exit(written ? 0 : 1);
+    }
+
+    close(stats_pipe[1]);
+    offsets.adopt();
+    running.push_back(child{name, pid, stats_pipe[0]});
+
+    do_phase(part_of(phase, name + " warming", true, true, length), env, calendar, slices, slice_calendars, traces);
+  }
+
+  while (!std::empty(running))
+    collect();
+
+  fmt::print("{} simulated {} intervals in child processes\n", phase.name, intervals);
+  return result;
+}
+
+std::vector<phase_stats> run_phases(environment& env, clock_calendar& calendar, std::vector<phase_info>& phases, std::vector<tracereader>& traces)
+{
+  std::vector<slice> slices;
+  std::vector<clock_calendar> slice_calendars;
+  if (std::any_of(std::begin(phases), std::end(phases), [](const phase_info& p) { return p.parallel_quantum > 0; })) {
+    slices = partition_slices(env);
+    for (auto& s : slices)
+      slice_calendars.emplace_back(s.operables);
+  }
 
   std::vector<phase_stats> results;
   for (auto phase : phases) {
-    auto stats = do_phase(phase, env, traces);
+    phase_stats stats;
+    if (phase.sample_period > 0 && !phase.is_warmup)
+      stats = do_sampled_phase(phase, env, calendar, slices, slice_calendars, traces);
+    else if (phase.fork_interval > 0 && !phase.is_warmup)
+      stats = do_forked_phase(phase, env, calendar, slices, slice_calendars, traces);
+    else
+      stats = do_phase(phase, env, calendar, slices, slice_calendars, traces);
     if (!phase.is_warmup)
       results.push_back(stats);
   }
 
   return results;
 }
+} // namespace
+
+// simulation entry point
+std::vector<phase_stats> main(environment& env, std::vector<phase_info>& phases, std::vector<tracereader>& traces)
+{
+  for (champsim::operable& op : env.operable_view())
+    op.initialize();
+
+  clock_calendar calendar{env.operable_view()};
+  return run_phases(env, calendar, phases, traces);
+}
+
+// simulation entry point, resuming from a checkpoint. The phases should not include the warmup that the checkpoint replaces.
+std::vector<phase_stats> main(environment& env, std::vector<phase_info>& phases, std::vector<tracereader>& traces, std::istream& checkpoint)
+{
+  for (champsim::operable& op : env.operable_view())
+    op.initialize();
+
+  clock_calendar calendar{env.operable_view()};
+  if (!std::empty(phases))
+    checkpoint::load_environment(checkpoint, env, calendar, traces, phases.front().trace_index);
+
+  return run_phases(env, calendar, phases, traces);
+}
+
+std::vector<phase_stats> batch::run(std::vector<phase_info>& phases, std::vector<tracereader>& traces)
+{
+  if (!std::empty(phases))
+    reset(traces, phases.front().trace_index);
+
+  return run_phases(env, calendar, phases, traces);
+}
 } // namespace champsim
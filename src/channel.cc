@@ -191,3 +191,11 @@ std::size_t champsim::channel::rq_size() const { return RQ_SIZE; }
 std::size_t champsim::channel::wq_size() const { return WQ_SIZE; }
 
 std::size_t champsim::channel::pq_size() const { return PQ_SIZE; }
+
+void champsim::channel::clear()
+{
+  RQ.clear();
+  PQ.clear();
+  WQ.clear();
+  returned.clear();
+}
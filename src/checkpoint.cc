@@ -0,0 +1,129 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "checkpoint.h"
+
+#include <algorithm>
+#include <array>
+#include <string>
+
+#include "clock_calendar.h"
+#include "environment.h"
+#include "tracereader.h"
+#include "vmem.h"
+
+namespace
+{
+constexpr std::array<char, 8> checkpoint_magic{'C', 'H', 'A', 'M', 'P', 'C', 'K', 'P'};
+constexpr uint32_t checkpoint_version = 3;
+
+// A description of the configuration, so that a checkpoint is not restored into a different system
+std::vector<std::pair<std::string, uint64_t>> fingerprint(champsim::environment& env)
+{
+  std::vector<std::pair<std::string, uint64_t>> result;
+  for (O3_CPU& cpu : env.cpu_view())
+    result.emplace_back("CPU " + std::to_string(cpu.cpu), cpu.ROB_SIZE);
+  for (CACHE& cache : env.cache_view())
+    result.emplace_back(cache.NAME, uint64_t{cache.NUM_SET} * cache.NUM_WAY);
+  for (PageTableWalker& ptw : env.ptw_view())
+    result.emplace_back(ptw.NAME, std::size(ptw.pscl));
+  result.emplace_back("DRAM", std::size(env.dram_view().channels));
+  return result;
+}
+
+// Each virtual memory is shared by the page table walkers that use it
+std::vector<VirtualMemory*> virtual_memories(champsim::environment& env)
+{
+  std::vector<VirtualMemory*> result;
+  for (PageTableWalker& ptw : env.ptw_view()) {
+    if (ptw.vmem != nullptr && std::find(std::begin(result), std::end(result), ptw.vmem) == std::end(result))
+      result.push_back(ptw.vmem);
+  }
+  return result;
+}
+
+// The number of instructions before the oldest one that the core has read but not retired. A skip over the start of the trace counts toward it.
+uint64_t trace_position(const O3_CPU& cpu, const std::vector<champsim::tracereader>& traces, const std::vector<std::size_t>& trace_index)
+{
+  if (cpu.cpu >= std::size(trace_index))
+    return 0; // The core has not been given a trace
+
+  auto in_flight =
+      std::size(cpu.input_queue) + std::size(cpu.IFETCH_BUFFER) + std::size(cpu.DECODE_BUFFER) + std::size(cpu.DISPATCH_BUFFER) + std::size(cpu.ROB);
+  return traces.at(trace_index.at(cpu.cpu)).num_read() - in_flight;
+}
+} // namespace
+
+void champsim::checkpoint::save_environment(std::ostream& stream, environment& env, const clock_calendar& calendar, const std::vector<tracereader>& traces,
+                                            const std::vector<std::size_t>& trace_index)
+{
+  save(stream, checkpoint_magic);
+  save(stream, checkpoint_version);
+  save(stream, fingerprint(env));
+  save(stream, calendar.elapsed());
+
+  for (operable& op : env.operable_view()) {
+    save(stream, op.current_cycle);
+    op.save_checkpoint(stream);
+  }
+
+  for (auto vmem : virtual_memories(env))
+    vmem->save_checkpoint(stream);
+
+  for (O3_CPU& cpu : env.cpu_view())
+    save(stream, trace_position(cpu, traces, trace_index));
+
+  if (!stream)
+    throw std::runtime_error("Checkpoint could not be written");
+}
+
+void champsim::checkpoint::load_environment(std::istream& stream, environment& env, clock_calendar& calendar, std::vector<tracereader>& traces,
+                                            const std::vector<std::size_t>& trace_index)
+{
+  std::array<char, std::size(checkpoint_magic)> magic{};
+  uint32_t version = 0;
+  load(stream, magic);
+  load(stream, version);
+  if (magic != checkpoint_magic || version != checkpoint_version)
+    throw std::runtime_error("Not a checkpoint, or a checkpoint from an incompatible version");
+
+  decltype(fingerprint(env)) saved_fingerprint;
+  load(stream, saved_fingerprint);
+  if (saved_fingerprint != fingerprint(env))
+    throw std::runtime_error("Checkpoint does not match the configuration");
+
+  uint64_t elapsed = 0;
+  load(stream, elapsed);
+  calendar.seek(elapsed);
+
+  for (operable& op : env.operable_view()) {
+    load(stream, op.current_cycle);
+    op.load_checkpoint(stream);
+  }
+
+  for (auto vmem : virtual_memories(env))
+    vmem->load_checkpoint(stream);
+
+  // Resume each trace after the last instruction that its core retired
+  for (O3_CPU& cpu : env.cpu_view()) {
+    uint64_t position = 0;
+    load(stream, position);
+
+    auto& trace = traces.at(trace_index.at(cpu.cpu));
+    if (trace.num_read() < position)
+      trace.skip(position - trace.num_read());
+  }
+}
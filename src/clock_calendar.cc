@@ -0,0 +1,84 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "clock_calendar.h"
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <utility>
+
+champsim::clock_calendar::clock_calendar(value_type operables)
+{
+  auto hyperperiod = std::accumulate(std::cbegin(operables), std::cend(operables), uint64_t{1},
+                                     [](uint64_t acc, const operable& op) { return std::lcm(acc, op.CLOCK_PERIOD.ticks); });
+
+  // An operable with period T/C operates on C of every T ticks. The leap counts how far its clock edge lags the tick, in units of 1/C cycles.
+  std::vector<uint64_t> leap(std::size(operables), 0);
+  auto lags_less = [&](std::size_t lhs, std::size_t rhs) {
+    return leap[lhs] * operables[rhs].get().CLOCK_PERIOD.cycles < leap[rhs] * operables[lhs].get().CLOCK_PERIOD.cycles;
+  };
+
+  // Operables whose clock edge comes first in the tick operate first. Ties keep their order from the previous tick, so the order at the start of each
+  // hyperperiod may change. Keep building hyperperiods until that order repeats.
+  std::vector<std::size_t> order(std::size(operables));
+  std::iota(std::begin(order), std::end(order), std::size_t{0});
+  std::vector<std::vector<std::size_t>> starting_orders;
+  do {
+    starting_orders.push_back(order);
+
+    for (uint64_t i = 0; i < hyperperiod; ++i) {
+      auto& tick = schedule.emplace_back();
+      for (auto idx : order) {
+        const auto& period = operables[idx].get().CLOCK_PERIOD;
+        if (leap[idx] >= period.cycles) {
+          leap[idx] -= period.cycles;
+        } else {
+          tick.push_back(operables[idx]);
+          leap[idx] += period.ticks - period.cycles;
+        }
+      }
+
+      std::stable_sort(std::begin(order), std::end(order), lags_less);
+    }
+  } while (std::find(std::begin(starting_orders), std::end(starting_orders), order) == std::end(starting_orders));
+
+  repeat_from = static_cast<std::size_t>(std::distance(std::begin(starting_orders), std::find(std::begin(starting_orders), std::end(starting_orders), order)))
+                * hyperperiod;
+  period_length = hyperperiod;
+}
+
+std::size_t champsim::clock_calendar::hyperperiod() const { return period_length; }
+
+auto champsim::clock_calendar::next_tick() -> const value_type&
+{
+  const auto& tick = schedule[position];
+  if (++position == std::size(schedule))
+    position = repeat_from;
+  ++ticks_elapsed;
+  return tick;
+}
+
+uint64_t champsim::clock_calendar::elapsed() const { return ticks_elapsed; }
+
+void champsim::clock_calendar::seek(uint64_t tick)
+{
+  ticks_elapsed = tick;
+  if (tick < std::size(schedule))
+    position = static_cast<std::size_t>(tick);
+  else
+    position = repeat_from + static_cast<std::size_t>((tick - repeat_from) % (std::size(schedule) - repeat_from));
+}
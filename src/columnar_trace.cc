@@ -0,0 +1,209 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "columnar_trace.h"
+
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+
+namespace
+{
+// Differences are stored so that small negative ones are as short as small positive ones
+uint64_t zigzag(uint64_t delta) { return (delta << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(delta) >> 63); }
+uint64_t unzigzag(uint64_t value) { return (value >> 1) ^ (~(value & 1) + 1); }
+
+uint64_t get_varint(const char*& it, const char* end)
+{
+  uint64_t value = 0;
+  for (unsigned shift = 0; shift < 64 && it != end; shift += 7) {
+    auto byte = static_cast<unsigned char>(*it++);
+    value |= uint64_t{byte & 0x7fu} << shift;
+    if ((byte & 0x80) == 0)
+      return value;
+  }
+  throw std::runtime_error{"Malformed columnar trace"};
+}
+
+template <typename T>
+void decode(const char* body, std::size_t size, uint64_t count, std::vector<T>& dest)
+{
+  constexpr bool has_asid = std::is_same_v<T, cloudsuite_instr>;
+  const char* end = body + size;
+
+  auto ip_size = get_varint(body, end);
+  auto register_size = get_varint(body, end);
+  auto memory_size = get_varint(body, end);
+
+  // Each instruction takes at least three bytes, so a count that is larger than the body is malformed, and cannot overflow below
+  auto remaining = static_cast<uint64_t>(end - body);
+  if (count > remaining || ip_size > remaining || register_size > remaining || memory_size > remaining
+      || ip_size + 2 * count + register_size + memory_size + (has_asid ? 2 * count : 0) != remaining)
+    throw std::runtime_error{"Malformed columnar trace"};
+
+  const char* ip_it = body;
+  const char* shape_it = std::next(ip_it, static_cast<std::ptrdiff_t>(ip_size));
+  const char* register_it = std::next(shape_it, static_cast<std::ptrdiff_t>(2 * count));
+  const char* memory_it = std::next(register_it, static_cast<std::ptrdiff_t>(register_size));
+  const char* asid_it = std::next(memory_it, static_cast<std::ptrdiff_t>(memory_size));
+  const char* const ip_end = shape_it;
+  const char* const register_end = memory_it;
+  const char* const memory_end = asid_it;
+
+  auto take_registers = [&](auto& slots, unsigned num) {
+    if (num > std::size(slots) || static_cast<unsigned>(register_end - register_it) < num)
+      throw std::runtime_error{"Malformed columnar trace"};
+    std::copy_n(register_it, num, std::begin(slots));
+    register_it += num;
+  };
+
+  uint64_t address = 0;
+  auto take_addresses = [&](auto& slots, unsigned num) {
+    if (num > std::size(slots))
+      throw std::runtime_error{"Malformed columnar trace"};
+    std::for_each_n(std::begin(slots), num, [&](auto& slot) {
+      address += unzigzag(get_varint(memory_it, memory_end));
+      slot = address;
+    });
+  };
+
+  dest.reserve(std::size(dest) + count);
+  uint64_t ip = 0;
+  for (uint64_t i = 0; i < count; ++i) {
+    T instr{};
+
+    ip += unzigzag(get_varint(ip_it, ip_end));
+    instr.ip = ip;
+
+    auto flags = static_cast<unsigned char>(*shape_it++);
+    auto operands = static_cast<unsigned char>(*shape_it++);
+    instr.is_branch = flags & 1;
+    instr.branch_taken = (flags >> 1) & 1;
+    take_registers(instr.destination_registers, (flags >> 2) & 7u);
+    take_registers(instr.source_registers, (flags >> 5) & 7u);
+    take_addresses(instr.destination_memory, operands & 7u);
+    take_addresses(instr.source_memory, (operands >> 3) & 7u);
+
+    if constexpr (has_asid) {
+      instr.asid[0] = static_cast<unsigned char>(*asid_it++);
+      instr.asid[1] = static_cast<unsigned char>(*asid_it++);
+    }
+
+    dest.push_back(instr);
+  }
+
+  if (ip_it != ip_end || register_it != register_end || memory_it != memory_end)
+    throw std::runtime_error{"Malformed columnar trace"};
+}
+} // namespace
+
+void champsim::columnar::decode_block(const char* body, std::size_t size, uint64_t count, std::vector<input_instr>& dest)
+{
+  decode(body, size, count, dest);
+}
+
+void champsim::columnar::decode_block(const char* body, std::size_t size, uint64_t count, std::vector<cloudsuite_instr>& dest)
+{
+  decode(body, size, count, dest);
+}
+
+champsim::columnar::writer::writer(std::ostream& d, record_kind k, std::size_t block_instr)
+    : dest(d), kind_(k), block_instructions(std::max<std::size_t>(block_instr, 1))
+{
+  dest.write(std::data(magic), std::size(magic));
+  dest.put(static_cast<char>(version));
+  dest.put(static_cast<char>(kind_));
+}
+
+template <typename T>
+void champsim::columnar::writer::append(const T& instr)
+{
+  detail::put_varint(ip_column, zigzag(instr.ip - last_ip));
+  last_ip = instr.ip;
+
+  auto append_registers = [this](const auto& slots) {
+    auto before = std::size(register_column);
+    std::copy_if(std::begin(slots), std::end(slots), std::back_inserter(register_column), [](auto reg) { return reg != 0; });
+    return static_cast<unsigned>(std::size(register_column) - before);
+  };
+
+  auto append_addresses = [this](const auto& slots) {
+    unsigned num = 0;
+    for (auto address : slots) {
+      if (address != 0) {
+        detail::put_varint(memory_column, zigzag(address - last_address));
+        last_address = address;
+        ++num;
+      }
+    }
+    return num;
+  };
+
+  auto num_dreg = append_registers(instr.destination_registers);
+  auto num_sreg = append_registers(instr.source_registers);
+  auto num_dmem = append_addresses(instr.destination_memory);
+  auto num_smem = append_addresses(instr.source_memory);
+  shape_column.push_back(static_cast<char>((instr.is_branch ? 1u : 0u) | (instr.branch_taken ? 2u : 0u) | (num_dreg << 2) | (num_sreg << 5)));
+  shape_column.push_back(static_cast<char>(num_dmem | (num_smem << 3)));
+
+  if constexpr (std::is_same_v<T, cloudsuite_instr>) {
+    asid_column.push_back(static_cast<char>(instr.asid[0]));
+    asid_column.push_back(static_cast<char>(instr.asid[1]));
+  }
+
+  if (++count >= block_instructions)
+    flush();
+}
+
+void champsim::columnar::writer::write(const input_instr& instr)
+{
+  if (kind_ != record_kind::standard)
+    throw std::invalid_argument{"A standard record cannot be written to a cloudsuite trace"};
+  append(instr);
+}
+
+void champsim::columnar::writer::write(const cloudsuite_instr& instr)
+{
+  if (kind_ != record_kind::cloudsuite)
+    throw std::invalid_argument{"A cloudsuite record cannot be written to a standard trace"};
+  append(instr);
+}
+
+void champsim::columnar::writer::flush()
+{
+  if (count == 0)
+    return;
+
+  std::vector<char> sizes;
+  detail::put_varint(sizes, std::size(ip_column));
+  detail::put_varint(sizes, std::size(register_column));
+  detail::put_varint(sizes, std::size(memory_column));
+
+  std::vector<char> block_header;
+  detail::put_varint(block_header, count);
+  detail::put_varint(block_header, std::size(sizes) + std::size(ip_column) + std::size(shape_column) + std::size(register_column) + std::size(memory_column)
+                                       + std::size(asid_column));
+
+  for (auto column : {&block_header, &sizes, &ip_column, &shape_column, &register_column, &memory_column, &asid_column}) {
+    dest.write(std::data(*column), static_cast<std::streamsize>(std::size(*column)));
+    column->clear();
+  }
+
+  count = 0;
+  last_ip = 0;
+  last_address = 0;
+}
@@ -0,0 +1,205 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "decoded_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+#include <fmt/core.h>
+#include <unistd.h>
+#include <zlib.h>
+
+namespace
+{
+template <typename T>
+void store(char* dest, T value)
+{
+  std::memcpy(dest, &value, sizeof(T));
+}
+
+template <typename T>
+T load(const char* src)
+{
+  T value;
+  std::memcpy(&value, src, sizeof(T));
+  return value;
+}
+} // namespace
+
+auto champsim::decoded_cache::encode_header(const header& info) -> std::array<char, header_size>
+{
+  std::array<char, header_size> result{};
+  std::copy(std::begin(magic), std::end(magic), std::begin(result));
+  result[4] = static_cast<char>(version);
+  result[5] = static_cast<char>((info.cloudsuite ? 1 : 0) | (info.complete ? 2 : 0));
+  store(&result[8], info.source_crc);
+  store(&result[16], info.source_size);
+  store(&result[24], info.count);
+  return result;
+}
+
+auto champsim::decoded_cache::decode_header(const char* data, std::size_t size) -> std::optional<header>
+{
+  if (data == nullptr || size < header_size || !std::equal(std::begin(magic), std::end(magic), data) || static_cast<uint8_t>(data[4]) != version)
+    return std::nullopt;
+
+  header result;
+  result.cloudsuite = (data[5] & 1) != 0;
+  result.complete = (data[5] & 2) != 0;
+  result.source_crc = load<uint32_t>(data + 8);
+  result.source_size = load<uint64_t>(data + 16);
+  result.count = load<uint64_t>(data + 24);
+  return result;
+}
+
+auto champsim::decoded_cache::find(const std::string& directory, const std::string& trace_name, bool cloudsuite) -> std::optional<entry>
+{
+  std::ifstream trace{trace_name, std::ios::binary};
+  if (!trace.is_open())
+    return std::nullopt;
+
+  entry result;
+  result.expected.cloudsuite = cloudsuite;
+
+  uLong crc = ::crc32(0, nullptr, 0);
+  std::vector<char> buffer(std::size_t{1} << 20);
+  while (trace.read(std::data(buffer), static_cast<std::streamsize>(std::size(buffer))) || trace.gcount() > 0) {
+    auto bytes_read = static_cast<std::size_t>(trace.gcount());
+    crc = ::crc32_z(crc, reinterpret_cast<const Bytef*>(std::data(buffer)), bytes_read);
+    result.expected.source_size += bytes_read;
+  }
+  result.expected.source_crc = static_cast<uint32_t>(crc);
+
+  result.name = fmt::format("{}/{:08x}-{:x}{}.decoded", directory, result.expected.source_crc, result.expected.source_size, cloudsuite ? "-cloudsuite" : "");
+  result.exists = published(result);
+
+  return result;
+}
+
+bool champsim::decoded_cache::published(const entry& e)
+{
+  std::ifstream cache{e.name, std::ios::binary};
+  std::array<char, header_size> found_header;
+  cache.read(std::data(found_header), std::size(found_header));
+  auto found = decode_header(std::data(found_header), static_cast<std::size_t>(cache.gcount()));
+  return found.has_value() && found->cloudsuite == e.expected.cloudsuite && found->source_crc == e.expected.source_crc
+         && found->source_size == e.expected.source_size && found->count > 0;
+}
+
+void champsim::decoded_cache::append_record(std::vector<char>& dest, const ooo_model_instr& instr)
+{
+  auto offset = std::size(dest);
+  dest.resize(offset + fixed_record_size);
+  auto record = std::data(dest) + offset;
+  store(record, instr.ip);
+  store(record + 8, instr.branch_target);
+  record[16] = static_cast<char>((instr.is_branch ? 1 : 0) | (instr.branch_taken ? 2 : 0));
+  record[17] = static_cast<char>(instr.branch_type);
+  record[18] = static_cast<char>(instr.asid[0]);
+  record[19] = static_cast<char>(instr.asid[1]);
+  record[20] = static_cast<char>(std::size(instr.destination_registers) | (std::size(instr.source_registers) << 4));
+  record[21] = static_cast<char>(std::size(instr.destination_memory) | (std::size(instr.source_memory) << 4));
+
+  dest.insert(std::end(dest), std::begin(instr.destination_registers), std::end(instr.destination_registers));
+  dest.insert(std::end(dest), std::begin(instr.source_registers), std::end(instr.source_registers));
+  for (auto address : instr.destination_memory)
+    store(&*dest.insert(std::end(dest), sizeof(address), '\0'), address);
+  for (auto address : instr.source_memory)
+    store(&*dest.insert(std::end(dest), sizeof(address), '\0'), address);
+}
+
+ooo_model_instr champsim::decoded_cache::read_record(const char* record, uint8_t cpu, bool cloudsuite)
+{
+  // The instruction is built from an empty record, then given the fields that were decoded when the cache was recorded
+  ooo_model_instr retval{cpu, input_instr{}};
+  retval.ip = load<uint64_t>(record);
+  retval.branch_target = load<uint64_t>(record + 8);
+  retval.is_branch = (record[16] & 1) != 0;
+  retval.branch_taken = (record[16] & 2) != 0;
+  retval.branch_type = static_cast<uint8_t>(record[17]);
+  if (cloudsuite)
+    retval.asid = {static_cast<uint8_t>(record[18]), static_cast<uint8_t>(record[19])};
+
+  auto registers = static_cast<unsigned char>(record[20]);
+  auto memory = static_cast<unsigned char>(record[21]);
+  auto it = record + fixed_record_size;
+  retval.destination_registers.assign(it, it + (registers & 0xfu));
+  it += registers & 0xfu;
+  retval.source_registers.assign(it, it + (registers >> 4));
+  it += registers >> 4;
+
+  auto read_addresses = [&it](std::vector<uint64_t>& dest, unsigned num) {
+    dest.resize(num);
+    for (auto& address : dest) {
+      address = load<uint64_t>(it);
+      it += sizeof(uint64_t);
+    }
+  };
+  read_addresses(retval.destination_memory, memory & 0xfu);
+  read_addresses(retval.source_memory, memory >> 4);
+
+  return retval;
+}
+
+champsim::decoded_cache::recording::recording(entry e) : target(std::move(e))
+{
+  // Each recording has its own temporary file, so that runs that share a cache directory do not interfere
+  temp_name = fmt::format("{}.{}.{}.tmp", target.name, ::getpid(), static_cast<const void*>(this));
+  std::error_code ec;
+  std::filesystem::create_directories(std::filesystem::path{target.name}.parent_path(), ec);
+  file.open(temp_name, std::ios::binary);
+
+  auto placeholder = encode_header(target.expected);
+  file.write(std::data(placeholder), std::size(placeholder));
+}
+
+void champsim::decoded_cache::recording::append(const ooo_model_instr& instr)
+{
+  if (stopped || complete)
+    return;
+
+  append_record(buffer, instr);
+  ++count;
+  if (std::size(buffer) >= (std::size_t{1} << 20))
+    write_buffer();
+}
+
+void champsim::decoded_cache::recording::write_buffer()
+{
+  file.write(std::data(buffer), static_cast<std::streamsize>(std::size(buffer)));
+  buffer.clear();
+}
+
+champsim::decoded_cache::recording::~recording()
+{
+  write_buffer();
+
+  auto info = target.expected;
+  info.count = count;
+  info.complete = complete;
+  auto final_header = encode_header(info);
+  file.seekp(0);
+  file.write(std::data(final_header), std::size(final_header));
+  file.close();
+
+  // Another run may have published the cache first. Either cache is correct.
+  if (file.fail() || count == 0 || std::rename(temp_name.c_str(), target.name.c_str()) != 0)
+    std::remove(temp_name.c_str());
+}
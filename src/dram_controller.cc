@@ -19,8 +19,10 @@
 #include <algorithm>
 #include <cfenv>
 #include <cmath>
+#include <numeric>
 
 #include "champsim_constants.h"
+#include "checkpoint.h"
 #include "deadlock.h"
 #include "instruction.h"
 #include "util/span.h"
@@ -33,7 +35,7 @@ uint64_t cycles(double time, int io_freq)
   return result < 0 ? 0 : static_cast<uint64_t>(result);
 }
 
-MEMORY_CONTROLLER::MEMORY_CONTROLLER(double freq_scale, int io_freq, double t_rp, double t_rcd, double t_cas, double turnaround,
+MEMORY_CONTROLLER::MEMORY_CONTROLLER(champsim::clock_period freq_scale, int io_freq, double t_rp, double t_rcd, double t_cas, double turnaround,
                                      std::vector<channel_type*>&& ul)
     : champsim::operable(freq_scale), queues(std::move(ul)), tRP(cycles(t_rp / 1000, io_freq)), tRCD(cycles(t_rcd / 1000, io_freq)),
       tCAS(cycles(t_cas / 1000, io_freq)), DRAM_DBUS_TURN_AROUND_TIME(cycles(turnaround / 1000, io_freq)),
@@ -66,6 +68,11 @@ long MEMORY_CONTROLLER::operate()
         }
         entry.reset();
       }
+
+      // Requests that a timed phase left scheduled in the banks were dropped with their packets
+      for (auto& bank : channel.bank_request)
+        bank.valid = false;
+      channel.active_request = std::end(channel.bank_request);
     }
 
     // Check for forwarding
@@ -183,6 +190,81 @@ long MEMORY_CONTROLLER::operate()
   return progress;
 }
 
+uint64_t MEMORY_CONTROLLER::next_event_cycle() const
+{
+  auto has_requests = [](const auto ul) { return !std::empty(ul->RQ) || !std::empty(ul->PQ) || !std::empty(ul->WQ); };
+  if (std::any_of(std::begin(queues), std::end(queues), has_requests))
+    return current_cycle;
+
+  uint64_t next_event = std::numeric_limits<uint64_t>::max();
+  auto consider = [&next_event](uint64_t cycle) { next_event = std::min(next_event, cycle); };
+
+  for (auto& channel : channels) {
+    auto occupied = [](const auto& x) { return x.has_value(); };
+    auto unchecked = [](const auto& x) { return x.has_value() && !x.value().forward_checked; };
+    auto wq_occu = static_cast<std::size_t>(std::count_if(std::begin(channel.WQ), std::end(channel.WQ), occupied));
+    auto rq_occu = static_cast<std::size_t>(std::count_if(std::begin(channel.RQ), std::end(channel.RQ), occupied));
+
+    if (warmup && (wq_occu > 0 || rq_occu > 0))
+      return current_cycle;
+
+    if (std::any_of(std::begin(channel.WQ), std::end(channel.WQ), unchecked) || std::any_of(std::begin(channel.RQ), std::end(channel.RQ), unchecked))
+      return current_cycle;
+
+    if ((!channel.write_mode && (wq_occu >= DRAM_WRITE_HIGH_WM || (rq_occu == 0 && wq_occu > 0)))
+        || (channel.write_mode && (wq_occu == 0 || (rq_occu > 0 && wq_occu < DRAM_WRITE_LOW_WM))))
+      return current_cycle;
+
+    // Requests leave the data bus when they finish, and the next one is put on the bus when it becomes available
+    if (channel.active_request != std::end(channel.bank_request)) {
+      consider(channel.active_request->event_cycle);
+    } else {
+      auto iter_next_process = std::min_element(std::begin(channel.bank_request), std::end(channel.bank_request),
+                                                [](const auto& lhs, const auto& rhs) { return !rhs.valid || (lhs.valid && lhs.event_cycle < rhs.event_cycle); });
+      if (iter_next_process->valid)
+        consider(std::max(iter_next_process->event_cycle, channel.dbus_cycle_available));
+    }
+
+    // Queued packets are scheduled when their bank is free
+    auto next_schedule = [](const auto& lhs, const auto& rhs) {
+      return !(rhs.has_value() && !rhs.value().scheduled) || ((lhs.has_value() && !lhs.value().scheduled) && lhs.value().event_cycle < rhs.value().event_cycle);
+    };
+    const auto& queue = channel.write_mode ? channel.WQ : channel.RQ;
+    auto iter_next_schedule = std::min_element(std::begin(queue), std::end(queue), next_schedule);
+    if (iter_next_schedule->has_value() && !iter_next_schedule->value().scheduled) {
+      auto op_idx = dram_get_rank(iter_next_schedule->value().address) * DRAM_BANKS + dram_get_bank(iter_next_schedule->value().address);
+      if (!channel.bank_request[op_idx].valid)
+        consider(iter_next_schedule->value().event_cycle);
+    }
+  }
+
+  return std::max(next_event, current_cycle);
+}
+
+std::size_t MEMORY_CONTROLLER::input_occupancy() const
+{
+  return std::accumulate(std::begin(queues), std::end(queues), std::size_t{0},
+                         [](std::size_t acc, const auto* ul) { return acc + ul->rq_occupancy() + ul->wq_occupancy() + ul->pq_occupancy(); });
+}
+
+long MEMORY_CONTROLLER::skip_operate()
+{
+  // Requests waiting for the data bus accumulate congestion on every cycle
+  for (auto& channel : channels) {
+    auto iter_next_process = std::min_element(std::begin(channel.bank_request), std::end(channel.bank_request),
+                                              [](const auto& lhs, const auto& rhs) { return !rhs.valid || (lhs.valid && lhs.event_cycle < rhs.event_cycle); });
+    if (iter_next_process->valid && iter_next_process->event_cycle <= current_cycle) {
+      if (channel.active_request != std::end(channel.bank_request))
+        channel.sim_stats.dbus_cycle_congested += (channel.active_request->event_cycle - current_cycle);
+      else
+        channel.sim_stats.dbus_cycle_congested += (channel.dbus_cycle_available - current_cycle);
+      ++channel.sim_stats.dbus_count_congested;
+    }
+  }
+
+  return 0;
+}
+
 void MEMORY_CONTROLLER::initialize()
 {
   long long int dram_size = DRAM_CHANNELS * DRAM_RANKS * DRAM_BANKS * DRAM_ROWS * DRAM_COLUMNS * BLOCK_SIZE / 1024 / 1024; // in MiB
@@ -210,6 +292,59 @@ void MEMORY_CONTROLLER::begin_phase()
   }
 }
 
+void MEMORY_CONTROLLER::save_checkpoint(std::ostream& stream)
+{
+  // Only the open rows are saved, since requests in flight are not
+  for (const auto& chan : channels) {
+    champsim::checkpoint::save(stream, std::tie(chan.write_mode, chan.dbus_cycle_available));
+    for (const auto& bank : chan.bank_request)
+      champsim::checkpoint::save(stream, bank.open_row);
+  }
+}
+
+void MEMORY_CONTROLLER::load_checkpoint(std::istream& stream)
+{
+  for (auto& chan : channels) {
+    auto fields = std::tie(chan.write_mode, chan.dbus_cycle_available);
+    champsim::checkpoint::load(stream, fields);
+    for (auto& bank : chan.bank_request) {
+      bank = {};
+      champsim::checkpoint::load(stream, bank.open_row);
+    }
+    chan.active_request = std::end(chan.bank_request);
+  }
+}
+
+std::vector<std::pair<std::string, champsim::profiler::region>> MEMORY_CONTROLLER::profile() const { return {{"DRAM", operate_profile}}; }
+
+void MEMORY_CONTROLLER::clear_inflight()
+{
+  for (auto& chan : channels) {
+    std::fill(std::begin(chan.RQ), std::end(chan.RQ), std::nullopt);
+    std::fill(std::begin(chan.WQ), std::end(chan.WQ), std::nullopt);
+    for (auto& bank : chan.bank_request)
+      bank.valid = false;
+    chan.active_request = std::end(chan.bank_request);
+  }
+  for (auto ul : queues)
+    ul->clear();
+}
+
+void MEMORY_CONTROLLER::save_inflight(std::ostream& stream)
+{
+  for (const auto& chan : channels) {
+    for (const auto* queue : {&chan.RQ, &chan.WQ}) {
+      for (const auto& entry : *queue) {
+        if (entry.has_value())
+          champsim::checkpoint::save(stream, std::tie(entry->address, entry->scheduled, entry->event_cycle));
+      }
+    }
+    for (const auto& bank : chan.bank_request)
+      champsim::checkpoint::save(stream, std::tie(bank.valid, bank.row_buffer_hit, bank.event_cycle));
+    champsim::checkpoint::save(stream, chan.active_request - std::begin(chan.bank_request));
+  }
+}
+
 void MEMORY_CONTROLLER::end_phase(unsigned)
 {
   for (auto& chan : channels) {
@@ -217,6 +352,18 @@ void MEMORY_CONTROLLER::end_phase(unsigned)
   }
 }
 
+dram_stats operator+(dram_stats lhs, const dram_stats& rhs)
+{
+  lhs.dbus_cycle_congested += rhs.dbus_cycle_congested;
+  lhs.dbus_count_congested += rhs.dbus_count_congested;
+  lhs.WQ_ROW_BUFFER_HIT += rhs.WQ_ROW_BUFFER_HIT;
+  lhs.WQ_ROW_BUFFER_MISS += rhs.WQ_ROW_BUFFER_MISS;
+  lhs.RQ_ROW_BUFFER_HIT += rhs.RQ_ROW_BUFFER_HIT;
+  lhs.RQ_ROW_BUFFER_MISS += rhs.RQ_ROW_BUFFER_MISS;
+  lhs.WQ_FULL += rhs.WQ_FULL;
+  return lhs;
+}
+
 void DRAM_CHANNEL::check_collision()
 {
   for (auto wq_it = std::begin(WQ); wq_it != std::end(WQ); ++wq_it) {
@@ -338,31 +485,31 @@ bool MEMORY_CONTROLLER::add_wq(const request_type& packet)
  * offset |
  */
 
-uint32_t MEMORY_CONTROLLER::dram_get_channel(uint64_t address)
+uint32_t MEMORY_CONTROLLER::dram_get_channel(uint64_t address) const
 {
   int shift = LOG2_BLOCK_SIZE;
   return (address >> shift) & champsim::bitmask(champsim::lg2(DRAM_CHANNELS));
 }
 
-uint32_t MEMORY_CONTROLLER::dram_get_bank(uint64_t address)
+uint32_t MEMORY_CONTROLLER::dram_get_bank(uint64_t address) const
 {
   int shift = champsim::lg2(DRAM_CHANNELS) + LOG2_BLOCK_SIZE;
   return (address >> shift) & champsim::bitmask(champsim::lg2(DRAM_BANKS));
 }
 
-uint32_t MEMORY_CONTROLLER::dram_get_column(uint64_t address)
+uint32_t MEMORY_CONTROLLER::dram_get_column(uint64_t address) const
 {
   int shift = champsim::lg2(DRAM_BANKS) + champsim::lg2(DRAM_CHANNELS) + LOG2_BLOCK_SIZE;
   return (address >> shift) & champsim::bitmask(champsim::lg2(DRAM_COLUMNS));
 }
 
-uint32_t MEMORY_CONTROLLER::dram_get_rank(uint64_t address)
+uint32_t MEMORY_CONTROLLER::dram_get_rank(uint64_t address) const
 {
   int shift = champsim::lg2(DRAM_BANKS) + champsim::lg2(DRAM_COLUMNS) + champsim::lg2(DRAM_CHANNELS) + LOG2_BLOCK_SIZE;
   return (address >> shift) & champsim::bitmask(champsim::lg2(DRAM_RANKS));
 }
 
-uint32_t MEMORY_CONTROLLER::dram_get_row(uint64_t address)
+uint32_t MEMORY_CONTROLLER::dram_get_row(uint64_t address) const
 {
   int shift = champsim::lg2(DRAM_RANKS) + champsim::lg2(DRAM_BANKS) + champsim::lg2(DRAM_COLUMNS) + champsim::lg2(DRAM_CHANNELS) + LOG2_BLOCK_SIZE;
   return (address >> shift) & champsim::bitmask(champsim::lg2(DRAM_ROWS));
@@ -0,0 +1,102 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "forking.h"
+
+#include <array>
+#include <cerrno>
+#include <cstdlib>
+#include <string>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+champsim::file_offsets::file_offsets()
+{
+  // The directory is listed before any descriptor is opened, so that the copies are not copied in turn
+  std::vector<int> descriptors;
+  if (auto dir = opendir("/proc/self/fd"); dir != nullptr) {
+    for (auto entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+      if (entry->d_name[0] != '.')
+        descriptors.push_back(std::atoi(entry->d_name));
+    }
+    closedir(dir);
+  }
+
+  for (auto fd : descriptors) {
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || (fcntl(fd, F_GETFL) & O_ACCMODE) != O_RDONLY)
+      continue;
+
+    auto offset = lseek(fd, 0, SEEK_CUR);
+    auto copy = open(("/proc/self/fd/" + std::to_string(fd)).c_str(), O_RDONLY | O_CLOEXEC);
+    if (copy < 0)
+      continue;
+
+    if (offset < 0 || lseek(copy, offset, SEEK_SET) != offset) {
+      close(copy);
+      continue;
+    }
+
+    copies.emplace_back(fd, copy);
+  }
+}
+
+champsim::file_offsets::~file_offsets()
+{
+  for (auto [fd, copy] : copies)
+    close(copy);
+}
+
+void champsim::file_offsets::adopt()
+{
+  // dup2() clears the close-on-exec flag, so the flags of the original are restored
+  for (auto [fd, copy] : copies) {
+    auto flags = fcntl(fd, F_GETFD);
+    dup2(copy, fd);
+    fcntl(fd, F_SETFD, flags);
+  }
+}
+
+bool champsim::write_all(int fd, const std::string& data)
+{
+  for (auto it = std::data(data), end = std::data(data) + std::size(data); it != end;) {
+    auto written = write(fd, it, static_cast<std::size_t>(end - it));
+    if (written < 0 && errno == EINTR)
+      continue;
+    if (written <= 0)
+      return false;
+    it += written;
+  }
+  return true;
+}
+
+std::string champsim::read_all(int fd)
+{
+  std::string result;
+  std::array<char, 4096> buffer;
+  for (;;) {
+    auto bytes_read = read(fd, std::data(buffer), std::size(buffer));
+    if (bytes_read < 0 && errno == EINTR)
+      continue;
+    if (bytes_read <= 0)
+      return result;
+    result.append(std::data(buffer), static_cast<std::size_t>(bytes_read));
+  }
+}
@@ -0,0 +1,200 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "functional_warmup.h"
+
+#include <algorithm>
+#include <map>
+
+#include "champsim.h"
+#include "champsim_constants.h"
+#include "util/bits.h"
+#include "vmem.h"
+
+namespace
+{
+template <typename T>
+T* find_or_null(const std::map<const champsim::channel*, T*>& map, const champsim::channel* key)
+{
+  auto found = map.find(key);
+  return found == std::end(map) ? nullptr : found->second;
+}
+} // namespace
+
+champsim::functional_warmup::functional_warmup(environment& env)
+{
+  // Each cache and page table walker is found below the channels it reads from
+  std::map<const channel*, level*> cache_below;
+  for (CACHE& cache : env.cache_view()) {
+    auto& lvl = levels.emplace_back(level{&cache});
+    for (auto ul : cache.upper_levels)
+      cache_below.emplace(ul, &lvl);
+  }
+
+  std::map<const channel*, PageTableWalker*> walker_below;
+  for (PageTableWalker& ptw : env.ptw_view()) {
+    for (auto ul : ptw.upper_levels)
+      walker_below.emplace(ul, &ptw);
+  }
+
+  for (auto& lvl : levels) {
+    lvl.lower = find_or_null(cache_below, lvl.cache->lower_level);
+    if (lvl.lower == nullptr) {
+      lvl.walker = find_or_null(walker_below, lvl.cache->lower_level);
+      if (lvl.walker != nullptr)
+        lvl.walker_lower = find_or_null(cache_below, lvl.walker->lower_level);
+    }
+    if (lvl.cache->lower_translate != nullptr)
+      lvl.translation = find_or_null(cache_below, lvl.cache->lower_translate);
+  }
+
+  // Addresses are only translated if a page table walker is found below the TLBs
+  for (auto& lvl : levels) {
+    auto tlb = lvl.translation;
+    while (tlb != nullptr && tlb->walker == nullptr)
+      tlb = tlb->lower;
+    if (tlb == nullptr)
+      lvl.translation = nullptr;
+  }
+
+  for (O3_CPU& cpu : env.cpu_view())
+    cores.push_back(core{&cpu, find_or_null(cache_below, cpu.L1I_bus.lower_level), find_or_null(cache_below, cpu.L1D_bus.lower_level)});
+}
+
+void champsim::functional_warmup::operate(O3_CPU& cpu, ooo_model_instr& instr)
+{
+  auto& this_core = *std::find_if(std::begin(cores), std::end(cores), [&cpu](const core& c) { return c.cpu == &cpu; });
+
+  cpu.do_predict_branch(instr);
+
+  // Instructions that hit in the decoded instruction buffer are not fetched, and consecutive instructions in a block are fetched together
+  if (!cpu.DIB.check_hit(instr.ip).has_value()) {
+    if (this_core.l1i != nullptr && (instr.ip >> LOG2_BLOCK_SIZE) != this_core.last_fetch_block) {
+      access(*this_core.l1i, access_packet(*this_core.l1i, cpu.cpu, instr, instr.ip, access_type::LOAD));
+      this_core.last_fetch_block = instr.ip >> LOG2_BLOCK_SIZE;
+    }
+    cpu.do_dib_update(instr);
+  }
+
+  if (this_core.l1d != nullptr) {
+    for (auto smem : instr.source_memory)
+      access(*this_core.l1d, access_packet(*this_core.l1d, cpu.cpu, instr, smem, access_type::LOAD));
+    for (auto dmem : instr.destination_memory)
+      access(*this_core.l1d, access_packet(*this_core.l1d, cpu.cpu, instr, dmem, access_type::WRITE));
+  }
+
+  ++cpu.num_retired;
+
+  // There is no heartbeat without timing, but the next timed phase should report only its own instructions
+  if (cpu.num_retired >= cpu.next_print_instruction) {
+    cpu.next_print_instruction += STAT_PRINTING_PERIOD;
+    cpu.last_heartbeat_instr = cpu.num_retired;
+    cpu.last_heartbeat_cycle = cpu.current_cycle;
+  }
+}
+
+auto champsim::functional_warmup::access_packet(level& lvl, uint32_t cpu, const ooo_model_instr& instr, uint64_t v_address, access_type type)
+    -> request_type
+{
+  request_type packet;
+  packet.asid[0] = instr.asid[0];
+  packet.asid[1] = instr.asid[1];
+  packet.type = type;
+  packet.cpu = cpu;
+  packet.address = translate(lvl, cpu, v_address);
+  packet.v_address = v_address;
+  packet.instr_id = instr.instr_id;
+  packet.ip = instr.ip;
+  packet.response_requested = (type != access_type::WRITE);
+  return packet;
+}
+
+uint64_t champsim::functional_warmup::translate(level& lvl, uint32_t cpu, uint64_t v_address)
+{
+  if (lvl.translation == nullptr)
+    return v_address;
+
+  request_type packet;
+  packet.type = access_type::LOAD;
+  packet.cpu = cpu;
+  packet.address = v_address;
+  packet.v_address = v_address;
+
+  // TLB entries hold the physical address that was translated when they were filled
+  return champsim::splice_bits(access(*lvl.translation, packet), v_address, LOG2_PAGE_SIZE);
+}
+
+uint64_t champsim::functional_warmup::access(level& lvl, const request_type& req, bool local_prefetch)
+{
+  auto& cache = *lvl.cache;
+  auto data = cache.warm_access(req, local_prefetch);
+  if (!data.has_value()) {
+    // Writebacks are placed without reading the lower level. Stores read it for ownership.
+    if (req.type != access_type::WRITE || cache.match_offset_bits) {
+      auto fwd = req;
+      fwd.type = (req.type == access_type::WRITE) ? access_type::RFO : req.type;
+      data = miss(lvl, fwd);
+    } else {
+      data = req.data;
+    }
+
+    if (!local_prefetch || req.response_requested) {
+      auto fill = req;
+      fill.data = data.value();
+      auto writeback = cache.warm_fill(fill, local_prefetch);
+      if (writeback.has_value() && lvl.lower != nullptr)
+        access(*lvl.lower, *writeback);
+    }
+  }
+
+  // Prefetches are issued as soon as they are requested
+  cache.impl_prefetcher_cycle_operate();
+  for (auto pf : cache.warm_prefetches()) {
+    if (!pf.is_translated) {
+      if (lvl.translation == nullptr)
+        continue;
+      pf.address = translate(lvl, pf.cpu, pf.v_address);
+      pf.is_translated = true;
+    }
+    access(lvl, pf, true);
+  }
+
+  return data.value();
+}
+
+uint64_t champsim::functional_warmup::miss(level& lvl, const request_type& req)
+{
+  if (lvl.lower != nullptr)
+    return access(*lvl.lower, req);
+
+  if (lvl.walker == nullptr)
+    return req.data;
+
+  for (auto pte_address : lvl.walker->warm_walk(req.cpu, req.v_address)) {
+    if (lvl.walker_lower != nullptr) {
+      request_type packet;
+      packet.asid[0] = req.asid[0];
+      packet.asid[1] = req.asid[1];
+      packet.type = access_type::TRANSLATION;
+      packet.cpu = req.cpu;
+      packet.address = pte_address;
+      packet.v_address = req.v_address;
+      access(*lvl.walker_lower, packet);
+    }
+  }
+
+  return lvl.walker->vmem->va_to_pa(req.cpu, req.v_address).first;
+}
@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <utility>
 
+#include "sampling.h"
 #include "stats_printer.h"
 #include <nlohmann/json.hpp>
 
@@ -71,6 +72,44 @@ void to_json(nlohmann::json& j, const DRAM_CHANNEL::stats_type stats)
 
 namespace champsim
 {
+void to_json(nlohmann::json& j, const champsim::sample_estimate estimate)
+{
+  j = nlohmann::json{{"mean", estimate.mean}, {"95% CI half-width", estimate.half_width}};
+}
+
+void to_json(nlohmann::json& j, const champsim::profile_stats region)
+{
+  j = nlohmann::json{{"name", region.name}, {"calls", region.calls}, {"ticks", region.ticks}, {"seconds", region.seconds}};
+}
+
+namespace
+{
+// Estimate each headline result from its values across the measured windows
+nlohmann::json sample_summary(const std::vector<champsim::sample_stats>& samples)
+{
+  auto across_windows = [&samples](auto value_of) {
+    std::vector<double> values;
+    std::transform(std::begin(samples), std::end(samples), std::back_inserter(values), value_of);
+    return champsim::estimate_mean(values);
+  };
+
+  const auto& first = samples.front();
+  std::vector<nlohmann::json> cores;
+  for (std::size_t i = 0; i < std::size(first.cpu_ipc); ++i)
+    cores.push_back(nlohmann::json{{"IPC", across_windows([i](const auto& s) { return s.cpu_ipc.at(i); })}});
+
+  std::vector<nlohmann::json> dram;
+  for (std::size_t i = 0; i < std::size(first.dram_apki); ++i)
+    dram.push_back(nlohmann::json{{"APKI", across_windows([i](const auto& s) { return s.dram_apki.at(i).second; })}});
+
+  std::map<std::string, nlohmann::json> statsmap{{"windows", std::size(samples)}, {"cores", cores}, {"DRAM", dram}};
+  for (std::size_t i = 0; i < std::size(first.cache_mpki); ++i)
+    statsmap.emplace(first.cache_mpki.at(i).first, nlohmann::json{{"MPKI", across_windows([i](const auto& s) { return s.cache_mpki.at(i).second; })}});
+
+  return statsmap;
+}
+} // namespace
+
 void to_json(nlohmann::json& j, const champsim::phase_stats stats)
 {
   std::map<std::string, nlohmann::json> roi_stats;
@@ -88,8 +127,40 @@ void to_json(nlohmann::json& j, const champsim::phase_stats stats)
   std::map<std::string, nlohmann::json> statsmap{{"name", stats.name}, {"traces", stats.trace_names}};
   statsmap.emplace("roi", roi_stats);
   statsmap.emplace("sim", sim_stats);
+  if (!std::empty(stats.samples))
+    statsmap.emplace("samples", sample_summary(stats.samples));
+  if (stats.weight > 0)
+    statsmap.emplace("weight", stats.weight);
+  if (!std::empty(stats.stop_reason))
+    statsmap.emplace("stop reason", stats.stop_reason);
+  if (!std::empty(stats.profile))
+    statsmap.emplace("profile", stats.profile);
   j = statsmap;
 }
 } // namespace champsim
 
-void champsim::json_printer::print(std::vector<phase_stats>& stats) { stream << nlohmann::json::array_t{std::begin(stats), std::end(stats)}; }
+void champsim::json_printer::print(std::vector<phase_stats>& stats)
+{
+  nlohmann::json::array_t result{std::begin(stats), std::end(stats)};
+
+  // Weighted regions are followed by their aggregate
+  if (std::any_of(std::begin(stats), std::end(stats), [](const auto& phase) { return phase.weight > 0; })) {
+    auto aggregate = weighted_mean(stats);
+
+    std::vector<nlohmann::json> cores;
+    for (auto ipc : aggregate.cpu_ipc)
+      cores.push_back(nlohmann::json{{"IPC", ipc}});
+
+    std::vector<nlohmann::json> dram;
+    for (const auto& [name, apki] : aggregate.dram_apki)
+      dram.push_back(nlohmann::json{{"APKI", apki}});
+
+    std::map<std::string, nlohmann::json> weighted{{"cores", cores}, {"DRAM", dram}};
+    for (const auto& [name, mpki] : aggregate.cache_mpki)
+      weighted.emplace(name, nlohmann::json{{"MPKI", mpki}});
+
+    result.push_back(nlohmann::json{{"name", "Weighted aggregate"}, {"weighted", weighted}});
+  }
+
+  stream << result;
+}
@@ -15,25 +15,57 @@
  */
 
 #include <algorithm>
+#include <cstdio>
 #include <fstream>
 #include <numeric>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "batch.h"
 #include "champsim.h"
 #include "champsim_constants.h"
 #include "core_inst.inc"
+#include "forking.h"
+#include "inf_stream.h"
+#include "phase_file.h"
 #include "phase_info.h"
+#include "quantum.h"
+#include "simpoint.h"
+#include "state_hash.h"
 #include "stats_printer.h"
 #include "tracereader.h"
 #include "vmem.h"
 #include <CLI/CLI.hpp>
 #include <fmt/core.h>
+#include <fmt/ranges.h>
 
 namespace champsim
 {
 std::vector<phase_stats> main(environment& env, std::vector<phase_info>& phases, std::vector<tracereader>& traces);
+std::vector<phase_stats> main(environment& env, std::vector<phase_info>& phases, std::vector<tracereader>& traces, std::istream& checkpoint);
+}
+
+namespace
+{
+// The number of hardware threads that this process may run on. A sweep pins each of its runs to fewer than the machine has.
+unsigned usable_threads()
+{
+#ifdef __linux__
+  cpu_set_t affinity;
+  CPU_ZERO(&affinity);
+  if (sched_getaffinity(0, sizeof(affinity), &affinity) == 0)
+    return static_cast<unsigned>(CPU_COUNT(&affinity));
+#endif
+  return std::thread::hardware_concurrency();
 }
+} // namespace
 
 int main(int argc, char** argv)
 {
@@ -45,6 +77,32 @@ int main(int argc, char** argv)
   uint64_t warmup_instructions = 0;
   uint64_t simulation_instructions = std::numeric_limits<uint64_t>::max();
   std::string json_file_name;
+  uint64_t parallel_quantum = 0;
+  bool parallel_compare{false};
+  bool functional_warmup{false};
+  uint64_t skip_instructions = 0;
+  uint64_t sample_period = 0;
+  uint64_t sample_warmup = 2000;
+  uint64_t sample_length = 1000;
+  std::string simpoints_name;
+  std::string simpoint_weights_name;
+  uint64_t simpoint_interval = 0;
+  double convergence_tolerance = 0;
+  uint64_t convergence_intervals = 5;
+  bool convergence_llc{false};
+  uint64_t fork_interval = 0;
+  std::size_t fork_jobs = std::max(1u, std::thread::hardware_concurrency());
+  std::size_t trace_read_ahead = 16;
+  std::string decoded_cache_name;
+  std::size_t trace_loop_memory = 64;
+  unsigned inflate_threads = 0;
+  std::string state_hash_name;
+  uint64_t state_hash_period = 100000;
+  std::string state_hash_reference_name;
+  std::string save_checkpoint_name;
+  std::string load_checkpoint_name;
+  std::string batch_name;
+  std::string phases_name;
   std::vector<std::string> trace_names;
 
   auto set_heartbeat_callback = [&](auto) {
@@ -65,10 +123,149 @@ int main(int argc, char** argv)
   auto json_option =
       app.add_option("--json", json_file_name, "The name of the file to receive JSON output. If no name is specified, stdout will be used")->expected(0, 1);
 
-  app.add_option("traces", trace_names, "The paths to the traces")->required()->expected(NUM_CPUS)->check(CLI::ExistingFile);
+  app.add_flag("--functional-warmup", functional_warmup,
+               "Warm the branch predictors, TLBs, and caches directly from the traces during the warmup phase, without modeling the pipeline or timing");
+
+  auto skip_option = app.add_option("--skip-instructions", skip_instructions,
+                                    "Skip each trace forward this many instructions before the warmup phase, without simulating them. A gzip or xz "
+                                    "trace with a seek index starts inflating near its target.");
+
+  auto sample_option = app.add_option("--sample-period", sample_period,
+                                      "Sample the detailed phase: warm each period of this many instructions functionally, except for a detailed warmup "
+                                      "and a measured window at its end");
+  app.add_option("--sample-warmup", sample_warmup, "The number of instructions of detailed warmup before each measured window")
+      ->needs(sample_option)
+      ->capture_default_str();
+  app.add_option("--sample-length", sample_length, "The number of instructions in each measured window")
+      ->needs(sample_option)
+      ->check(CLI::PositiveNumber)
+      ->capture_default_str();
+
+  auto simpoints_option =
+      app.add_option("--simpoints", simpoints_name, "Simulate the regions chosen by SimPoint in the given file, instead of a single detailed phase")
+          ->check(CLI::ExistingFile)
+          ->excludes(sample_option)
+          ->excludes(skip_option);
+  auto weights_option = app.add_option("--simpoint-weights", simpoint_weights_name, "The weights of the regions chosen by SimPoint")
+                            ->check(CLI::ExistingFile)
+                            ->needs(simpoints_option);
+  auto interval_option = app.add_option("--simpoint-interval", simpoint_interval, "The number of instructions in each SimPoint interval")
+                             ->check(CLI::PositiveNumber)
+                             ->needs(simpoints_option);
+  simpoints_option->needs(weights_option)->needs(interval_option);
+
+  auto convergence_option =
+      app.add_option("--convergence-tolerance", convergence_tolerance,
+                     "End the detailed phase early once the cumulative IPC of every core has stayed within this relative tolerance, such as 0.01, "
+                     "over several heartbeat intervals")
+          ->check(CLI::PositiveNumber);
+  app.add_option("--convergence-intervals", convergence_intervals, "The number of heartbeat intervals over which the phase must stay converged")
+      ->needs(convergence_option)
+      ->check(CLI::PositiveNumber)
+      ->capture_default_str();
+  app.add_flag("--convergence-llc", convergence_llc, "Also require the LLC MPKI to converge")->needs(convergence_option);
+
+  auto fork_option = app.add_option("--fork-interval", fork_interval,
+                                    "Warm the detailed phase functionally, and simulate each interval of this many instructions in a child process forked "
+                                    "at its start")
+                         ->check(CLI::PositiveNumber)
+                         ->excludes(sample_option)
+                         ->excludes(simpoints_option)
+                         ->excludes(convergence_option);
+  app.add_option("--fork-jobs", fork_jobs, "The number of child processes that may run at once")
+      ->needs(fork_option)
+      ->check(CLI::PositiveNumber)
+      ->capture_default_str();
+
+  app.add_option("--trace-read-ahead", trace_read_ahead,
+                 "The number of batches of instructions that are decompressed ahead of the simulation on a background thread, for each trace. Zero "
+                 "reads the traces on the simulation thread.")
+      ->capture_default_str();
+  app.add_option("--decoded-cache", decoded_cache_name,
+                 "A directory of decoded instructions, keyed by the contents of the traces. Instructions are replayed from it if they were decoded before, "
+                 "and recorded into it otherwise. The first pass of a repeating trace is cached.")
+      ->excludes(fork_option);
+  app.add_option("--trace-loop-memory", trace_loop_memory,
+                 "The memory, in MiB, that each repeating trace may hold to replay its later passes without reading the trace again. Zero reads the "
+                 "trace again on each pass.")
+      ->capture_default_str();
+  app.add_option("--inflate-threads", inflate_threads,
+                 "The number of threads that inflate each multi-member gzip or multi-block xz trace. Zero divides the hardware threads that this process may "
+                 "run on among the traces.")
+      ->capture_default_str();
+
+  auto quantum_option = app.add_option("--parallel-quantum", parallel_quantum,
+                                       "Run the private caches of each core on their own thread, exchanging traffic with the shared caches and memory "
+                                       "every given number of cycles of the fastest clock");
+  auto compare_option =
+      app.add_flag("--parallel-compare", parallel_compare, "Also run the serial engine in a child process, and report how far the parallel results deviate")
+          ->needs(quantum_option);
+
+  auto state_hash_option = app.add_option("--state-hash-log", state_hash_name,
+                                          "Periodically hash the state of each component of the simulator into the given file, to show that a change to the "
+                                          "engine does not change the simulated behavior")
+                               ->excludes(fork_option);
+  app.add_option("--state-hash-period", state_hash_period, "The number of cycles of the fastest clock between state hashes")
+      ->needs(state_hash_option)
+      ->check(CLI::PositiveNumber)
+      ->capture_default_str();
+  auto state_compare_option = app.add_option("--state-hash-compare", state_hash_reference_name,
+                                             "Compare the state hashes with the log of a reference run, and report the first cycle and component at which "
+                                             "they diverge")
+                                  ->needs(state_hash_option)
+                                  ->check(CLI::ExistingFile);
+
+  auto save_checkpoint_option =
+      app.add_option("--save-checkpoint", save_checkpoint_name, "Save the state of the simulator to the given file at the end of the warmup phase");
+  auto load_checkpoint_option = app.add_option("--load-checkpoint", load_checkpoint_name,
+                                               "Restore the state of the simulator from the given file, instead of running the warmup phase")
+                                    ->check(CLI::ExistingFile)
+                                    ->excludes(save_checkpoint_option);
+  simpoints_option->excludes(save_checkpoint_option)->excludes(load_checkpoint_option);
+
+  auto traces_option = app.add_option("traces", trace_names, "The paths to the traces")->expected(NUM_CPUS)->check(CLI::ExistingFile);
+
+  auto phases_option = app.add_option("--phases", phases_name,
+                                      "Run the sequence of phases described in the given JSON file, instead of a warmup and a simulation phase. Each phase "
+                                      "names its length, whether it is a warmup, and the trace of each core.")
+                           ->check(CLI::ExistingFile)
+                           ->excludes(warmup_instr_option)
+                           ->excludes(deprec_warmup_instr_option)
+                           ->excludes(sim_instr_option)
+                           ->excludes(deprec_sim_instr_option)
+                           ->excludes(simpoints_option)
+                           ->excludes(save_checkpoint_option)
+                           ->excludes(skip_option);
+
+  auto batch_option = app.add_option("--batch", batch_name,
+                                     "Run each job in the given manifest on the same simulator, instead of the traces on the command line. Each line of the "
+                                     "manifest holds the traces of a job and the name of the file to receive its JSON output.")
+                          ->check(CLI::ExistingFile)
+                          ->excludes(traces_option)
+                          ->excludes(json_option)
+                          ->excludes(simpoints_option)
+                          ->excludes(save_checkpoint_option)
+                          ->excludes(load_checkpoint_option)
+                          ->excludes(compare_option)
+                          ->excludes(state_hash_option)
+                          ->excludes(phases_option);
 
   CLI11_PARSE(app, argc, argv);
 
+  // The traces of a batch are given by its manifest
+  std::vector<champsim::batch_job> jobs;
+  if (batch_option->count() > 0) {
+    std::ifstream manifest{batch_name};
+    jobs = champsim::read_batch_manifest(manifest, NUM_CPUS);
+    if (std::empty(jobs)) {
+      fmt::print("The batch manifest holds no jobs\n");
+      return 0;
+    }
+    trace_names = jobs.front().trace_names;
+  } else if (std::empty(trace_names) && phases_option->count() == 0) {
+    return app.exit(CLI::RequiredError{"traces"});
+  }
+
   const bool warmup_given = (warmup_instr_option->count() > 0) || (deprec_warmup_instr_option->count() > 0);
   const bool simulation_given = (sim_instr_option->count() > 0) || (deprec_sim_instr_option->count() > 0);
 
@@ -81,32 +278,190 @@ int main(int argc, char** argv)
   if (simulation_given && !warmup_given)
     warmup_instructions = simulation_instructions * 2 / 10;
 
-  std::vector<champsim::tracereader> traces;
-  std::transform(
-      std::begin(trace_names), std::end(trace_names), std::back_inserter(traces),
-      [knob_cloudsuite, repeat = simulation_given, i = uint8_t(0)](auto name) mutable { return get_tracereader(name, i++, knob_cloudsuite, repeat); });
+  // Traces repeat if they are shorter than the phases that were asked for
+  const bool repeat_traces = simulation_given || phases_option->count() > 0;
+
+  // The reading threads would not survive in the forked children
+  if (fork_option->count() > 0) {
+    trace_read_ahead = 0;
+    inflate_threads = 1;
+  }
+
+  auto open_traces = [&] {
+    auto automatic_threads = std::max<std::size_t>(1, usable_threads() / std::max<std::size_t>(1, std::size(trace_names)));
+    champsim::inflate_threads = inflate_threads > 0 ? inflate_threads : static_cast<unsigned>(automatic_threads);
+
+    std::vector<champsim::tracereader> opened;
+    std::transform(std::begin(trace_names), std::end(trace_names), std::back_inserter(opened),
+                   [knob_cloudsuite, repeat = repeat_traces, read_ahead = trace_read_ahead, &decoded_cache_name, loop_memory = trace_loop_memory << 20,
+                    i = uint8_t(0)](auto name) mutable {
+                     return get_tracereader(name, i++, knob_cloudsuite, repeat, read_ahead, decoded_cache_name, loop_memory);
+                   });
+    return opened;
+  };
 
   std::vector<champsim::phase_info> phases{
       {champsim::phase_info{"Warmup", true, warmup_instructions, std::vector<std::size_t>(std::size(trace_names), 0), trace_names},
        champsim::phase_info{"Simulation", false, simulation_instructions, std::vector<std::size_t>(std::size(trace_names), 0), trace_names}}};
 
-  for (auto& p : phases)
+  for (auto& p : phases) {
     std::iota(std::begin(p.trace_index), std::end(p.trace_index), 0);
+    p.parallel_quantum = parallel_quantum;
+    if (state_hash_option->count() > 0) {
+      p.state_hash_period = state_hash_period;
+      p.state_hash_file = state_hash_name;
+    }
+  }
+  phases.at(0).skip_to = skip_instructions;
+  phases.at(0).checkpoint_file = save_checkpoint_name;
+  phases.at(0).is_functional = functional_warmup;
+  phases.at(1).sample_period = sample_period;
+  phases.at(1).sample_warmup = sample_warmup;
+  phases.at(1).sample_length = sample_length;
+  phases.at(1).fork_interval = fork_interval;
+  phases.at(1).fork_jobs = fork_jobs;
+  if (convergence_option->count() > 0) {
+    phases.at(1).convergence_intervals = convergence_intervals;
+    phases.at(1).convergence_tolerance = convergence_tolerance;
+    phases.at(1).convergence_llc = convergence_llc;
+  }
+
+  // A phase file replaces the warmup and simulation phases, and may name its own traces
+  if (phases_option->count() > 0) {
+    std::ifstream phase_file{phases_name};
+    phases = champsim::read_phase_file(phase_file, trace_names, NUM_CPUS, phases.at(0), phases.at(1));
+    trace_names = phases.front().trace_names;
+  }
 
-  fmt::print("\n*** ChampSim Multicore Out-of-Order Simulator ***\nWarmup Instructions: {}\nSimulation Instructions: {}\nNumber of CPUs: {}\nPage size: {}\n\n",
-             phases.at(0).length, phases.at(1).length, std::size(gen_environment.cpu_view()), PAGE_SIZE);
+  fmt::print("\n*** ChampSim Multicore Out-of-Order Simulator ***\n");
+  if (phases_option->count() > 0) {
+    for (const auto& p : phases)
+      fmt::print("{} {} Instructions: {}\n", p.name, p.is_warmup ? "Warmup" : "Simulation", p.length);
+  } else {
+    fmt::print("Warmup Instructions: {}\nSimulation Instructions: {}\n", phases.at(0).length, phases.at(1).length);
+  }
+  fmt::print("Number of CPUs: {}\nPage size: {}\n\n", std::size(gen_environment.cpu_view()), PAGE_SIZE);
+
+  // Each SimPoint region has its own warmup and simulation phases
+  if (simpoints_option->count() > 0) {
+    std::ifstream simpoints_file{simpoints_name};
+    std::ifstream weights_file{simpoint_weights_name};
+    auto regions = champsim::read_simpoints(simpoints_file, weights_file);
+    fmt::print("SimPoint regions: {}\nSimPoint interval: {}\n\n", std::size(regions), simpoint_interval);
+    phases = champsim::simpoint_phases(regions, simpoint_interval, phases.at(0), phases.at(1));
+  }
+
+  // A checkpoint replaces the warmup
+  const bool restore = load_checkpoint_option->count() > 0;
+  if (restore) {
+    fmt::print("Restoring from checkpoint {}\n", load_checkpoint_name);
+    phases.erase(std::remove_if(std::begin(phases), std::end(phases), [](const champsim::phase_info& p) { return p.is_warmup; }), std::end(phases));
+  }
+
+  auto print_final_stats = [&] {
+    for (CACHE& cache : gen_environment.cache_view())
+      cache.impl_prefetcher_final_stats();
+
+    for (CACHE& cache : gen_environment.cache_view())
+      cache.impl_replacement_final_stats();
+  };
+
+  // Each job of a batch is simulated from the state of the environment after initialization
+  if (batch_option->count() > 0) {
+    fmt::print("Batch jobs: {}\n", std::size(jobs));
+    champsim::batch runner{gen_environment};
+    for (std::size_t i = 0; i < std::size(jobs); ++i) {
+      trace_names = jobs.at(i).trace_names;
+      auto job_phases = phases;
+      for (auto& p : job_phases)
+        p.trace_names = trace_names;
+
+      fmt::print("\n=== Batch job {}: {} ===\n", i, fmt::join(trace_names, " "));
+      auto job_traces = open_traces();
+      auto job_stats = runner.run(job_phases, job_traces);
+
+      fmt::print("\nChampSim completed all CPUs\n\n");
+      champsim::plain_printer{std::cout}.print(job_stats);
+      print_final_stats();
+
+      std::ofstream json_file{jobs.at(i).json_file_name};
+      champsim::json_printer{json_file}.print(job_stats);
+    }
+
+    return 0;
+  }
 
-  auto phase_stats = champsim::main(gen_environment, phases, traces);
+  auto run = [&](std::vector<champsim::phase_info>& run_phases, std::vector<champsim::tracereader>& run_traces) {
+    if (!restore)
+      return champsim::main(gen_environment, run_phases, run_traces);
+
+    std::ifstream checkpoint{load_checkpoint_name, std::ios::binary};
+    return champsim::main(gen_environment, run_phases, run_traces, checkpoint);
+  };
+
+  // The serial reference forks before any simulation, so it starts from the same state. It opens its own traces, since the open files are shared.
+  int reference_fd = -1;
+  pid_t reference_pid = -1;
+  if (parallel_compare) {
+    std::fflush(stdout);
+    int reference_pipe[2];
+    if (pipe(reference_pipe) == 0) {
+      reference_pid = fork();
+      if (reference_pid == 0) {
+        close(reference_pipe[0]);
+        std::freopen("/dev/null", "w", stdout);
+
+        auto serial_phases = phases;
+        for (auto& p : serial_phases) {
+          p.parallel_quantum = 0;
+          p.checkpoint_file.clear();
+          p.state_hash_period = 0;
+        }
+
+        // The reference exits without finishing its recordings
+        decoded_cache_name.clear();
+        auto serial_traces = open_traces();
+        champsim::write_all(reference_pipe[1], champsim::serialize(champsim::summarize(run(serial_phases, serial_traces))));
+        std::_Exit(0);
+      }
+
+      close(reference_pipe[1]);
+      reference_fd = reference_pipe[0];
+    }
+
+    if (reference_pid < 0)
+      fmt::print("WARNING: could not start the serial reference\n");
+  }
+
+  // Each phase appends its state hashes to the log
+  if (state_hash_option->count() > 0)
+    std::ofstream truncated{state_hash_name};
+
+  auto traces = open_traces();
+  auto phase_stats = run(phases, traces);
 
   fmt::print("\nChampSim completed all CPUs\n\n");
 
   champsim::plain_printer{std::cout}.print(phase_stats);
 
-  for (CACHE& cache : gen_environment.cache_view())
-    cache.impl_prefetcher_final_stats();
+  if (reference_pid > 0) {
+    auto reference = champsim::read_all(reference_fd);
+    close(reference_fd);
+    waitpid(reference_pid, nullptr, 0);
+
+    if (!std::empty(reference))
+      champsim::print_deviation(std::cout, parallel_quantum, champsim::summarize(phase_stats), champsim::deserialize(reference));
+    else
+      fmt::print("WARNING: the serial reference did not complete\n");
+  }
+
+  if (state_compare_option->count() > 0) {
+    std::ifstream reference{state_hash_reference_name};
+    std::ifstream actual{state_hash_name};
+    fmt::print("{}\n", champsim::state_hash::describe(champsim::state_hash::compare(reference, actual)));
+  }
 
-  for (CACHE& cache : gen_environment.cache_view())
-    cache.impl_replacement_final_stats();
+  print_final_stats();
 
   if (json_option->count() > 0) {
     if (json_file_name.empty()) {
@@ -0,0 +1,84 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "mapped_tracereader.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fmt/core.h>
+
+champsim::mapped_file::mapped_file(const std::string& fname)
+{
+  auto fd = ::open(fname.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error{fmt::format("Could not open {}", fname)};
+
+  struct stat status;
+  if (::fstat(fd, &status) == 0 && status.st_size > 0) {
+    size_ = static_cast<std::size_t>(status.st_size);
+    auto mapping = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+      ::close(fd);
+      throw std::runtime_error{fmt::format("Could not map {}", fname)};
+    }
+    data_ = static_cast<const char*>(mapping);
+
+    // The trace is read once, front to back. The hints are only advice, so they may fail.
+    ::madvise(mapping, size_, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+    ::madvise(mapping, size_, MADV_HUGEPAGE);
+#endif
+    advise_next();
+  }
+
+  // The mapping holds its own reference to the file
+  ::close(fd);
+}
+
+champsim::mapped_file::mapped_file(mapped_file&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)), advised_(std::exchange(other.advised_, 0))
+{
+}
+
+auto champsim::mapped_file::operator=(mapped_file&& other) noexcept -> mapped_file&
+{
+  std::swap(data_, other.data_);
+  std::swap(size_, other.size_);
+  std::swap(advised_, other.advised_);
+  return *this;
+}
+
+champsim::mapped_file::~mapped_file()
+{
+  if (data_ != nullptr)
+    ::munmap(const_cast<char*>(data_), size_);
+}
+
+void champsim::mapped_file::advise_next()
+{
+  // The mapping starts on a page boundary, and the window is a multiple of any page size
+  auto length = std::min(readahead_size, size_ - advised_);
+  ::madvise(const_cast<char*>(data_ + advised_), length, MADV_WILLNEED);
+  advised_ += length;
+}
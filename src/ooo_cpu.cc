@@ -19,10 +19,12 @@
 #include <algorithm>
 #include <chrono>
 #include <cmath>
+#include <functional>
 #include <numeric>
 
 #include "cache.h"
 #include "champsim.h"
+#include "checkpoint.h"
 #include "deadlock.h"
 #include "instruction.h"
 #include "util/span.h"
@@ -36,31 +38,45 @@ long O3_CPU::operate()
 {
   long progress{0};
 
-  progress += retire_rob();                    // retire
-  progress += complete_inflight_instruction(); // finalize execution
-  progress += execute_instruction();           // execute instructions
-  progress += schedule_instruction();          // schedule instructions
-  progress += handle_memory_return();          // finalize memory transactions
-  progress += operate_lsq();                   // execute memory transactions
+  auto timed = [this](stage which, auto step) {
+    champsim::profiler::timer<> stage_timer{stage_profile[champsim::to_underlying(which)]};
+    return (this->*step)();
+  };
+
+  progress += timed(stage::retire, &O3_CPU::retire_rob);                      // retire
+  progress += timed(stage::complete, &O3_CPU::complete_inflight_instruction); // finalize execution
+  progress += timed(stage::execute, &O3_CPU::execute_instruction);            // execute instructions
+  progress += timed(stage::schedule, &O3_CPU::schedule_instruction);          // schedule instructions
+  progress += timed(stage::memory_return, &O3_CPU::handle_memory_return);     // finalize memory transactions
+  progress += timed(stage::lsq, &O3_CPU::operate_lsq);                        // execute memory transactions
 
-  progress += dispatch_instruction(); // dispatch
-  progress += decode_instruction();   // decode
-  progress += promote_to_decode();
+  progress += timed(stage::dispatch, &O3_CPU::dispatch_instruction); // dispatch
+  progress += timed(stage::decode, &O3_CPU::decode_instruction);     // decode
+  progress += timed(stage::promote, &O3_CPU::promote_to_decode);
 
-  progress += fetch_instruction(); // fetch
-  progress += check_dib();
-  initialize_instruction();
+  progress += timed(stage::fetch, &O3_CPU::fetch_instruction); // fetch
+  progress += timed(stage::dib, &O3_CPU::check_dib);
+  timed(stage::initialize, &O3_CPU::initialize_instruction);
 
   // heartbeat
-  if (show_heartbeat && (num_retired >= next_print_instruction)) {
+  if ((show_heartbeat || heartbeat_history > 0) && (num_retired >= next_print_instruction)) {
     auto heartbeat_instr{std::ceil(num_retired - last_heartbeat_instr)};
     auto heartbeat_cycle{std::ceil(current_cycle - last_heartbeat_cycle)};
 
     auto phase_instr{std::ceil(num_retired - begin_phase_instr)};
     auto phase_cycle{std::ceil(current_cycle - begin_phase_cycle)};
 
-    fmt::print("Heartbeat CPU {} instructions: {} cycles: {} heartbeat IPC: {:.4g} cumulative IPC: {:.4g} (Simulation time: {:%H hr %M min %S sec})\n", cpu,
-               num_retired, current_cycle, heartbeat_instr / heartbeat_cycle, phase_instr / phase_cycle, elapsed_time());
+    if (show_heartbeat) {
+      fmt::print("Heartbeat CPU {} instructions: {} cycles: {} heartbeat IPC: {:.4g} cumulative IPC: {:.4g} (Simulation time: {:%H hr %M min %S sec})\n",
+                 cpu, num_retired, current_cycle, heartbeat_instr / heartbeat_cycle, phase_instr / phase_cycle, elapsed_time());
+    }
+
+    if (heartbeat_history > 0) {
+      heartbeat_ipc.push_back(phase_instr / phase_cycle);
+      while (std::size(heartbeat_ipc) > heartbeat_history)
+        heartbeat_ipc.pop_front();
+    }
+
     next_print_instruction += STAT_PRINTING_PERIOD;
 
     last_heartbeat_instr = num_retired;
@@ -77,10 +93,70 @@ void O3_CPU::initialize()
   impl_initialize_btb();
 }
 
+void O3_CPU::save_checkpoint(std::ostream& stream)
+{
+  champsim::checkpoint::save(stream, std::tie(num_retired, last_heartbeat_cycle, last_heartbeat_instr, next_print_instruction, DIB));
+  impl_checkpoint_branch_predictor(stream);
+  impl_checkpoint_btb(stream);
+}
+
+void O3_CPU::load_checkpoint(std::istream& stream)
+{
+  auto fields = std::tie(num_retired, last_heartbeat_cycle, last_heartbeat_instr, next_print_instruction, DIB);
+  champsim::checkpoint::load(stream, fields);
+  impl_restore_branch_predictor(stream);
+  impl_restore_btb(stream);
+}
+
+std::vector<std::pair<std::string, champsim::profiler::region>> O3_CPU::profile() const
+{
+  constexpr std::array<std::string_view, std::tuple_size_v<decltype(stage_profile)>> stage_names{
+      {"retire", "complete", "execute", "schedule", "memory return", "LSQ", "dispatch", "decode", "promote to decode", "fetch", "DIB check", "initialize"}};
+
+  auto name = "CPU " + std::to_string(cpu);
+  std::vector<std::pair<std::string, champsim::profiler::region>> result{{name, operate_profile}};
+  for (std::size_t i = 0; i < std::size(stage_profile); ++i)
+    result.emplace_back(fmt::format("{} {}", name, stage_names[i]), stage_profile[i]);
+  return result;
+}
+
+void O3_CPU::clear_inflight()
+{
+  input_queue.clear();
+  IFETCH_BUFFER.clear();
+  DECODE_BUFFER.clear();
+  DISPATCH_BUFFER.clear();
+  ROB.clear();
+  std::fill(std::begin(LQ), std::end(LQ), std::nullopt);
+  SQ.clear();
+  for (auto& producers : reg_producers)
+    producers.clear();
+  fetch_resume_cycle = 0;
+}
+
+void O3_CPU::save_inflight(std::ostream& stream)
+{
+  champsim::checkpoint::save(stream, fetch_resume_cycle);
+  for (const auto* buffer : {&IFETCH_BUFFER, &DECODE_BUFFER, &DISPATCH_BUFFER, &ROB}) {
+    champsim::checkpoint::save(stream, std::size(*buffer));
+    for (const auto& instr : *buffer) {
+      champsim::checkpoint::save(stream, std::tie(instr.instr_id, instr.ip, instr.event_cycle, instr.branch_prediction, instr.fetched, instr.decoded,
+                                                  instr.scheduled, instr.executed, instr.completed_mem_ops, instr.num_reg_dependent));
+    }
+  }
+  for (const auto& lq_entry : LQ) {
+    if (lq_entry.has_value())
+      champsim::checkpoint::save(stream, std::tie(lq_entry->instr_id, lq_entry->virtual_address, lq_entry->event_cycle, lq_entry->fetch_issued));
+  }
+  for (const auto& sq_entry : SQ)
+    champsim::checkpoint::save(stream, std::tie(sq_entry.instr_id, sq_entry.virtual_address, sq_entry.event_cycle, sq_entry.fetch_issued));
+}
+
 void O3_CPU::begin_phase()
 {
   begin_phase_instr = num_retired;
   begin_phase_cycle = current_cycle;
+  heartbeat_ipc.clear();
 
   // Record where the next phase begins
   stats_type stats;
@@ -104,6 +180,89 @@ void O3_CPU::end_phase(unsigned finished_cpu)
   }
 }
 
+cpu_stats operator+(cpu_stats lhs, const cpu_stats& rhs)
+{
+  lhs.end_instrs += rhs.instrs();
+  lhs.end_cycles += rhs.cycles();
+  lhs.total_rob_occupancy_at_branch_mispredict += rhs.total_rob_occupancy_at_branch_mispredict;
+  std::transform(std::begin(lhs.total_branch_types), std::end(lhs.total_branch_types), std::begin(rhs.total_branch_types), std::begin(lhs.total_branch_types),
+                 std::plus<>{});
+  std::transform(std::begin(lhs.branch_type_misses), std::end(lhs.branch_type_misses), std::begin(rhs.branch_type_misses), std::begin(lhs.branch_type_misses),
+                 std::plus<>{});
+  return lhs;
+}
+
+uint64_t O3_CPU::next_event_cycle() const
+{
+  // Memory returns and retirement are handled immediately
+  if (!std::empty(L1I_bus.lower_level->returned) || !std::empty(L1D_bus.lower_level->returned))
+    return current_cycle;
+  if (!std::empty(ROB) && ROB.front().executed == COMPLETED)
+    return current_cycle;
+
+  uint64_t next_event = std::numeric_limits<uint64_t>::max();
+  auto consider = [&next_event](uint64_t cycle) { next_event = std::min(next_event, cycle); };
+
+  // Front-end
+  if (!std::empty(input_queue) && std::size(IFETCH_BUFFER) < IFETCH_BUFFER_SIZE)
+    consider(fetch_resume_cycle);
+
+  auto unfetched = [](const ooo_model_instr& x) { return !x.dib_checked || !x.fetched; };
+  if (std::any_of(std::begin(IFETCH_BUFFER), std::end(IFETCH_BUFFER), unfetched))
+    return current_cycle;
+
+  if (!std::empty(IFETCH_BUFFER) && IFETCH_BUFFER.front().fetched == COMPLETED && std::size(DECODE_BUFFER) < DECODE_BUFFER_SIZE)
+    consider(IFETCH_BUFFER.front().event_cycle);
+
+  if (!std::empty(DECODE_BUFFER) && std::size(DISPATCH_BUFFER) < DISPATCH_BUFFER_SIZE)
+    consider(DECODE_BUFFER.front().event_cycle);
+
+  if (!std::empty(DISPATCH_BUFFER) && std::size(ROB) != ROB_SIZE
+      && ((std::size_t)std::count_if(std::begin(LQ), std::end(LQ), [](const auto& lq_entry) { return !lq_entry.has_value(); })
+          >= std::size(DISPATCH_BUFFER.front().source_memory))
+      && ((std::size(DISPATCH_BUFFER.front().destination_memory) + std::size(SQ)) <= SQ_SIZE)) {
+    consider(DISPATCH_BUFFER.front().event_cycle + 1);
+  }
+
+  // Execution core
+  auto search_bw = SCHEDULER_SIZE;
+  for (auto rob_it = std::begin(ROB); rob_it != std::end(ROB) && search_bw > 0; ++rob_it) {
+    if (rob_it->scheduled == 0)
+      return current_cycle;
+
+    if (rob_it->executed == 0)
+      --search_bw;
+  }
+
+  for (const auto& rob_entry : ROB) {
+    if (rob_entry.scheduled == COMPLETED && rob_entry.executed == 0 && rob_entry.num_reg_dependent == 0)
+      consider(rob_entry.event_cycle);
+    if (rob_entry.executed == INFLIGHT && rob_entry.completed_mem_ops == rob_entry.num_mem_ops())
+      consider(rob_entry.event_cycle);
+  }
+
+  // Load/store queues
+  const auto complete_id = std::empty(ROB) ? std::numeric_limits<uint64_t>::max() : ROB.front().instr_id;
+  if (!std::empty(SQ) && SQ.front().instr_id < complete_id)
+    consider(SQ.front().event_cycle);
+
+  auto unfetched_sq = std::partition_point(std::begin(SQ), std::end(SQ), [](const auto& x) { return x.fetch_issued; });
+  if (unfetched_sq != std::end(SQ))
+    consider(unfetched_sq->event_cycle);
+
+  for (const auto& lq_entry : LQ) {
+    if (lq_entry.has_value() && lq_entry->producer_id == std::numeric_limits<uint64_t>::max() && !lq_entry->fetch_issued)
+      consider(lq_entry->event_cycle + 1);
+  }
+
+  return std::max(next_event, current_cycle);
+}
+
+std::size_t O3_CPU::input_occupancy() const
+{
+  return std::size(input_queue) + std::size(L1I_bus.lower_level->returned) + std::size(L1D_bus.lower_level->returned);
+}
+
 void O3_CPU::initialize_instruction()
 {
   auto instrs_to_read_this_cycle = std::min(FETCH_WIDTH, static_cast<long>(IFETCH_BUFFER_SIZE - std::size(IFETCH_BUFFER)));
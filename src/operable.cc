@@ -0,0 +1,55 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "operable.h"
+
+#include <cmath>
+#include <numeric>
+#include <utility>
+
+champsim::clock_period::clock_period(uint64_t ticks_, uint64_t cycles_) : ticks(ticks_), cycles(cycles_)
+{
+  // Periods shorter than a tick (including an unset period) operate on every tick
+  if (cycles == 0 || ticks <= cycles) {
+    ticks = 1;
+    cycles = 1;
+  }
+
+  auto divisor = std::gcd(ticks, cycles);
+  ticks /= divisor;
+  cycles /= divisor;
+}
+
+champsim::clock_period::clock_period(double scale)
+{
+  if (!(scale > 1))
+    return;
+
+  // Walk the continued fraction expansion until a convergent matches the scale to within floating-point precision
+  uint64_t prev_ticks = 1, prev_cycles = 0;
+  uint64_t next_ticks = static_cast<uint64_t>(scale), next_cycles = 1;
+  for (auto remainder = scale - std::floor(scale); std::abs(scale - static_cast<double>(next_ticks) / static_cast<double>(next_cycles)) > scale * 1e-12;) {
+    remainder = 1 / remainder;
+    auto term = static_cast<uint64_t>(remainder);
+    remainder -= std::floor(remainder);
+
+    prev_ticks = std::exchange(next_ticks, term * next_ticks + prev_ticks);
+    prev_cycles = std::exchange(next_cycles, term * next_cycles + prev_cycles);
+  }
+
+  ticks = next_ticks;
+  cycles = next_cycles;
+}
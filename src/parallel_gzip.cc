@@ -0,0 +1,352 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "parallel_gzip.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+
+#include <zlib.h>
+
+#include "inf_stream.h"
+#include "mapped_tracereader.h"
+
+namespace
+{
+constexpr std::size_t output_step = 1 << 18;
+
+// A gzip inflater that is reset at the start of each member
+struct inflater {
+  z_stream strm{};
+
+  inflater()
+  {
+    if (::inflateInit2(&strm, 15 + 16) != Z_OK)
+      throw std::runtime_error{"could not start inflating a gzip member"};
+  }
+  inflater(const inflater&) = delete;
+  inflater& operator=(const inflater&) = delete;
+  ~inflater() { ::inflateEnd(&strm); }
+
+  void reset() { ::inflateReset(&strm); }
+
+  // Inflate from the offset into the end of the output. Returns the result of zlib, and advances the offset past the input that was consumed.
+  int step(const char* data, std::size_t size, std::size_t& offset, std::vector<char>& output)
+  {
+    auto old_size = std::size(output);
+    output.resize(old_size + output_step);
+
+    strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data + offset));
+    strm.avail_in = static_cast<uInt>(std::min<std::size_t>(size - offset, std::numeric_limits<uInt>::max()));
+    strm.next_out = reinterpret_cast<Bytef*>(std::data(output) + old_size);
+    strm.avail_out = static_cast<uInt>(output_step);
+
+    auto ret = ::inflate(&strm, Z_NO_FLUSH);
+    offset = static_cast<std::size_t>(reinterpret_cast<const char*>(strm.next_in) - data);
+    output.resize(std::size(output) - strm.avail_out);
+    return ret;
+  }
+};
+} // namespace
+
+bool champsim::parallel_gzip::is_member_start(const char* data, std::size_t size, std::size_t offset)
+{
+  // The magic number, the deflate method, and no reserved flags
+  constexpr std::size_t header_size = 10;
+  return offset + header_size <= size && data[offset] == '\x1f' && data[offset + 1] == '\x8b' && data[offset + 2] == '\x08'
+         && (static_cast<unsigned char>(data[offset + 3]) & 0xe0u) == 0;
+}
+
+std::size_t champsim::parallel_gzip::find_member_start(const char* data, std::size_t size, std::size_t from, std::size_t until)
+{
+  until = std::min(until, size);
+  while (from < until) {
+    auto found = static_cast<const char*>(std::memchr(data + from, '\x1f', until - from));
+    if (found == nullptr)
+      break;
+    from = static_cast<std::size_t>(found - data);
+    if (is_member_start(data, size, from))
+      return from;
+    ++from;
+  }
+  return size;
+}
+
+auto champsim::parallel_gzip::inflate_members(const char* data, std::size_t size, std::size_t begin, std::size_t until, std::size_t output_limit,
+                                              const std::atomic<bool>* cancelled) -> members
+{
+  members result{begin};
+  inflater strm;
+  auto offset = begin;
+  while (is_member_start(data, size, offset)) {
+    strm.reset();
+    for (auto ret = Z_OK; ret != Z_STREAM_END;) {
+      if ((cancelled != nullptr && cancelled->load(std::memory_order_relaxed)) || std::size(result.inflated) > output_limit)
+        return result;
+
+      // A member that cannot be inflated to its end is left to the reader, which stops where a single thread would
+      ret = strm.step(data, size, offset, result.inflated);
+      if (ret != Z_OK && ret != Z_STREAM_END)
+        return result;
+    }
+
+    result.end = offset;
+    if (offset >= until)
+      break;
+  }
+
+  result.valid = true;
+  return result;
+}
+
+class champsim::parallel_gzip::istream::state
+{
+  struct job {
+    std::size_t span_begin;
+    std::size_t span_end;
+    bool started = false;
+    bool scanned = false;
+    bool done = false;
+    std::size_t first = 0; // The first offset in the span that could begin a member
+    std::atomic<bool> cancelled{false};
+    members result{0};
+
+    job(std::size_t b, std::size_t e) : span_begin(b), span_end(e) {}
+  };
+
+  mapped_file file;
+  std::size_t span;
+  std::size_t output_limit;
+  unsigned worker_count;
+
+  // The reader inflates the members that the workers did not
+  inflater strm{};
+  bool in_member = false;
+  bool finished = false;
+  std::size_t position = 0; // The compressed offset of the reader
+  std::vector<char> ready{};
+  std::size_t ready_position = 0;
+
+  std::mutex mutex{};
+  std::condition_variable changed{};
+  std::deque<std::shared_ptr<job>> jobs{};    // The jobs ahead of the reader, in order of their spans
+  std::deque<std::shared_ptr<job>> waiting{}; // The jobs that no worker has started
+  std::size_t next_span = 1;
+  bool stopping = false;
+  std::vector<std::thread> workers{};
+
+  void work();
+  void schedule(std::size_t boundary);
+  std::optional<members> take(std::size_t boundary);
+  bool refill();
+
+public:
+  state(const std::string& trace_name, unsigned threads, std::size_t span_size, std::size_t limit)
+      : file(trace_name), span(span_size), output_limit(limit), worker_count(threads > 1 ? threads - 1 : 0)
+  {
+  }
+  state(const state&) = delete;
+  state& operator=(const state&) = delete;
+  ~state();
+
+  // Copy up to count inflated bytes into the destination, or discard them if it is null
+  std::size_t transfer(char* dest, std::size_t count);
+};
+
+champsim::parallel_gzip::istream::state::~state()
+{
+  {
+    std::lock_guard lock{mutex};
+    stopping = true;
+    for (auto& j : jobs)
+      j->cancelled.store(true, std::memory_order_relaxed);
+  }
+  changed.notify_all();
+  for (auto& worker : workers)
+    worker.join();
+}
+
+void champsim::parallel_gzip::istream::state::work()
+{
+  std::unique_lock lock{mutex};
+  for (;;) {
+    changed.wait(lock, [this] { return stopping || !std::empty(waiting); });
+    if (stopping)
+      return;
+
+    auto current = waiting.front();
+    waiting.pop_front();
+    if (current->cancelled.load(std::memory_order_relaxed))
+      continue;
+    current->started = true;
+
+    lock.unlock();
+    auto first = find_member_start(file.data(), file.size(), current->span_begin, current->span_end);
+    lock.lock();
+    current->first = first;
+    current->scanned = true;
+    changed.notify_all();
+
+    if (first < current->span_end) {
+      lock.unlock();
+      auto result = inflate_members(file.data(), file.size(), first, current->span_end, output_limit, &current->cancelled);
+      lock.lock();
+      current->result = std::move(result);
+    }
+    current->done = true;
+    changed.notify_all();
+  }
+}
+
+void champsim::parallel_gzip::istream::state::schedule(std::size_t boundary)
+{
+  {
+    std::lock_guard lock{mutex};
+    if (std::empty(workers)) {
+      for (unsigned i = 0; i < worker_count; ++i)
+        workers.emplace_back(&state::work, this);
+    }
+
+    // Keep two spans waiting for each worker
+    next_span = std::max(next_span, boundary / span + 1);
+    for (auto last = boundary / span + 1 + 2 * worker_count; next_span < last && next_span * span < file.size(); ++next_span) {
+      auto created = std::make_shared<job>(next_span * span, std::min((next_span + 1) * span, file.size()));
+      jobs.push_back(created);
+      waiting.push_back(created);
+    }
+  }
+  changed.notify_all();
+}
+
+auto champsim::parallel_gzip::istream::state::take(std::size_t boundary) -> std::optional<members>
+{
+  if (worker_count == 0)
+    return std::nullopt;
+
+  schedule(boundary);
+  std::unique_lock lock{mutex};
+
+  // The spans that the reader has passed are no longer needed
+  while (!std::empty(jobs) && jobs.front()->span_end <= boundary) {
+    jobs.front()->cancelled.store(true, std::memory_order_relaxed);
+    jobs.pop_front();
+  }
+  if (std::empty(jobs) || jobs.front()->span_begin > boundary)
+    return std::nullopt;
+
+  auto current = jobs.front();
+  jobs.pop_front();
+
+  // A span that no worker has started is inflated as quickly by the reader
+  if (!current->started) {
+    current->cancelled.store(true, std::memory_order_relaxed);
+    return std::nullopt;
+  }
+
+  changed.wait(lock, [&current] { return current->scanned; });
+  if (current->first != boundary) {
+    current->cancelled.store(true, std::memory_order_relaxed);
+    return std::nullopt;
+  }
+
+  changed.wait(lock, [&current] { return current->done; });
+  if (!current->result.valid)
+    return std::nullopt;
+  return std::move(current->result);
+}
+
+bool champsim::parallel_gzip::istream::state::refill()
+{
+  ready.clear();
+  ready_position = 0;
+  while (std::empty(ready)) {
+    if (!in_member) {
+      // Anything after the last member that is not another member ends the stream
+      if (finished || !is_member_start(file.data(), file.size(), position)) {
+        finished = true;
+        return false;
+      }
+
+      if (auto taken = take(position); taken.has_value()) {
+        ready = std::move(taken->inflated);
+        position = taken->end;
+        continue;
+      }
+
+      strm.reset();
+      in_member = true;
+    }
+
+    file.advance_to(position);
+    auto ret = strm.step(file.data(), file.size(), position, ready);
+    if (ret == Z_STREAM_END) {
+      in_member = false;
+    } else if (ret != Z_OK) {
+      in_member = false;
+      finished = true;
+      return !std::empty(ready);
+    }
+  }
+  return true;
+}
+
+std::size_t champsim::parallel_gzip::istream::state::transfer(char* dest, std::size_t count)
+{
+  std::size_t transferred = 0;
+  while (transferred < count && (ready_position < std::size(ready) || refill())) {
+    auto step = std::min(count - transferred, std::size(ready) - ready_position);
+    if (dest != nullptr)
+      std::memcpy(dest + transferred, std::data(ready) + ready_position, step);
+    ready_position += step;
+    transferred += step;
+  }
+  return transferred;
+}
+
+champsim::parallel_gzip::istream::istream(const std::string& trace_name)
+    : istream(trace_name, champsim::inflate_threads.load(std::memory_order_relaxed))
+{
+}
+
+champsim::parallel_gzip::istream::istream(const std::string& trace_name, unsigned threads, std::size_t span, std::size_t output_limit)
+    : state_(std::make_unique<state>(trace_name, threads, span, output_limit))
+{
+}
+
+champsim::parallel_gzip::istream::istream(istream&&) noexcept = default;
+auto champsim::parallel_gzip::istream::operator=(istream&&) noexcept -> istream& = default;
+champsim::parallel_gzip::istream::~istream() = default;
+
+auto champsim::parallel_gzip::istream::read(char* s, std::streamsize count) -> istream&
+{
+  gcount_ = static_cast<std::streamsize>(state_->transfer(s, static_cast<std::size_t>(count)));
+  eof_ = gcount_ < count;
+  return *this;
+}
+
+auto champsim::parallel_gzip::istream::ignore(std::streamsize count) -> istream&
+{
+  gcount_ = static_cast<std::streamsize>(state_->transfer(nullptr, static_cast<std::size_t>(count)));
+  eof_ = gcount_ < count;
+  return *this;
+}
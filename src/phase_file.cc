@@ -0,0 +1,108 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "phase_file.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+
+namespace
+{
+template <typename T>
+T value_or(const nlohmann::json& object, const char* key, T fallback)
+{
+  auto found = object.find(key);
+  return found == std::end(object) ? fallback : found->get<T>();
+}
+
+std::size_t trace_index_of(const nlohmann::json& trace, std::vector<std::string>& trace_names)
+{
+  if (trace.is_string()) {
+    auto name = trace.get<std::string>();
+    auto found = std::find(std::begin(trace_names), std::end(trace_names), name);
+    if (found != std::end(trace_names))
+      return static_cast<std::size_t>(std::distance(std::begin(trace_names), found));
+    trace_names.push_back(name);
+    return std::size(trace_names) - 1;
+  }
+
+  auto idx = trace.get<std::size_t>();
+  if (idx >= std::size(trace_names))
+    throw std::runtime_error(fmt::format("trace {} is not one of the {} traces", idx, std::size(trace_names)));
+  return idx;
+}
+} // namespace
+
+std::vector<champsim::phase_info> champsim::read_phase_file(std::istream& file, std::vector<std::string> trace_names, std::size_t num_cpus,
+                                                            const phase_info& warmup, const phase_info& simulation)
+{
+  const std::vector<std::string> known_keys{"name", "warmup", "functional", "length", "traces", "skip_to", "checkpoint"};
+
+  std::vector<phase_info> result;
+  try {
+    auto description = nlohmann::json::parse(file);
+    if (description.contains("traces"))
+      trace_names = description.at("traces").get<std::vector<std::string>>();
+
+    for (const auto& phase : description.at("phases")) {
+      auto phase_number = std::size(result);
+      try {
+        for (const auto& [key, value] : phase.items()) {
+          if (std::find(std::begin(known_keys), std::end(known_keys), key) == std::end(known_keys))
+            throw std::runtime_error(fmt::format("\"{}\" is not a property of a phase", key));
+        }
+
+        auto& info = result.emplace_back(value_or(phase, "warmup", false) ? warmup : simulation);
+        info.name = value_or(phase, "name", fmt::format("Phase {}", phase_number));
+        info.length = phase.at("length").get<uint64_t>();
+        info.is_functional = value_or(phase, "functional", info.is_functional && info.is_warmup);
+        if (info.is_functional && !info.is_warmup)
+          throw std::runtime_error("only a warmup phase may be functional");
+        info.skip_to = value_or(phase, "skip_to", uint64_t{0});
+        info.checkpoint_file = value_or(phase, "checkpoint", std::string{});
+
+        info.trace_index.clear();
+        if (phase.contains("traces")) {
+          for (const auto& trace : phase.at("traces"))
+            info.trace_index.push_back(trace_index_of(trace, trace_names));
+        } else {
+          info.trace_index.resize(std::min(num_cpus, std::size(trace_names)));
+          std::iota(std::begin(info.trace_index), std::end(info.trace_index), 0);
+        }
+        if (std::size(info.trace_index) != num_cpus)
+          throw std::runtime_error(fmt::format("{} traces are given for {} cores", std::size(info.trace_index), num_cpus));
+      } catch (const std::exception& e) {
+        throw std::runtime_error(fmt::format("Phase {} of the phase file is not valid: {}", phase_number, e.what()));
+      }
+    }
+  } catch (const nlohmann::json::exception& e) {
+    throw std::runtime_error(fmt::format("The phase file is not valid: {}", e.what()));
+  }
+
+  if (std::empty(result))
+    throw std::runtime_error("The phase file holds no phases");
+
+  // The trace names are complete once every phase has been read
+  for (auto& info : result)
+    info.trace_names = trace_names;
+
+  return result;
+}
@@ -14,11 +14,14 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <iterator>
 #include <numeric>
 #include <sstream>
 #include <utility>
 #include <vector>
 
+#include "sampling.h"
 #include "stats_printer.h"
 #include <fmt/core.h>
 #include <fmt/ostream.h>
@@ -97,6 +100,12 @@ void champsim::plain_printer::print(champsim::phase_stats& stats)
   for (auto tn : stats.trace_names)
     fmt::print(stream, "CPU {} runs {}", i++, tn);
 
+  if (stats.weight > 0)
+    fmt::print(stream, "\nRegion weight: {:.4g}\n", stats.weight);
+
+  if (!std::empty(stats.stop_reason))
+    fmt::print(stream, "\nPhase ended early: {}\n", stats.stop_reason);
+
   if (NUM_CPUS > 1) {
     fmt::print(stream, "\nTotal Simulation Statistics (not including warmup)\n");
 
@@ -107,6 +116,16 @@ void champsim::plain_printer::print(champsim::phase_stats& stats)
       print(stat);
   }
 
+  if (!std::empty(stats.samples)) {
+    fmt::print(stream, "\nSampled Statistics ({} windows)\n", std::size(stats.samples));
+    for (std::size_t cpu = 0; cpu < std::size(stats.samples.front().cpu_ipc); ++cpu) {
+      std::vector<double> ipc;
+      std::transform(std::begin(stats.samples), std::end(stats.samples), std::back_inserter(ipc), [cpu](const auto& s) { return s.cpu_ipc.at(cpu); });
+      auto estimate = estimate_mean(ipc);
+      fmt::print(stream, "CPU {} sampled IPC: {:.4g} +/- {:.4g} (95% confidence)\n", cpu, estimate.mean, estimate.half_width);
+    }
+  }
+
   fmt::print(stream, "\nRegion of Interest Statistics\n");
 
   for (const auto& stat : stats.roi_cpu_stats)
@@ -118,10 +137,31 @@ void champsim::plain_printer::print(champsim::phase_stats& stats)
   fmt::print(stream, "\nDRAM Statistics\n");
   for (const auto& stat : stats.roi_dram_stats)
     print(stat);
+
+  if (!std::empty(stats.profile)) {
+    const auto& total = stats.profile.front();
+    fmt::print(stream, "\nHost Profile ({:.3f} seconds)\n", total.seconds);
+    for (auto it = std::next(std::begin(stats.profile)); it != std::end(stats.profile); ++it) {
+      fmt::print(stream, "{:<32} CALLS: {:>12} SECONDS: {:>10.3f} SHARE: {:5.1f}% TICKS PER CALL: {:.1f}\n", it->name, it->calls, it->seconds,
+                 100 * it->seconds / total.seconds, std::ceil(it->ticks) / std::ceil(it->calls));
+    }
+  }
 }
 
 void champsim::plain_printer::print(std::vector<phase_stats>& stats)
 {
   for (auto p : stats)
     print(p);
+
+  if (std::any_of(std::begin(stats), std::end(stats), [](const auto& phase) { return phase.weight > 0; })) {
+    auto aggregate = weighted_mean(stats);
+
+    fmt::print(stream, "\n=== Weighted aggregate ===\n");
+    for (std::size_t cpu = 0; cpu < std::size(aggregate.cpu_ipc); ++cpu)
+      fmt::print(stream, "CPU {} weighted IPC: {:.4g}\n", cpu, aggregate.cpu_ipc.at(cpu));
+    for (const auto& [name, mpki] : aggregate.cache_mpki)
+      fmt::print(stream, "{} weighted MPKI: {:.4g}\n", name, mpki);
+    for (const auto& [name, apki] : aggregate.dram_apki)
+      fmt::print(stream, "{} weighted APKI: {:.4g}\n", name, apki);
+  }
 }
@@ -16,10 +16,12 @@
 
 #include "ptw.h"
 
+#include <algorithm>
 #include <numeric>
 
 #include "champsim.h"
 #include "champsim_constants.h"
+#include "checkpoint.h"
 #include "deadlock.h"
 #include "instruction.h"
 #include "util/span.h"
@@ -158,6 +160,28 @@ long PageTableWalker::operate()
   return progress;
 }
 
+uint64_t PageTableWalker::next_event_cycle() const
+{
+  if (!std::empty(lower_level->returned))
+    return current_cycle;
+  if (std::any_of(std::begin(upper_levels), std::end(upper_levels), [](const auto ul) { return !std::empty(ul->RQ); }))
+    return current_cycle;
+
+  uint64_t next_event = std::numeric_limits<uint64_t>::max();
+  if (!std::empty(completed))
+    next_event = std::min(next_event, completed.front().event_cycle);
+  if (!std::empty(finished))
+    next_event = std::min(next_event, finished.front().event_cycle);
+
+  return std::max(next_event, current_cycle);
+}
+
+std::size_t PageTableWalker::input_occupancy() const
+{
+  return std::accumulate(std::begin(upper_levels), std::end(upper_levels), std::size(lower_level->returned),
+                         [](std::size_t acc, const auto* ul) { return acc + ul->rq_occupancy(); });
+}
+
 void PageTableWalker::finish_packet(const response_type& packet)
 {
   auto finish_step = [this](auto& mshr_entry) {
@@ -197,6 +221,25 @@ void PageTableWalker::finish_packet(const response_type& packet)
   MSHR.erase(std::begin(MSHR), last_finished);
 }
 
+std::vector<uint64_t> PageTableWalker::warm_walk(uint32_t cpu, uint64_t v_address)
+{
+  pscl_entry walk = {v_address, CR3_addr, std::size(pscl)};
+  for (auto& table : pscl) {
+    if (auto hit = table.check_hit(walk); hit.has_value())
+      walk = *hit;
+  }
+
+  // As in handle_read() and handle_fill(), the first read is offset into the table, and each later read is the address of the entry itself
+  std::vector<uint64_t> reads{champsim::splice_bits(walk.ptw_addr, vmem->get_offset(v_address, walk.level) * PTE_BYTES, LOG2_PAGE_SIZE)};
+  for (auto level = walk.level; level > 0; --level) {
+    auto next = vmem->get_pte_pa(cpu, v_address, level).first;
+    pscl.at(std::size(pscl) - level).fill({v_address, next, level - 1});
+    reads.push_back(next);
+  }
+
+  return reads;
+}
+
 void PageTableWalker::begin_phase()
 {
   for (auto ul : upper_levels) {
@@ -206,6 +249,38 @@ void PageTableWalker::begin_phase()
   }
 }
 
+void PageTableWalker::save_checkpoint(std::ostream& stream)
+{
+  for (const auto& table : pscl)
+    champsim::checkpoint::save(stream, table);
+}
+
+void PageTableWalker::load_checkpoint(std::istream& stream)
+{
+  for (auto& table : pscl)
+    champsim::checkpoint::load(stream, table);
+}
+
+std::vector<std::pair<std::string, champsim::profiler::region>> PageTableWalker::profile() const { return {{NAME, operate_profile}}; }
+
+void PageTableWalker::clear_inflight()
+{
+  MSHR.clear();
+  finished.clear();
+  completed.clear();
+  for (auto ul : upper_levels)
+    ul->clear();
+}
+
+void PageTableWalker::save_inflight(std::ostream& stream)
+{
+  for (const auto* queue : {&MSHR, &finished, &completed}) {
+    champsim::checkpoint::save(stream, std::size(*queue));
+    for (const auto& entry : *queue)
+      champsim::checkpoint::save(stream, std::tie(entry.address, entry.v_address, entry.translation_level, entry.event_cycle));
+  }
+}
+
 // LCOV_EXCL_START Exclude the following function from LCOV
 void PageTableWalker::print_deadlock()
 {
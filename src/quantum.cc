@@ -0,0 +1,258 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "quantum.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <utility>
+
+#include <fmt/core.h>
+#include <fmt/ostream.h>
+#include <nlohmann/json.hpp>
+
+namespace
+{
+// Each link that an operable issues requests through, and reads responses from
+std::vector<std::pair<const champsim::operable*, champsim::channel**>> producer_links(champsim::environment& env)
+{
+  std::vector<std::pair<const champsim::operable*, champsim::channel**>> links;
+  for (O3_CPU& cpu : env.cpu_view()) {
+    links.emplace_back(&cpu, &cpu.L1I_bus.lower_level);
+    links.emplace_back(&cpu, &cpu.L1D_bus.lower_level);
+  }
+  for (CACHE& cache : env.cache_view()) {
+    links.emplace_back(&cache, &cache.lower_level);
+    if (cache.lower_translate != nullptr)
+      links.emplace_back(&cache, &cache.lower_translate);
+  }
+  for (PageTableWalker& ptw : env.ptw_view())
+    links.emplace_back(&ptw, &ptw.lower_level);
+  return links;
+}
+
+// The operable that consumes the requests of each channel
+std::map<const champsim::channel*, const champsim::operable*> consumers(champsim::environment& env)
+{
+  std::map<const champsim::channel*, const champsim::operable*> result;
+  for (CACHE& cache : env.cache_view()) {
+    for (auto ul : cache.upper_levels)
+      result.emplace(ul, &cache);
+  }
+  for (PageTableWalker& ptw : env.ptw_view()) {
+    for (auto ul : ptw.upper_levels)
+      result.emplace(ul, &ptw);
+  }
+  auto& dram = env.dram_view();
+  for (auto ul : dram.queues)
+    result.emplace(ul, &dram);
+  return result;
+}
+
+template <typename Q>
+long move_packets(Q& from, Q& to, std::size_t limit)
+{
+  long moved{0};
+  for (; !std::empty(from) && std::size(to) < limit; ++moved) {
+    to.push_back(std::move(from.front()));
+    from.pop_front();
+  }
+  return moved;
+}
+} // namespace
+
+std::vector<champsim::slice> champsim::partition_slices(environment& env)
+{
+  auto cpus = env.cpu_view();
+  const auto shared_idx = std::size(cpus);
+
+  std::map<const channel*, const operable*> producers;
+  for (auto [op, link] : producer_links(env))
+    producers.emplace(*link, op);
+
+  std::map<const operable*, std::size_t> owner;
+  for (std::size_t i = 0; i < std::size(cpus); ++i)
+    owner.emplace(&cpus[i].get(), i);
+
+  // A cache or page table walker belongs to a core if everything that issues to it does
+  auto private_owner = [&](const std::vector<channel*>& upper_levels) {
+    std::optional<std::size_t> result;
+    for (auto ul : upper_levels) {
+      auto producer = producers.find(ul);
+      if (producer == std::end(producers))
+        return std::optional<std::size_t>{};
+      auto found = owner.find(producer->second);
+      if (found == std::end(owner) || (result.has_value() && result.value() != found->second))
+        return std::optional<std::size_t>{};
+      result = found->second;
+    }
+    return result;
+  };
+
+  bool changed;
+  do {
+    changed = false;
+    for (CACHE& cache : env.cache_view()) {
+      if (auto idx = private_owner(cache.upper_levels); owner.count(&cache) == 0 && idx.has_value()) {
+        owner.emplace(&cache, idx.value());
+        changed = true;
+      }
+    }
+    for (PageTableWalker& ptw : env.ptw_view()) {
+      if (auto idx = private_owner(ptw.upper_levels); owner.count(&ptw) == 0 && idx.has_value()) {
+        owner.emplace(&ptw, idx.value());
+        changed = true;
+      }
+    }
+  } while (changed);
+
+  std::vector<slice> slices(shared_idx + 1);
+  for (O3_CPU& cpu : cpus)
+    slices.at(owner.at(&cpu)).cpus.push_back(cpu);
+  for (operable& op : env.operable_view()) {
+    auto found = owner.find(&op);
+    slices.at(found == std::end(owner) ? shared_idx : found->second).operables.push_back(op);
+  }
+
+  return slices;
+}
+
+champsim::slice_boundary::slice_boundary(environment& env, const std::vector<slice>& slices)
+{
+  std::map<const operable*, std::size_t> owner;
+  for (std::size_t i = 0; i < std::size(slices); ++i) {
+    for (const operable& op : slices[i].operables)
+      owner.emplace(&op, i);
+  }
+
+  auto consumer_of = consumers(env);
+  for (auto [op, link] : producer_links(env)) {
+    auto consumer = consumer_of.find(*link);
+    if (consumer != std::end(consumer_of) && owner.at(consumer->second) != owner.at(op)) {
+      auto& cross = crossings.emplace_back(crossing{*link, link, channel{**link}});
+      cross.staged.RQ.clear();
+      cross.staged.WQ.clear();
+      cross.staged.PQ.clear();
+      cross.staged.returned.clear();
+      *link = &cross.staged;
+    }
+  }
+}
+
+champsim::slice_boundary::~slice_boundary()
+{
+  for (auto& cross : crossings) {
+    // Anything still staged is delivered regardless of room, and responses waiting on either side return to the producer in order
+    move_packets(cross.staged.RQ, cross.shared->RQ, std::numeric_limits<std::size_t>::max());
+    move_packets(cross.staged.WQ, cross.shared->WQ, std::numeric_limits<std::size_t>::max());
+    move_packets(cross.staged.PQ, cross.shared->PQ, std::numeric_limits<std::size_t>::max());
+    move_packets(cross.shared->returned, cross.staged.returned, std::numeric_limits<std::size_t>::max());
+    cross.shared->returned.swap(cross.staged.returned);
+    *cross.producer_link = cross.shared;
+  }
+}
+
+long champsim::slice_boundary::exchange()
+{
+  long moved{0};
+  for (auto& cross : crossings) {
+    moved += move_packets(cross.staged.RQ, cross.shared->RQ, cross.shared->rq_size());
+    moved += move_packets(cross.staged.WQ, cross.shared->WQ, cross.shared->wq_size());
+    moved += move_packets(cross.staged.PQ, cross.shared->PQ, cross.shared->pq_size());
+    moved += move_packets(cross.shared->returned, cross.staged.returned, std::numeric_limits<std::size_t>::max());
+  }
+  return moved;
+}
+
+std::size_t champsim::slice_boundary::size() const { return std::size(crossings); }
+
+champsim::quantum_barrier::quantum_barrier(std::size_t count, std::function<void()> on_completion) : expected(count), completion(std::move(on_completion)) {}
+
+void champsim::quantum_barrier::arrive_and_wait()
+{
+  std::unique_lock lock{mutex};
+  if (++arrived == expected) {
+    completion();
+    arrived = 0;
+    ++generation;
+    released.notify_all();
+  } else {
+    released.wait(lock, [this, gen = generation] { return gen != generation; });
+  }
+}
+
+std::vector<champsim::phase_summary> champsim::summarize(const std::vector<phase_stats>& stats)
+{
+  std::vector<phase_summary> result;
+  for (const auto& phase : stats) {
+    auto& summary = result.emplace_back();
+    summary.name = phase.name;
+    std::transform(std::begin(phase.roi_cpu_stats), std::end(phase.roi_cpu_stats), std::back_inserter(summary.cpu_ipc),
+                   [](const auto& cpu) { return std::ceil(cpu.instrs()) / std::ceil(cpu.cycles()); });
+    std::transform(std::begin(phase.roi_cache_stats), std::end(phase.roi_cache_stats), std::back_inserter(summary.cache_misses), [](const auto& cache) {
+      auto total = std::accumulate(std::begin(cache.misses), std::end(cache.misses), uint64_t{0},
+                                   [](uint64_t acc, const auto& per_cpu) { return std::accumulate(std::begin(per_cpu), std::end(per_cpu), acc); });
+      return std::pair{cache.name, total};
+    });
+  }
+  return result;
+}
+
+std::string champsim::serialize(const std::vector<phase_summary>& summaries)
+{
+  auto result = nlohmann::json::array();
+  for (const auto& summary : summaries)
+    result.push_back(nlohmann::json{{"name", summary.name}, {"cpu_ipc", summary.cpu_ipc}, {"cache_misses", summary.cache_misses}});
+  return result.dump();
+}
+
+std::vector<champsim::phase_summary> champsim::deserialize(const std::string& data)
+{
+  std::vector<phase_summary> result;
+  for (const auto& entry : nlohmann::json::parse(data)) {
+    auto& summary = result.emplace_back();
+    entry.at("name").get_to(summary.name);
+    entry.at("cpu_ipc").get_to(summary.cpu_ipc);
+    entry.at("cache_misses").get_to(summary.cache_misses);
+  }
+  return result;
+}
+
+void champsim::print_deviation(std::ostream& stream, uint64_t quantum, const std::vector<phase_summary>& parallel, const std::vector<phase_summary>& serial)
+{
+  auto deviation = [](double par, double ser) { return ser == 0 ? 0.0 : 100.0 * (par - ser) / ser; };
+
+  fmt::print(stream, "\nParallel deviation from the serial engine (quantum: {} ticks)\n", quantum);
+  for (std::size_t i = 0; i < std::min(std::size(parallel), std::size(serial)); ++i) {
+    const auto& par = parallel[i];
+    const auto& ser = serial[i];
+    for (std::size_t cpu = 0; cpu < std::min(std::size(par.cpu_ipc), std::size(ser.cpu_ipc)); ++cpu) {
+      fmt::print(stream, "{} CPU {} IPC parallel: {:.4g} serial: {:.4g} deviation: {:+.3f}%\n", par.name, cpu, par.cpu_ipc[cpu], ser.cpu_ipc[cpu],
+                 deviation(par.cpu_ipc[cpu], ser.cpu_ipc[cpu]));
+    }
+    for (std::size_t c = 0; c < std::min(std::size(par.cache_misses), std::size(ser.cache_misses)); ++c) {
+      auto [name, par_misses] = par.cache_misses[c];
+      auto ser_misses = ser.cache_misses[c].second;
+      fmt::print(stream, "{} {} MISSES parallel: {} serial: {} deviation: {:+.3f}%\n", par.name, name, par_misses, ser_misses,
+                 deviation(static_cast<double>(par_misses), static_cast<double>(ser_misses)));
+    }
+  }
+}
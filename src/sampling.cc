@@ -0,0 +1,130 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "sampling.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace
+{
+// Two-sided 95% critical values of Student's t-distribution, for 1 through 30 degrees of freedom
+constexpr std::array<double, 30> t_critical{{12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228, 2.201, 2.179, 2.160, 2.145, 2.131,
+                                             2.120,  2.110, 2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042}};
+
+double t_critical_value(std::size_t degrees_of_freedom)
+{
+  if (degrees_of_freedom <= std::size(t_critical))
+    return t_critical.at(degrees_of_freedom - 1);
+  if (degrees_of_freedom < 60)
+    return 2.021;
+  if (degrees_of_freedom < 120)
+    return 2.000;
+  return 1.960;
+}
+} // namespace
+
+champsim::sample_stats champsim::measure_sample(const phase_stats& window)
+{
+  sample_stats result;
+
+  auto instrs = std::accumulate(std::begin(window.roi_cpu_stats), std::end(window.roi_cpu_stats), uint64_t{0},
+                                [](uint64_t acc, const auto& cpu) { return acc + cpu.instrs(); });
+  auto per_kilo_instr = [instrs](uint64_t count) { return 1000.0 * std::ceil(count) / std::ceil(instrs); };
+
+  for (const auto& cpu : window.roi_cpu_stats)
+    result.cpu_ipc.push_back(std::ceil(cpu.instrs()) / std::ceil(cpu.cycles()));
+
+  for (const auto& cache : window.roi_cache_stats) {
+    auto misses = std::accumulate(std::begin(cache.misses), std::end(cache.misses), uint64_t{0},
+                                  [](uint64_t acc, const auto& per_cpu) { return std::accumulate(std::begin(per_cpu), std::end(per_cpu), acc); });
+    result.cache_mpki.emplace_back(cache.name, per_kilo_instr(misses));
+  }
+
+  for (const auto& chan : window.roi_dram_stats) {
+    auto accesses = uint64_t{chan.RQ_ROW_BUFFER_HIT} + chan.RQ_ROW_BUFFER_MISS + chan.WQ_ROW_BUFFER_HIT + chan.WQ_ROW_BUFFER_MISS;
+    result.dram_apki.emplace_back(chan.name, per_kilo_instr(accesses));
+  }
+
+  return result;
+}
+
+champsim::sample_stats champsim::weighted_mean(const std::vector<phase_stats>& regions)
+{
+  sample_stats result;
+  double total_weight = 0;
+  for (const auto& region : regions) {
+    if (region.weight <= 0)
+      continue;
+
+    auto measured = measure_sample(region);
+    if (total_weight == 0) {
+      result = measured;
+      std::fill(std::begin(result.cpu_ipc), std::end(result.cpu_ipc), 0.0);
+      for (auto& x : result.cache_mpki)
+        x.second = 0;
+      for (auto& x : result.dram_apki)
+        x.second = 0;
+    }
+    total_weight += region.weight;
+
+    // Accumulate the weighted CPI, to be inverted at the end
+    for (std::size_t i = 0; i < std::size(result.cpu_ipc); ++i)
+      result.cpu_ipc.at(i) += region.weight / measured.cpu_ipc.at(i);
+    for (std::size_t i = 0; i < std::size(result.cache_mpki); ++i)
+      result.cache_mpki.at(i).second += region.weight * measured.cache_mpki.at(i).second;
+    for (std::size_t i = 0; i < std::size(result.dram_apki); ++i)
+      result.dram_apki.at(i).second += region.weight * measured.dram_apki.at(i).second;
+  }
+
+  for (auto& x : result.cpu_ipc)
+    x = total_weight / x;
+  for (auto& x : result.cache_mpki)
+    x.second /= total_weight;
+  for (auto& x : result.dram_apki)
+    x.second /= total_weight;
+
+  return result;
+}
+
+bool champsim::has_converged(const std::deque<double>& history, std::size_t intervals, double tolerance)
+{
+  if (intervals == 0 || std::size(history) < intervals + 1)
+    return false;
+
+  auto [min, max] = std::minmax_element(std::prev(std::end(history), static_cast<long>(intervals + 1)), std::end(history));
+  return (*max - *min) <= tolerance * std::abs(history.back());
+}
+
+champsim::sample_estimate champsim::estimate_mean(const std::vector<double>& values)
+{
+  sample_estimate result{std::size(values), std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN()};
+  if (result.count == 0)
+    return result;
+
+  result.mean = std::accumulate(std::begin(values), std::end(values), 0.0) / static_cast<double>(result.count);
+  if (result.count < 2)
+    return result;
+
+  auto sum_sq = std::accumulate(std::begin(values), std::end(values), 0.0, [mean = result.mean](double acc, double x) { return acc + (x - mean) * (x - mean); });
+  auto std_dev = std::sqrt(sum_sq / static_cast<double>(result.count - 1));
+  result.half_width = t_critical_value(result.count - 1) * std_dev / std::sqrt(static_cast<double>(result.count));
+  return result;
+}
@@ -0,0 +1,508 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "seek_index.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <filesystem>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+#include <fmt/core.h>
+#include <lzma.h>
+#include <zlib.h>
+
+namespace
+{
+constexpr std::size_t chunk_size = 1 << 16;
+constexpr std::size_t window_size = 1 << 15; // The largest distance that a deflate block may refer back
+constexpr std::array<char, 4> magic{'C', 'S', 'S', 'I'};
+constexpr uint32_t version = 1;
+
+template <typename T>
+void put(std::ostream& stream, T value)
+{
+  static_assert(std::is_trivially_copyable_v<T>);
+  stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T get(std::istream& stream)
+{
+  static_assert(std::is_trivially_copyable_v<T>);
+  T value{};
+  stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+  if (!stream)
+    throw std::runtime_error("the seek index is truncated");
+  return value;
+}
+
+std::size_t fill(std::istream& src, std::array<unsigned char, chunk_size>& buffer)
+{
+  src.read(reinterpret_cast<char*>(std::data(buffer)), std::size(buffer));
+  return static_cast<std::size_t>(src.gcount());
+}
+
+uint64_t stream_size(std::istream& stream)
+{
+  stream.clear();
+  stream.seekg(0, std::ios::end);
+  auto size = static_cast<uint64_t>(stream.tellg());
+  stream.seekg(0);
+  return size;
+}
+
+bool ends_with(const std::string& name, const std::string& suffix)
+{
+  return std::size(name) >= std::size(suffix) && name.compare(std::size(name) - std::size(suffix), std::size(suffix), suffix) == 0;
+}
+} // namespace
+
+std::string champsim::seek_index::sidecar_name(const std::string& trace_name) { return trace_name + ".idx"; }
+
+auto champsim::seek_index::build_gzip(std::istream& compressed, uint64_t span) -> index
+{
+  index result{format::gzip, stream_size(compressed), {}};
+
+  z_stream strm{};
+  if (::inflateInit2(&strm, 15 + 32) != Z_OK)
+    throw std::runtime_error("could not start inflating");
+
+  std::array<unsigned char, chunk_size> input;
+  std::array<unsigned char, window_size> window{};
+  uint64_t total_in = 0;
+  uint64_t total_out = 0;
+  int ret = Z_OK;
+
+  try {
+    while (true) {
+      strm.avail_in = static_cast<unsigned>(fill(compressed, input));
+      strm.next_in = std::data(input);
+      if (strm.avail_in == 0)
+        break;
+
+      while (strm.avail_in != 0) {
+        if (strm.avail_out == 0) {
+          strm.avail_out = static_cast<unsigned>(std::size(window));
+          strm.next_out = std::data(window);
+        }
+
+        total_in += strm.avail_in;
+        total_out += strm.avail_out;
+        ret = ::inflate(&strm, Z_BLOCK);
+        total_in -= strm.avail_in;
+        total_out -= strm.avail_out;
+
+        if (ret == Z_NEED_DICT || ret == Z_DATA_ERROR || ret == Z_MEM_ERROR)
+          throw std::runtime_error(fmt::format("the trace is not valid gzip at byte {}", total_in));
+
+        // Another member may follow
+        if (ret == Z_STREAM_END) {
+          ::inflateReset(&strm);
+          continue;
+        }
+
+        // A point may be placed at the start of any block except after the last one
+        bool at_block_start = (strm.data_type & 128) != 0 && (strm.data_type & 64) == 0;
+        if (at_block_start && (std::empty(result.points) || total_out - result.points.back().inflated_offset >= span)) {
+          // The window is circular. Its oldest byte is just past the last byte written.
+          auto written = std::size(window) - strm.avail_out;
+          std::array<unsigned char, window_size> ordered;
+          auto mid = std::next(std::begin(window), static_cast<long>(written));
+          std::rotate_copy(std::begin(window), mid, std::end(window), std::begin(ordered));
+
+          restart_point point{total_out, total_in, static_cast<uint8_t>(strm.data_type & 7)};
+          point.window.resize(::compressBound(std::size(ordered)));
+          auto packed_size = static_cast<uLongf>(std::size(point.window));
+          ::compress2(std::data(point.window), &packed_size, std::data(ordered), std::size(ordered), Z_BEST_COMPRESSION);
+          point.window.resize(packed_size);
+          result.points.push_back(std::move(point));
+        }
+      }
+    }
+  } catch (...) {
+    ::inflateEnd(&strm);
+    throw;
+  }
+
+  ::inflateEnd(&strm);
+  return result;
+}
+
+auto champsim::seek_index::build_xz(std::istream& compressed) -> index
+{
+  index result{format::xz, stream_size(compressed), {}};
+
+  // The index of each stream is at its end, so the decoder asks to seek to it
+  lzma_stream strm = LZMA_STREAM_INIT;
+  lzma_index* found = nullptr;
+  if (::lzma_file_info_decoder(&strm, &found, UINT64_MAX, result.compressed_size) != LZMA_OK)
+    throw std::runtime_error("could not start reading the xz index");
+
+  std::array<unsigned char, chunk_size> input;
+  lzma_ret ret = LZMA_OK;
+  while (ret != LZMA_STREAM_END) {
+    if (strm.avail_in == 0) {
+      strm.avail_in = fill(compressed, input);
+      strm.next_in = std::data(input);
+    }
+
+    ret = ::lzma_code(&strm, LZMA_RUN);
+    if (ret == LZMA_SEEK_NEEDED) {
+      compressed.clear();
+      compressed.seekg(static_cast<std::streamoff>(strm.seek_pos));
+      strm.avail_in = 0;
+    } else if (ret != LZMA_OK && ret != LZMA_STREAM_END) {
+      ::lzma_end(&strm);
+      throw std::runtime_error("the trace is not valid xz");
+    }
+  }
+  ::lzma_end(&strm);
+
+  lzma_index_iter iter;
+  ::lzma_index_iter_init(&iter, found);
+  while (!::lzma_index_iter_next(&iter, LZMA_INDEX_ITER_BLOCK)) {
+    auto check = (iter.stream.flags != nullptr) ? iter.stream.flags->check : LZMA_CHECK_NONE;
+    result.points.push_back({iter.block.uncompressed_file_offset, iter.block.compressed_file_offset, 0, static_cast<uint8_t>(check)});
+  }
+  ::lzma_index_end(found, nullptr);
+
+  return result;
+}
+
+void champsim::seek_index::write(std::ostream& stream, const index& idx)
+{
+  stream.write(std::data(magic), std::size(magic));
+  put(stream, version);
+  put(stream, idx.fmt);
+  put(stream, idx.compressed_size);
+  put(stream, uint64_t{std::size(idx.points)});
+  for (const auto& point : idx.points) {
+    put(stream, point.inflated_offset);
+    put(stream, point.compressed_offset);
+    put(stream, point.bits);
+    put(stream, point.check);
+    put(stream, static_cast<uint32_t>(std::size(point.window)));
+    stream.write(reinterpret_cast<const char*>(std::data(point.window)), static_cast<std::streamsize>(std::size(point.window)));
+  }
+}
+
+auto champsim::seek_index::read(std::istream& stream) -> index
+{
+  std::array<char, std::size(magic)> found_magic{};
+  stream.read(std::data(found_magic), std::size(found_magic));
+  if (!stream || found_magic != magic)
+    throw std::runtime_error("the file is not a seek index");
+  if (auto found_version = get<uint32_t>(stream); found_version != version)
+    throw std::runtime_error(fmt::format("the seek index has version {}, but version {} is expected", found_version, version));
+
+  index result{get<format>(stream), get<uint64_t>(stream), {}};
+  if (result.fmt != format::gzip && result.fmt != format::xz)
+    throw std::runtime_error("the seek index is for an unknown format");
+
+  auto count = get<uint64_t>(stream);
+  for (uint64_t i = 0; i < count; ++i) {
+    restart_point point{get<uint64_t>(stream), get<uint64_t>(stream)};
+    point.bits = get<uint8_t>(stream);
+    point.check = get<uint8_t>(stream);
+    point.window.resize(get<uint32_t>(stream));
+    stream.read(reinterpret_cast<char*>(std::data(point.window)), static_cast<std::streamsize>(std::size(point.window)));
+    if (!stream)
+      throw std::runtime_error("the seek index is truncated");
+    result.points.push_back(std::move(point));
+  }
+
+  return result;
+}
+
+auto champsim::seek_index::load_sidecar(const std::string& trace_name) -> std::optional<index>
+{
+  std::ifstream sidecar{sidecar_name(trace_name), std::ios::binary};
+  if (!sidecar.is_open())
+    return std::nullopt;
+
+  try {
+    auto result = read(sidecar);
+    if (std::error_code ec; result.compressed_size == std::filesystem::file_size(trace_name, ec))
+      return result;
+    fmt::print("WARNING: the seek index {} does not match its trace, and is not used\n", sidecar_name(trace_name));
+  } catch (const std::runtime_error& err) {
+    fmt::print("WARNING: {}: {}\n", sidecar_name(trace_name), err.what());
+  }
+  return std::nullopt;
+}
+
+class champsim::seek_index::istream::decoder
+{
+public:
+  virtual ~decoder() = default;
+
+  // Inflate up to size bytes into out. Returns the number of bytes inflated, which is zero at the end of the trace.
+  virtual std::size_t inflate(char* out, std::size_t size) = 0;
+};
+
+namespace
+{
+using champsim::seek_index::restart_point;
+
+class gzip_decoder final : public champsim::seek_index::istream::decoder
+{
+  std::istream& src;
+  std::array<unsigned char, chunk_size> input;
+  z_stream strm{};
+  bool raw; // A point starts in the middle of the deflate data of a member, without its header
+
+public:
+  gzip_decoder(std::istream& s, const restart_point* point) : src(s), raw(point != nullptr)
+  {
+    src.clear();
+    if (point == nullptr) {
+      src.seekg(0);
+      if (::inflateInit2(&strm, 15 + 32) != Z_OK)
+        throw std::runtime_error("could not start inflating");
+      return;
+    }
+
+    if (::inflateInit2(&strm, -15) != Z_OK)
+      throw std::runtime_error("could not start inflating");
+    src.seekg(static_cast<std::streamoff>(point->compressed_offset - (point->bits != 0 ? 1 : 0)));
+    if (point->bits != 0) {
+      auto partial = src.get();
+      ::inflatePrime(&strm, point->bits, partial >> (8 - point->bits));
+    }
+
+    std::array<unsigned char, window_size> window;
+    auto window_length = static_cast<uLongf>(std::size(window));
+    if (::uncompress(std::data(window), &window_length, std::data(point->window), static_cast<uLong>(std::size(point->window))) != Z_OK) {
+      ::inflateEnd(&strm);
+      throw std::runtime_error("the seek index holds a damaged window");
+    }
+    ::inflateSetDictionary(&strm, std::data(window), static_cast<uInt>(window_length));
+  }
+
+  ~gzip_decoder() override { ::inflateEnd(&strm); }
+
+  bool refill()
+  {
+    strm.avail_in = static_cast<unsigned>(fill(src, input));
+    strm.next_in = std::data(input);
+    return strm.avail_in > 0;
+  }
+
+  std::size_t inflate(char* out, std::size_t size) override
+  {
+    strm.next_out = reinterpret_cast<unsigned char*>(out);
+    strm.avail_out = static_cast<unsigned>(size);
+    while (strm.avail_out > 0) {
+      if (strm.avail_in == 0 && !refill())
+        break;
+
+      auto ret = ::inflate(&strm, Z_NO_FLUSH);
+      if (ret == Z_STREAM_END) {
+        // Another member may follow. Raw inflation does not read the trailer of its member, so it is passed over here.
+        if (raw) {
+          for (auto trailer = 8u; trailer > 0;) {
+            if (strm.avail_in == 0 && !refill())
+              return size - strm.avail_out;
+            auto passed = std::min(trailer, strm.avail_in);
+            strm.next_in += passed;
+            strm.avail_in -= passed;
+            trailer -= passed;
+          }
+          ::inflateReset2(&strm, 15 + 32);
+          raw = false;
+        } else {
+          ::inflateReset(&strm);
+        }
+      } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+        throw std::runtime_error("the trace is not valid gzip");
+      }
+    }
+    return size - strm.avail_out;
+  }
+};
+
+class xz_decoder final : public champsim::seek_index::istream::decoder
+{
+  std::istream& src;
+  std::array<unsigned char, chunk_size> input;
+  lzma_stream strm = LZMA_STREAM_INIT;
+
+  // From a point, the blocks are inflated one at a time, each from the point that starts it
+  const std::vector<restart_point>* blocks = nullptr;
+  std::size_t next_block = 0;
+  lzma_block block{};
+  std::array<lzma_filter, LZMA_FILTERS_MAX + 1> filters{};
+  bool finished = false;
+
+  void free_filters()
+  {
+    for (auto& filter : filters) {
+      std::free(filter.options);
+      filter = lzma_filter{LZMA_VLI_UNKNOWN, nullptr};
+    }
+  }
+
+  void start_block()
+  {
+    free_filters();
+    if (next_block >= std::size(*blocks)) {
+      finished = true;
+      return;
+    }
+
+    src.clear();
+    src.seekg(static_cast<std::streamoff>(blocks->at(next_block).compressed_offset));
+    strm.avail_in = 0;
+
+    std::array<uint8_t, LZMA_BLOCK_HEADER_SIZE_MAX> header;
+    header[0] = static_cast<uint8_t>(src.get());
+    block = lzma_block{};
+    block.version = 1;
+    block.check = static_cast<lzma_check>(blocks->at(next_block).check);
+    block.filters = std::data(filters);
+    block.header_size = lzma_block_header_size_decode(header[0]);
+    src.read(reinterpret_cast<char*>(std::data(header) + 1), static_cast<std::streamsize>(block.header_size - 1));
+
+    if (header[0] == 0x00 || !src || ::lzma_block_header_decode(&block, nullptr, std::data(header)) != LZMA_OK
+        || ::lzma_block_decoder(&strm, &block) != LZMA_OK)
+      throw std::runtime_error("the seek index does not point to an xz block");
+    ++next_block;
+  }
+
+public:
+  xz_decoder(std::istream& s, const std::vector<restart_point>& points, const restart_point* point) : src(s)
+  {
+    if (point == nullptr) {
+      src.clear();
+      src.seekg(0);
+      if (::lzma_stream_decoder(&strm, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK)
+        throw std::runtime_error("could not start inflating");
+      return;
+    }
+
+    blocks = &points;
+    next_block = static_cast<std::size_t>(point - std::data(points));
+    start_block();
+  }
+
+  ~xz_decoder() override
+  {
+    ::lzma_end(&strm);
+    free_filters();
+  }
+
+  std::size_t inflate(char* out, std::size_t size) override
+  {
+    strm.next_out = reinterpret_cast<uint8_t*>(out);
+    strm.avail_out = size;
+    while (strm.avail_out > 0 && !finished) {
+      auto action = LZMA_RUN;
+      if (strm.avail_in == 0) {
+        strm.avail_in = fill(src, input);
+        strm.next_in = std::data(input);
+        if (strm.avail_in == 0)
+          action = LZMA_FINISH;
+      }
+
+      auto ret = ::lzma_code(&strm, action);
+      if (ret == LZMA_STREAM_END) {
+        if (blocks != nullptr)
+          start_block();
+        else
+          finished = true;
+      } else if (ret == LZMA_BUF_ERROR) {
+        finished = true; // The trace is truncated
+      } else if (ret != LZMA_OK) {
+        throw std::runtime_error("the trace is not valid xz");
+      }
+    }
+    return size - strm.avail_out;
+  }
+};
+} // namespace
+
+champsim::seek_index::istream::istream(const std::string& trace_name)
+    : src(std::make_unique<std::ifstream>(trace_name, std::ios::binary)),
+      idx(load_sidecar(trace_name).value_or(index{ends_with(trace_name, "xz") ? format::xz : format::gzip, 0, {}}))
+{
+}
+
+champsim::seek_index::istream::istream(std::unique_ptr<std::istream> compressed, index i) : src(std::move(compressed)), idx(std::move(i)) {}
+
+champsim::seek_index::istream::istream(istream&&) noexcept = default;
+auto champsim::seek_index::istream::operator=(istream&&) noexcept -> istream& = default;
+champsim::seek_index::istream::~istream() = default;
+
+auto champsim::seek_index::istream::read(char* s, std::streamsize count) -> istream&
+{
+  if (inflater == nullptr) {
+    if (idx.fmt == format::xz)
+      inflater = std::make_unique<xz_decoder>(*src, idx.points, nullptr);
+    else
+      inflater = std::make_unique<gzip_decoder>(*src, nullptr);
+  }
+
+  std::streamsize total = 0;
+  while (total < count) {
+    auto inflated = inflater->inflate(s + total, static_cast<std::size_t>(count - total));
+    if (inflated == 0)
+      break;
+    total += static_cast<std::streamsize>(inflated);
+  }
+
+  gcount_ = total;
+  position += static_cast<uint64_t>(total);
+  eof_ = (total < count);
+  return *this;
+}
+
+auto champsim::seek_index::istream::ignore(std::streamsize count) -> istream&
+{
+  auto target = position + static_cast<uint64_t>(count);
+
+  // Start again from the last point at or before the target, if it is ahead of the current position
+  std::streamsize jumped = 0;
+  auto found = std::upper_bound(std::begin(idx.points), std::end(idx.points), target,
+                                [](uint64_t t, const restart_point& p) { return t < p.inflated_offset; });
+  if (found != std::begin(idx.points) && std::prev(found)->inflated_offset > position) {
+    auto start = &*std::prev(found);
+    if (idx.fmt == format::xz)
+      inflater = std::make_unique<xz_decoder>(*src, idx.points, start);
+    else
+      inflater = std::make_unique<gzip_decoder>(*src, start);
+    jumped = static_cast<std::streamsize>(start->inflated_offset - position);
+    position = start->inflated_offset;
+  }
+
+  std::array<char, chunk_size> discarded;
+  std::streamsize total = 0;
+  while (position < target) {
+    auto step = static_cast<std::streamsize>(std::min<uint64_t>(std::size(discarded), target - position));
+    read(std::data(discarded), step);
+    total += gcount_;
+    if (eof_)
+      break;
+  }
+
+  gcount_ = jumped + total;
+  eof_ = (position < target);
+  return *this;
+}
@@ -0,0 +1,396 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "shared_trace.h"
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <tuple>
+
+#include "decoded_cache.h"
+#include <fmt/core.h>
+#include <fmt/ranges.h>
+
+void champsim::shared_trace::loop::record(const ooo_model_instr& instr)
+{
+  if (overflowed)
+    return;
+
+  decoded_cache::append_record(bytes, instr);
+  if (std::size(bytes) > capacity) {
+    overflowed = true;
+    bytes = std::vector<char>{};
+  }
+}
+
+ooo_model_instr champsim::shared_trace::loop_reader::operator()()
+{
+  auto record = std::data(pass->data()) + offset;
+  offset += decoded_cache::record_size(record);
+  return decoded_cache::read_record(record, anonymous_cpu, true);
+}
+
+uint64_t champsim::shared_trace::loop_reader::skip(uint64_t count)
+{
+  uint64_t skipped = 0;
+  for (; skipped < count && !eof(); ++skipped)
+    offset += decoded_cache::record_size(std::data(pass->data()) + offset);
+  return skipped;
+}
+
+champsim::shared_trace::source::source(any_reader r, opener reopen_fn, std::string name, bool repeat_trace, std::size_t cap, std::size_t loop_cap)
+    : reader(std::move(r)), reopen(std::move(reopen_fn)), trace_name(std::move(name)), repeat(repeat_trace), capacity(cap)
+{
+  if (repeat && loop_cap > 0)
+    first_pass = std::make_shared<loop>(loop_cap);
+}
+
+bool champsim::shared_trace::source::joinable()
+{
+  std::lock_guard lock{mutex};
+  return end == 0;
+}
+
+std::size_t champsim::shared_trace::source::attach()
+{
+  std::lock_guard lock{mutex};
+  slots.emplace_back();
+  return std::size(slots) - 1;
+}
+
+void champsim::shared_trace::source::detach(std::size_t idx)
+{
+  std::lock_guard lock{mutex};
+  slots.at(idx).attached = false;
+  trim();
+}
+
+uint64_t champsim::shared_trace::source::min_other_position(std::size_t self) const
+{
+  auto result = std::numeric_limits<uint64_t>::max();
+  for (std::size_t i = 0; i < std::size(slots); ++i) {
+    if (i != self && slots[i].attached && !slots[i].evicted)
+      result = std::min(result, slots[i].position);
+  }
+  return result;
+}
+
+void champsim::shared_trace::source::trim()
+{
+  auto needed = min_other_position(std::size(slots));
+  while (!std::empty(chunks) && chunks.front().end() <= needed) {
+    held_bytes -= std::size(chunks.front().bytes);
+    chunks.pop_front();
+  }
+}
+
+void champsim::shared_trace::source::evict_slowest(std::size_t self)
+{
+  while (held_bytes > capacity) {
+    auto slowest = std::end(slots);
+    for (auto it = std::begin(slots); it != std::end(slots); ++it) {
+      if (std::distance(std::begin(slots), it) != static_cast<std::ptrdiff_t>(self) && it->attached && !it->evicted
+          && (slowest == std::end(slots) || it->position < slowest->position))
+        slowest = it;
+    }
+
+    if (slowest == std::end(slots))
+      return;
+
+    slowest->evicted = true;
+    trim();
+  }
+}
+
+ooo_model_instr champsim::shared_trace::source::read_next()
+{
+  auto instr = reader();
+  if (recording())
+    first_pass->record(instr);
+  return instr;
+}
+
+bool champsim::shared_trace::source::exhausted(uint64_t position)
+{
+  // A repeating trace is started over at its end, unless nothing was read since it last started. It is replayed from memory if its first pass was held.
+  if (repeat && reader.eof() && position > (std::empty(wraps) ? 0 : wraps.back())) {
+    wraps.push_back(position);
+    if (first_pass != nullptr && first_pass->holds())
+      reader = any_reader{loop_reader{first_pass}};
+    else
+      reader = reopen(anonymous_cpu, false);
+  }
+  return reader.eof();
+}
+
+void champsim::shared_trace::source::advance(uint64_t position)
+{
+  while (end < position && !exhausted(end)) {
+    // The first pass is held in full, so its instructions are read instead of skipped
+    if (recording()) {
+      (void)read_next();
+      ++end;
+      continue;
+    }
+
+    auto progress = reader.skip(position - end);
+    if (progress == 0)
+      break;
+    end += progress;
+  }
+}
+
+void champsim::shared_trace::source::read_chunk(std::size_t self)
+{
+  chunk next{end};
+  next.starts.push_back(0);
+  for (std::size_t i = 0; i < chunk_size && !exhausted(next.end()); ++i) {
+    decoded_cache::append_record(next.bytes, read_next());
+    next.starts.push_back(std::size(next.bytes));
+  }
+
+  if (std::size(next.starts) > 1) {
+    end = next.end();
+    held_bytes += std::size(next.bytes);
+    chunks.push_back(std::move(next));
+    evict_slowest(self);
+  }
+}
+
+bool champsim::shared_trace::source::reach(std::size_t self, uint64_t position)
+{
+  // Instructions that no cursor needs are skipped instead of read
+  if (position > end)
+    advance(std::min(position, min_other_position(self)));
+
+  while (position >= end && !exhausted(end))
+    read_chunk(self);
+  return position < end;
+}
+
+void champsim::shared_trace::source::take_wraps(slot& this_slot, uint64_t before, std::deque<uint64_t>& wrap_points) const
+{
+  for (; this_slot.next_wrap < std::size(wraps) && wraps[this_slot.next_wrap] < before; ++this_slot.next_wrap)
+    wrap_points.push_back(wraps[this_slot.next_wrap]);
+}
+
+auto champsim::shared_trace::source::fetch(std::size_t idx, uint64_t position, std::size_t max_count, std::deque<ooo_model_instr>& dest,
+                                           std::deque<uint64_t>& wrap_points) -> std::optional<std::size_t>
+{
+  std::vector<char> taken;
+  std::size_t count = 0;
+  {
+    std::lock_guard lock{mutex};
+    auto& this_slot = slots.at(idx);
+    if (this_slot.evicted)
+      return std::nullopt;
+
+    this_slot.position = position;
+    trim();
+
+    // A cursor that reads alone takes the instructions as they are read, without holding them
+    if (min_other_position(idx) == std::numeric_limits<uint64_t>::max() && std::empty(chunks)) {
+      advance(position);
+      for (; position + count == end && count < max_count && !exhausted(end); ++count, ++end)
+        dest.push_back(read_next());
+      this_slot.position = position + count;
+      take_wraps(this_slot, position + count, wrap_points);
+      return count;
+    }
+
+    if (!reach(idx, position))
+      return 0;
+
+    auto found = std::prev(std::upper_bound(std::begin(chunks), std::end(chunks), position, [](uint64_t p, const chunk& c) { return p < c.first; }));
+    auto first = static_cast<std::size_t>(position - found->first);
+    count = static_cast<std::size_t>(std::min<uint64_t>(max_count, found->end() - position));
+    taken.assign(std::next(std::begin(found->bytes), static_cast<std::ptrdiff_t>(found->starts.at(first))),
+                 std::next(std::begin(found->bytes), static_cast<std::ptrdiff_t>(found->starts.at(first + count))));
+    this_slot.position = position + count;
+    take_wraps(this_slot, position + count, wrap_points);
+  }
+
+  // Each cursor decodes its own copy, outside of the lock
+  for (auto it = std::data(taken), end_it = std::data(taken) + std::size(taken); it != end_it; it += decoded_cache::record_size(it))
+    dest.push_back(decoded_cache::read_record(it, anonymous_cpu, true));
+  return count;
+}
+
+std::optional<bool> champsim::shared_trace::source::eof_at(std::size_t idx, uint64_t position)
+{
+  std::lock_guard lock{mutex};
+  auto& this_slot = slots.at(idx);
+  if (this_slot.evicted)
+    return std::nullopt;
+
+  this_slot.position = position;
+  trim();
+
+  if (min_other_position(idx) == std::numeric_limits<uint64_t>::max() && std::empty(chunks)) {
+    advance(position);
+    return position != end || exhausted(end);
+  }
+
+  return !reach(idx, position);
+}
+
+auto champsim::shared_trace::source::open_private(std::size_t idx, uint8_t cpu, uint64_t position, std::deque<uint64_t>& wrap_points) -> any_reader
+{
+  std::lock_guard lock{mutex};
+  take_wraps(slots.at(idx), position + 1, wrap_points);
+
+  // The private reader repeats the trace on its own, from the last time that the shared reader started it over
+  auto later = std::upper_bound(std::begin(wraps), std::end(wraps), position);
+  auto start = (later == std::begin(wraps)) ? uint64_t{0} : *std::prev(later);
+  auto result = reopen(cpu, repeat);
+  result.skip(position - start);
+  return result;
+}
+
+champsim::shared_trace::reader::reader(std::shared_ptr<source> s, uint8_t cpu_idx) : src(std::move(s)), idx(src->attach()), cpu(cpu_idx) {}
+
+champsim::shared_trace::reader::reader(reader&& other) noexcept
+    : src(std::move(other.src)), idx(other.idx), cpu(other.cpu), position(other.position), instr_buffer(std::move(other.instr_buffer)),
+      wrap_points(std::move(other.wrap_points)), private_reader(std::move(other.private_reader))
+{
+}
+
+auto champsim::shared_trace::reader::operator=(reader&& other) noexcept -> reader&
+{
+  std::swap(src, other.src);
+  std::swap(idx, other.idx);
+  std::swap(cpu, other.cpu);
+  std::swap(position, other.position);
+  std::swap(instr_buffer, other.instr_buffer);
+  std::swap(wrap_points, other.wrap_points);
+  std::swap(private_reader, other.private_reader);
+  return *this;
+}
+
+champsim::shared_trace::reader::~reader()
+{
+  if (src != nullptr && !private_reader.has_value())
+    src->detach(idx);
+}
+
+ooo_model_instr champsim::shared_trace::reader::stamp(ooo_model_instr instr) const
+{
+  if (instr.asid == std::array<uint8_t, 2>{anonymous_cpu, anonymous_cpu})
+    instr.asid = {cpu, cpu};
+  return instr;
+}
+
+void champsim::shared_trace::reader::go_private() const
+{
+  private_reader = src->open_private(idx, cpu, position, wrap_points);
+  src->detach(idx);
+}
+
+ooo_model_instr champsim::shared_trace::reader::operator()()
+{
+  constexpr std::size_t batch_size = 256;
+  if (std::empty(instr_buffer) && !private_reader.has_value()) {
+    auto fetched = src->fetch(idx, position, batch_size, instr_buffer, wrap_points);
+    if (fetched.has_value())
+      position += *fetched;
+    else
+      go_private();
+  }
+
+  // Each core is told when it reaches the end of a repeating trace, as if it read the trace on its own
+  auto next_position = position - std::size(instr_buffer);
+  for (; !std::empty(wrap_points) && wrap_points.front() <= next_position; wrap_points.pop_front())
+    fmt::print("*** Reached end of trace: {}\n", std::tuple{cpu, src->name()});
+
+  if (!std::empty(instr_buffer)) {
+    auto retval = stamp(std::move(instr_buffer.front()));
+    instr_buffer.pop_front();
+    return retval;
+  }
+
+  if (private_reader.has_value()) {
+    ++position;
+    return stamp((*private_reader)());
+  }
+  return ooo_model_instr{cpu, input_instr{}};
+}
+
+uint64_t champsim::shared_trace::reader::skip(uint64_t count)
+{
+  uint64_t skipped = 0;
+  for (; skipped < count && !std::empty(instr_buffer); ++skipped)
+    instr_buffer.pop_front();
+
+  if (private_reader.has_value()) {
+    auto progress = private_reader->skip(count - skipped);
+    position += progress;
+    skipped += progress;
+  } else {
+    position += count - skipped;
+    skipped = count;
+  }
+  return skipped;
+}
+
+std::size_t champsim::shared_trace::reader::fill(std::vector<ooo_model_instr>& dest, std::size_t count)
+{
+  std::size_t filled = 0;
+  while (filled < count && !eof()) {
+    // The instructions that were taken from the source are moved out together, unless the end of a repeating trace must be reported among them
+    if (!std::empty(instr_buffer) && std::empty(wrap_points)) {
+      auto batch_end = std::next(std::begin(instr_buffer), static_cast<std::ptrdiff_t>(std::min(count - filled, std::size(instr_buffer))));
+      std::transform(std::make_move_iterator(std::begin(instr_buffer)), std::make_move_iterator(batch_end), std::back_inserter(dest),
+                     [this](ooo_model_instr instr) { return stamp(std::move(instr)); });
+      filled += static_cast<std::size_t>(std::distance(std::begin(instr_buffer), batch_end));
+      instr_buffer.erase(std::begin(instr_buffer), batch_end);
+    } else {
+      dest.push_back((*this)());
+      ++filled;
+    }
+  }
+  return filled;
+}
+
+bool champsim::shared_trace::reader::eof() const
+{
+  if (!std::empty(instr_buffer))
+    return false;
+
+  if (!private_reader.has_value()) {
+    auto result = src->eof_at(idx, position);
+    if (result.has_value())
+      return *result;
+    go_private();
+  }
+  return private_reader->eof();
+}
+
+auto champsim::shared_trace::find_or_open(const std::string& key, const std::function<std::shared_ptr<source>()>& create) -> std::shared_ptr<source>
+{
+  static std::mutex registry_mutex;
+  static std::map<std::string, std::weak_ptr<source>> registry;
+
+  std::lock_guard lock{registry_mutex};
+  auto& entry = registry[key];
+  if (auto found = entry.lock(); found != nullptr && found->joinable())
+    return found;
+
+  auto created = create();
+  entry = created;
+  return created;
+}
@@ -0,0 +1,81 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "simpoint.h"
+
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+#include <string>
+
+#include <fmt/core.h>
+
+std::vector<champsim::simpoint> champsim::read_simpoints(std::istream& simpoints, std::istream& weights)
+{
+  std::map<std::size_t, double> weight_of;
+  double weight = 0;
+  std::size_t cluster = 0;
+  while (weights >> weight >> cluster)
+    weight_of.insert_or_assign(cluster, weight);
+  if (!weights.eof())
+    throw std::runtime_error("SimPoint weights could not be read");
+
+  std::vector<simpoint> result;
+  uint64_t interval = 0;
+  while (simpoints >> interval >> cluster) {
+    auto found = weight_of.find(cluster);
+    if (found == std::end(weight_of))
+      throw std::runtime_error(fmt::format("SimPoint cluster {} has no weight", cluster));
+    result.push_back(simpoint{cluster, interval, found->second});
+  }
+  if (!simpoints.eof())
+    throw std::runtime_error("SimPoints could not be read");
+
+  return result;
+}
+
+std::vector<champsim::phase_info> champsim::simpoint_phases(std::vector<simpoint> regions, uint64_t interval_length, const phase_info& warmup,
+                                                            const phase_info& simulation)
+{
+  std::sort(std::begin(regions), std::end(regions), [](const simpoint& lhs, const simpoint& rhs) { return lhs.interval < rhs.interval; });
+
+  std::vector<phase_info> result;
+  uint64_t position = 0;
+  for (const auto& region : regions) {
+    auto begin = region.interval * interval_length;
+
+    // The warmup begins where it should, unless that is before the end of the previous region
+    auto warmup_begin = std::max(begin - std::min(begin, warmup.length), position);
+    if (warmup_begin < begin) {
+      auto& warm = result.emplace_back(warmup);
+      warm.name = fmt::format("SimPoint {} warmup", region.cluster);
+      warm.length = begin - warmup_begin;
+      warm.skip_to = warmup_begin;
+      warm.checkpoint_file.clear();
+    }
+
+    auto& sim = result.emplace_back(simulation);
+    sim.name = fmt::format("SimPoint {}", region.cluster);
+    sim.length = interval_length;
+    sim.skip_to = begin;
+    sim.weight = region.weight;
+
+    position = begin + interval_length;
+  }
+
+  return result;
+}
@@ -0,0 +1,173 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "state_hash.h"
+
+#include <algorithm>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <tuple>
+
+#include "cache.h"
+#include "checkpoint.h"
+#include "dram_controller.h"
+#include "ooo_cpu.h"
+#include "ptw.h"
+#include "vmem.h"
+#include <fmt/core.h>
+
+namespace
+{
+// A stream buffer that folds each byte written to it into a 64-bit FNV-1a hash, rather than storing it
+class hashing_buffer : public std::streambuf
+{
+  uint64_t value = 0xcbf29ce484222325;
+
+  void add(char c)
+  {
+    value ^= static_cast<unsigned char>(c);
+    value *= 0x100000001b3;
+  }
+
+protected:
+  int_type overflow(int_type ch) override
+  {
+    if (!traits_type::eq_int_type(ch, traits_type::eof()))
+      add(traits_type::to_char_type(ch));
+    return traits_type::not_eof(ch);
+  }
+
+  std::streamsize xsputn(const char* s, std::streamsize count) override
+  {
+    std::for_each(s, s + count, [this](char c) { add(c); });
+    return count;
+  }
+
+public:
+  uint64_t hash() const { return value; }
+};
+
+template <typename F>
+uint64_t hash_of(F&& func)
+{
+  hashing_buffer buffer;
+  std::ostream stream{&buffer};
+  func(stream);
+  return buffer.hash();
+}
+
+uint64_t hash_operable(champsim::operable& op)
+{
+  return hash_of([&op](std::ostream& stream) {
+    champsim::checkpoint::save(stream, op.current_cycle);
+    op.save_checkpoint(stream);
+    op.save_inflight(stream);
+  });
+}
+} // namespace
+
+std::vector<std::pair<std::string, uint64_t>> champsim::state_hash::hash_components(environment& env)
+{
+  std::vector<std::pair<std::string, uint64_t>> result;
+  for (O3_CPU& cpu : env.cpu_view())
+    result.emplace_back("CPU " + std::to_string(cpu.cpu), hash_operable(cpu));
+  for (CACHE& cache : env.cache_view())
+    result.emplace_back(cache.NAME, hash_operable(cache));
+  for (PageTableWalker& ptw : env.ptw_view())
+    result.emplace_back(ptw.NAME, hash_operable(ptw));
+  result.emplace_back("DRAM", hash_operable(env.dram_view()));
+
+  // Each virtual memory is shared by the page table walkers that use it
+  std::vector<VirtualMemory*> vmems;
+  for (PageTableWalker& ptw : env.ptw_view()) {
+    if (ptw.vmem != nullptr && std::find(std::begin(vmems), std::end(vmems), ptw.vmem) == std::end(vmems))
+      vmems.push_back(ptw.vmem);
+  }
+  for (std::size_t i = 0; i < std::size(vmems); ++i)
+    result.emplace_back(fmt::format("VMEM {}", i), hash_of([vmem = vmems.at(i)](std::ostream& stream) { vmem->save_checkpoint(stream); }));
+
+  return result;
+}
+
+void champsim::state_hash::write(std::ostream& log, std::string_view phase, uint64_t tick, environment& env)
+{
+  // Fields are separated by tabs, since the names of phases and components may hold spaces
+  for (const auto& [component, hash] : hash_components(env))
+    log << fmt::format("{}\t{}\t{}\t{:016x}\n", phase, tick, component, hash);
+  log.flush();
+}
+
+std::optional<champsim::state_hash::record> champsim::state_hash::read(std::istream& log)
+{
+  std::string line;
+  if (!std::getline(log, line))
+    return std::nullopt;
+
+  std::vector<std::string> fields;
+  std::istringstream line_stream{line};
+  for (std::string field; std::getline(line_stream, field, '\t');)
+    fields.push_back(field);
+  if (std::size(fields) != 4)
+    throw std::runtime_error("Malformed state hash record: " + line);
+
+  try {
+    return record{fields.at(0), std::stoull(fields.at(1)), fields.at(2), std::stoull(fields.at(3), nullptr, 16)};
+  } catch (const std::logic_error&) {
+    throw std::runtime_error("Malformed state hash record: " + line);
+  }
+}
+
+champsim::state_hash::comparison champsim::state_hash::compare(std::istream& reference, std::istream& actual)
+{
+  comparison result;
+  for (;;) {
+    auto expected = read(reference);
+    auto found = read(actual);
+    if (!expected.has_value() && !found.has_value())
+      return result;
+
+    if (!expected.has_value() || !found.has_value() || expected->phase != found->phase || expected->tick != found->tick
+        || expected->component != found->component || expected->hash != found->hash) {
+      result.reference = expected;
+      result.actual = found;
+      return result;
+    }
+
+    ++result.matched;
+  }
+}
+
+std::string champsim::state_hash::describe(const comparison& result)
+{
+  if (!result.diverged())
+    return fmt::format("State hashes match the reference ({} records)", result.matched);
+
+  const auto& [reference, actual] = std::tie(result.reference, result.actual);
+  if (!actual.has_value())
+    return fmt::format("State hashes ended before the reference, which continues at {} tick {} ({} records matched)", reference->phase, reference->tick,
+                       result.matched);
+  if (!reference.has_value())
+    return fmt::format("State hashes continue past the end of the reference, at {} tick {} ({} records matched)", actual->phase, actual->tick,
+                       result.matched);
+  if (reference->phase != actual->phase || reference->tick != actual->tick || reference->component != actual->component)
+    return fmt::format("State hashes were taken at {} tick {} in {}, but the reference was taken at {} tick {} in {} ({} records matched)", actual->phase,
+                       actual->tick, actual->component, reference->phase, reference->tick, reference->component, result.matched);
+  return fmt::format("State diverged from the reference at {} tick {} in {} ({} records matched)", actual->phase, actual->tick, actual->component,
+                     result.matched);
+}
@@ -16,15 +16,27 @@
 
 #include "tracereader.h"
 
+#include <filesystem>
 #include <fstream>
+#include <optional>
 #include <string>
 
+#include <fmt/core.h>
+
+#include "async_reader.h"
+#include "columnar_tracereader.h"
+#include "decoded_cache.h"
 #include "inf_stream.h"
+#include "mapped_tracereader.h"
+#include "parallel_gzip.h"
 #include "repeatable.h"
+#include "seek_index.h"
+#include "seekable_zstd.h"
+#include "shared_trace.h"
 
 namespace champsim
 {
-uint64_t tracereader::instr_unique_id = 0;
+std::atomic<uint64_t> tracereader::instr_unique_id = 0;
 
 ooo_model_instr apply_branch_target(ooo_model_instr branch, const ooo_model_instr& target)
 {
@@ -32,38 +44,151 @@ ooo_model_instr apply_branch_target(ooo_model_instr branch, const ooo_model_inst
   return branch;
 }
 
-template <template <class, class> typename R, typename T>
-champsim::tracereader get_tracereader_for_type(std::string fname, uint8_t cpu)
+struct reader_options {
+  std::size_t read_ahead = 0;
+  std::optional<decoded_cache::entry> cache{};
+};
+
+template <typename R>
+champsim::any_reader make_async_reader(R&& reader, std::size_t read_ahead)
+{
+  if (read_ahead > 0)
+    return champsim::any_reader{champsim::async_reader<R>{std::move(reader), read_ahead}};
+  return champsim::any_reader{std::move(reader)};
+}
+
+template <typename R>
+champsim::any_reader make_reader(R&& reader, uint8_t cpu, const reader_options& options)
+{
+  // Instructions are replayed from the decoded cache, or recorded into it, on the reading thread
+  if (options.cache.has_value() && options.cache->exists)
+    return make_async_reader(decoded_cache::replay_reader<R>{*options.cache, cpu, std::move(reader)}, options.read_ahead);
+  if (options.cache.has_value())
+    return make_async_reader(decoded_cache::recording_reader<R>{*options.cache, std::move(reader)}, options.read_ahead);
+  return make_async_reader(std::move(reader), options.read_ahead);
+}
+
+template <typename R>
+using repeated_reader_type = typename R::reader_type;
+
+// A reader over a stream that is already open. A repeating reader opens the trace again by name at its end.
+template <typename R, typename S>
+R reader_over(S&& stream, uint8_t cpu, std::string fname)
+{
+  if constexpr (champsim::is_detected_v<repeated_reader_type, R>)
+    return R{repeated_reader_type<R>{cpu, std::move(stream)}, cpu, fname};
+  else
+    return R{cpu, std::move(stream)};
+}
+
+// Traces in the columnar format are recognized by their header, and hold their own kind of record. The stream is opened once, and the header is read
+// back by either reader.
+template <template <class, class> typename R, template <class> typename C, typename T, typename S>
+champsim::any_reader open_stream(std::string fname, uint8_t cpu, const reader_options& options)
+{
+  using stream_type = champsim::columnar::peeked_stream<S>;
+  stream_type stream{fname};
+  if (stream.has_header())
+    return make_reader(reader_over<C<stream_type>>(std::move(stream), cpu, fname), cpu, options);
+  return make_reader(reader_over<R<T, stream_type>>(std::move(stream), cpu, fname), cpu, options);
+}
+
+template <template <class, class> typename R, template <class> typename M, template <class> typename C, typename T>
+champsim::any_reader get_reader_for_type(std::string fname, uint8_t cpu, const reader_options& options)
 {
   bool is_gzip_compressed = (fname.substr(std::size(fname) - 2) == "gz");
   bool is_lzma_compressed = (fname.substr(std::size(fname) - 2) == "xz");
   bool is_bzip2_compressed = (fname.substr(std::size(fname) - 3) == "bz2");
+  bool is_zstd_compressed = (fname.substr(std::size(fname) - 3) == "zst");
 
-  if (is_gzip_compressed)
-    return champsim::tracereader{R<T, champsim::inf_istream<champsim::decomp_tags::gzip_tag_t<>>>(cpu, fname)};
+  // A trace with a seek index can start inflating near the target of a skip
+  if ((is_gzip_compressed || is_lzma_compressed) && std::filesystem::exists(champsim::seek_index::sidecar_name(fname)))
+    return open_stream<R, C, T, champsim::seek_index::istream>(fname, cpu, options);
+
+  // The members of a gzip trace are inflated on several threads when it is mapped into memory
+  if (is_gzip_compressed && champsim::inflate_threads > 1 && std::filesystem::is_regular_file(fname))
+    return open_stream<R, C, T, champsim::parallel_gzip::istream>(fname, cpu, options);
+  else if (is_gzip_compressed)
+    return open_stream<R, C, T, champsim::inf_istream<champsim::decomp_tags::gzip_tag_t<>>>(fname, cpu, options);
   else if (is_lzma_compressed)
-    return champsim::tracereader{R<T, champsim::inf_istream<champsim::decomp_tags::lzma_tag_t<>>>(cpu, fname)};
+    return open_stream<R, C, T, champsim::inf_istream<champsim::decomp_tags::lzma_tag_t<>>>(fname, cpu, options);
   else if (is_bzip2_compressed)
-    return champsim::tracereader{R<T, champsim::inf_istream<champsim::decomp_tags::bzip2_tag_t>>(cpu, fname)};
+    return open_stream<R, C, T, champsim::inf_istream<champsim::decomp_tags::bzip2_tag_t>>(fname, cpu, options);
+  else if (is_zstd_compressed)
+    return open_stream<R, C, T, champsim::seekable_zstd::istream<>>(fname, cpu, options);
+  else if (std::filesystem::is_regular_file(fname) && !champsim::columnar::has_header(std::ifstream{fname}))
+    return make_reader(M<T>(cpu, fname), cpu, options);
   else
-    return champsim::tracereader{R<T, std::ifstream>(cpu, fname)};
+    return open_stream<R, C, T, std::ifstream>(fname, cpu, options);
 }
 } // namespace champsim
 
 template <typename T, typename S>
 using repeatable_reader_t = champsim::repeatable<champsim::bulk_tracereader<T, S>, uint8_t, std::string>;
 
-champsim::tracereader get_tracereader(std::string fname, uint8_t cpu, bool is_cloudsuite, bool repeat)
+template <typename T>
+using repeatable_mapped_reader_t = champsim::repeatable<champsim::mapped_tracereader<T>, uint8_t, std::string>;
+
+template <typename S>
+using repeatable_columnar_reader_t = champsim::repeatable<champsim::columnar_tracereader<S>, uint8_t, std::string>;
+
+namespace
+{
+champsim::any_reader open_reader(std::string fname, uint8_t cpu, bool is_cloudsuite, bool repeat, const champsim::reader_options& options)
 {
   if (is_cloudsuite) {
     if (repeat)
-      return champsim::get_tracereader_for_type<repeatable_reader_t, cloudsuite_instr>(fname, cpu);
+      return champsim::get_reader_for_type<repeatable_reader_t, repeatable_mapped_reader_t, repeatable_columnar_reader_t, cloudsuite_instr>(
+          fname, cpu, options);
     else
-      return champsim::get_tracereader_for_type<champsim::bulk_tracereader, cloudsuite_instr>(fname, cpu);
+      return champsim::get_reader_for_type<champsim::bulk_tracereader, champsim::mapped_tracereader, champsim::columnar_tracereader, cloudsuite_instr>(
+          fname, cpu, options);
   } else {
     if (repeat)
-      return champsim::get_tracereader_for_type<repeatable_reader_t, input_instr>(fname, cpu);
+      return champsim::get_reader_for_type<repeatable_reader_t, repeatable_mapped_reader_t, repeatable_columnar_reader_t, input_instr>(fname, cpu, options);
     else
-      return champsim::get_tracereader_for_type<champsim::bulk_tracereader, input_instr>(fname, cpu);
+      return champsim::get_reader_for_type<champsim::bulk_tracereader, champsim::mapped_tracereader, champsim::columnar_tracereader, input_instr>(
+          fname, cpu, options);
   }
 }
+} // namespace
+
+champsim::tracereader get_tracereader(std::string fname, uint8_t cpu, bool is_cloudsuite, bool repeat, std::size_t read_ahead,
+                                      const std::string& decoded_cache_dir, std::size_t loop_memory)
+{
+  using cache_entry = std::optional<champsim::decoded_cache::entry>;
+  auto open = [=](const cache_entry& cache, uint8_t reader_cpu, bool reader_repeat, bool record) {
+    champsim::reader_options options{read_ahead};
+
+    // A repeating reader starts over past the end of the cache, so only the readers that do not repeat use it. The shared reader's first pass does not
+    // repeat, and it is the one that records.
+    if (cache.has_value() && !reader_repeat) {
+      options.cache = cache;
+      options.cache->exists = options.cache->exists || champsim::decoded_cache::published(*cache);
+    }
+
+    // A trace that is opened again replays the cache, but does not record it again
+    if (!record && options.cache.has_value() && !options.cache->exists)
+      options.cache.reset();
+
+    return open_reader(fname, reader_cpu, is_cloudsuite, reader_repeat, options);
+  };
+
+  // Cores that read the same trace share one reader of it, which is opened with the first of them. The shared reader starts a repeating trace over
+  // itself, so that each core can be told when it reaches the end, and so that its later passes can be replayed from memory.
+  auto key = fmt::format("{}\n{}\n{}", fname, is_cloudsuite, repeat);
+  auto source = champsim::shared_trace::find_or_open(key, [=] {
+    // The trace is hashed once, to name its cache. The readers that are opened again find what the first one recorded.
+    cache_entry cache{};
+    if (!std::empty(decoded_cache_dir)) {
+      cache = champsim::decoded_cache::find(decoded_cache_dir, fname, is_cloudsuite);
+      if (!cache.has_value())
+        fmt::print("WARNING: the decoded instructions of {} are not cached, since the trace cannot be read as a file\n", fname);
+    }
+
+    auto reopen = [open, cache](uint8_t reader_cpu, bool reader_repeat) { return open(cache, reader_cpu, reader_repeat, false); };
+    return std::make_shared<champsim::shared_trace::source>(open(cache, champsim::shared_trace::anonymous_cpu, false, true), reopen, fname, repeat,
+                                                            champsim::shared_trace::default_capacity, loop_memory);
+  });
+  return champsim::tracereader{champsim::shared_trace::reader{source, cpu}};
+}
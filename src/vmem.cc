@@ -17,20 +17,25 @@
 #include "vmem.h"
 
 #include <cassert>
+#include <numeric>
 
 #include "champsim.h"
 #include "champsim_constants.h"
+#include "checkpoint.h"
 #include "dram_controller.h"
 #include <fmt/core.h>
 
 VirtualMemory::VirtualMemory(uint64_t page_table_page_size, std::size_t page_table_levels, uint64_t minor_penalty, MEMORY_CONTROLLER& dram)
-    : next_ppage(VMEM_RESERVE_CAPACITY), last_ppage(1ull << (LOG2_PAGE_SIZE + champsim::lg2(page_table_page_size / PTE_BYTES) * page_table_levels)),
+    : last_ppage(1ull << (LOG2_PAGE_SIZE + champsim::lg2(page_table_page_size / PTE_BYTES) * page_table_levels)),
       minor_fault_penalty(minor_penalty), pt_levels(page_table_levels), pte_page_size(page_table_page_size)
 {
   assert(page_table_page_size > 1024);
   assert(page_table_page_size == (1ull << champsim::lg2(page_table_page_size)));
   assert(last_ppage > VMEM_RESERVE_CAPACITY);
 
+  for (std::size_t cpu = 0; cpu < std::size(next_ppage); ++cpu)
+    next_ppage[cpu] = VMEM_RESERVE_CAPACITY + cpu * PAGE_SIZE;
+
   auto required_bits = champsim::lg2(last_ppage);
   if (required_bits > 64)
     fmt::print("WARNING: virtual memory configuration would require {} bits of addressing.\n", required_bits); // LCOV_EXCL_LINE
@@ -45,23 +50,29 @@ uint64_t VirtualMemory::get_offset(uint64_t vaddr, std::size_t level) const
   return (vaddr >> shamt(level)) & champsim::bitmask(champsim::lg2(pte_page_size / PTE_BYTES));
 }
 
-uint64_t VirtualMemory::ppage_front() const
+uint64_t VirtualMemory::ppage_front(uint32_t cpu_num) const
 {
-  assert(available_ppages() > 0);
-  return next_ppage;
+  assert(next_ppage.at(cpu_num) < last_ppage);
+  return next_ppage.at(cpu_num);
 }
 
-void VirtualMemory::ppage_pop() { next_ppage += PAGE_SIZE; }
+void VirtualMemory::ppage_pop(uint32_t cpu_num) { next_ppage.at(cpu_num) += PAGE_SIZE * NUM_CPUS; }
 
-std::size_t VirtualMemory::available_ppages() const { return (last_ppage - next_ppage) / PAGE_SIZE; }
+std::size_t VirtualMemory::available_ppages() const
+{
+  constexpr auto stride = PAGE_SIZE * NUM_CPUS;
+  return std::accumulate(std::begin(next_ppage), std::end(next_ppage), std::size_t{0},
+                         [last = last_ppage](std::size_t sum, uint64_t next) { return sum + (next < last ? (last - next + stride - 1) / stride : 0); });
+}
 
 std::pair<uint64_t, uint64_t> VirtualMemory::va_to_pa(uint32_t cpu_num, uint64_t vaddr)
 {
-  auto [ppage, fault] = vpage_to_ppage_map.insert({{cpu_num, vaddr >> LOG2_PAGE_SIZE}, ppage_front()});
+  std::lock_guard lock{allocation_mutex};
+  auto [ppage, fault] = vpage_to_ppage_map.insert({{cpu_num, vaddr >> LOG2_PAGE_SIZE}, ppage_front(cpu_num)});
 
   // this vpage doesn't yet have a ppage mapping
   if (fault)
-    ppage_pop();
+    ppage_pop(cpu_num);
 
   auto paddr = champsim::splice_bits(ppage->second, vaddr, LOG2_PAGE_SIZE);
   if constexpr (champsim::debug_print) {
@@ -73,20 +84,22 @@ std::pair<uint64_t, uint64_t> VirtualMemory::va_to_pa(uint32_t cpu_num, uint64_t
 
 std::pair<uint64_t, uint64_t> VirtualMemory::get_pte_pa(uint32_t cpu_num, uint64_t vaddr, std::size_t level)
 {
-  if (next_pte_page == 0) {
-    next_pte_page = ppage_front();
-    ppage_pop();
+  std::lock_guard lock{allocation_mutex};
+  auto& next_pte = next_pte_page.at(cpu_num);
+  if (next_pte == 0) {
+    next_pte = ppage_front(cpu_num);
+    ppage_pop(cpu_num);
   }
 
   std::tuple key{cpu_num, vaddr >> shamt(level), level};
-  auto [ppage, fault] = page_table.insert({key, next_pte_page});
+  auto [ppage, fault] = page_table.insert({key, next_pte});
 
   // this PTE doesn't yet have a mapping
   if (fault) {
-    next_pte_page += pte_page_size;
-    if (!(next_pte_page % PAGE_SIZE)) {
-      next_pte_page = ppage_front();
-      ppage_pop();
+    next_pte += pte_page_size;
+    if (!(next_pte % PAGE_SIZE)) {
+      next_pte = ppage_front(cpu_num);
+      ppage_pop(cpu_num);
     }
   }
 
@@ -98,3 +111,16 @@ std::pair<uint64_t, uint64_t> VirtualMemory::get_pte_pa(uint32_t cpu_num, uint64
 
   return {paddr, fault ? minor_fault_penalty : 0};
 }
+
+void VirtualMemory::save_checkpoint(std::ostream& stream)
+{
+  std::lock_guard lock{allocation_mutex};
+  champsim::checkpoint::save(stream, std::tie(vpage_to_ppage_map, page_table, next_pte_page, next_ppage));
+}
+
+void VirtualMemory::load_checkpoint(std::istream& stream)
+{
+  std::lock_guard lock{allocation_mutex};
+  auto fields = std::tie(vpage_to_ppage_map, page_table, next_pte_page, next_ppage);
+  champsim::checkpoint::load(stream, fields);
+}
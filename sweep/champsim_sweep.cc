@@ -0,0 +1,398 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * A driver for sweeps of ChampSim simulations over a matrix of executables, traces, and instruction counts. Jobs run on a local pool of workers, each
+ * pinned to a core. Each worker runs its own queue of jobs, longest expected first, and steals from the others when its queue runs out. The results of
+ * each job are kept, so that an interrupted sweep resumes where it stopped, and are merged into one indexed results file.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <CLI/CLI.hpp>
+#include <fmt/core.h>
+#include <fmt/ranges.h>
+#include <nlohmann/json.hpp>
+
+namespace
+{
+struct job {
+  std::string executable;
+  double executable_cost = 1;
+  std::vector<std::string> traces;
+  uint64_t warmup_instructions = 0;
+  uint64_t simulation_instructions = 0;
+  std::vector<std::string> options;
+
+  // A description of the job that does not change when the matrix is reordered or extended
+  std::string key() const
+  {
+    return fmt::format("{} | {} | {} {} | {}", executable, fmt::join(traces, " "), warmup_instructions, simulation_instructions, fmt::join(options, " "));
+  }
+
+  // Jobs are expected to take time in proportion to the instructions they simulate on each core
+  double expected_cost() const { return executable_cost * std::ceil(warmup_instructions + simulation_instructions) * std::ceil(std::size(traces)); }
+
+  // The name of the files that hold the results of the job in the output directory
+  std::string stem() const
+  {
+    uint64_t hash = 0xcbf29ce484222325;
+    for (auto c : key())
+      hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+    return fmt::format("{:016x}", hash);
+  }
+};
+
+template <typename T>
+std::vector<T> one_or_many(const nlohmann::json& value)
+{
+  if (value.is_array())
+    return value.get<std::vector<T>>();
+  return {value.get<T>()};
+}
+
+/*
+ * The matrix is a JSON object. Each job runs one of the "executables" on one of the "traces", for each of the "warmup_instructions" and
+ * "simulation_instructions". An executable may be given as an object with a "path" and a relative "cost". A trace may be given as a list, with one
+ * trace for each core. The "options" are passed to every job.
+ */
+std::vector<job> read_matrix(std::istream& file)
+{
+  auto matrix = nlohmann::json::parse(file);
+
+  std::vector<std::pair<std::string, double>> executables;
+  for (const auto& exe : matrix.at("executables")) {
+    if (exe.is_object())
+      executables.emplace_back(exe.at("path").get<std::string>(), exe.value("cost", 1.0));
+    else
+      executables.emplace_back(exe.get<std::string>(), 1.0);
+  }
+
+  std::vector<std::vector<std::string>> trace_mixes;
+  for (const auto& mix : matrix.at("traces"))
+    trace_mixes.push_back(one_or_many<std::string>(mix));
+
+  auto warmups = one_or_many<uint64_t>(matrix.value("warmup_instructions", nlohmann::json(0)));
+  auto simulations = one_or_many<uint64_t>(matrix.at("simulation_instructions"));
+  auto options = matrix.value("options", std::vector<std::string>{});
+
+  // A job that appears twice in the matrix is run once, since its results would share a file
+  std::vector<job> result;
+  auto add = [&result](job j) {
+    if (std::none_of(std::begin(result), std::end(result), [key = j.key()](const job& x) { return x.key() == key; }))
+      result.push_back(std::move(j));
+  };
+  for (const auto& [exe, cost] : executables) {
+    for (const auto& mix : trace_mixes) {
+      for (auto warmup : warmups) {
+        for (auto simulation : simulations)
+          add(job{exe, cost, mix, warmup, simulation, options});
+      }
+    }
+  }
+  return result;
+}
+
+struct outcome {
+  std::string status = "not run";
+  double seconds = 0;
+};
+
+// A job is complete if it left its results and a record of its success
+std::optional<outcome> previous_outcome(const std::string& directory, const job& j)
+{
+  std::ifstream meta_file{directory + "/" + j.stem() + ".meta.json"};
+  std::ifstream result_file{directory + "/" + j.stem() + ".json"};
+  if (!meta_file.is_open() || !result_file.is_open())
+    return std::nullopt;
+
+  try {
+    auto meta = nlohmann::json::parse(meta_file);
+    if (meta.at("key") != j.key() || meta.at("status") != "complete" || !nlohmann::json::accept(result_file))
+      return std::nullopt;
+    return outcome{"complete", meta.at("seconds").get<double>()};
+  } catch (const nlohmann::json::exception&) {
+    return std::nullopt;
+  }
+}
+
+// Run the job in a child process, pinned to the given core if there is one. Its output goes to a log, and its JSON results are moved into place only
+// once it has succeeded.
+outcome run_job(const std::string& directory, const job& j, std::optional<int> core)
+{
+  auto base = directory + "/" + j.stem();
+  auto partial = base + ".json.part";
+  auto log = base + ".log";
+
+  std::vector<std::string> args{j.executable, "--warmup-instructions", std::to_string(j.warmup_instructions), "--simulation-instructions",
+                                std::to_string(j.simulation_instructions)};
+  args.insert(std::end(args), std::begin(j.options), std::end(j.options));
+  args.insert(std::end(args), {"--json", partial});
+  args.insert(std::end(args), std::begin(j.traces), std::end(j.traces));
+
+  std::vector<char*> argv;
+  std::transform(std::begin(args), std::end(args), std::back_inserter(argv), [](std::string& arg) { return std::data(arg); });
+  argv.push_back(nullptr);
+
+  cpu_set_t affinity;
+  CPU_ZERO(&affinity);
+  if (core.has_value())
+    CPU_SET(*core, &affinity);
+
+  auto begin = std::chrono::steady_clock::now();
+  auto pid = fork();
+  if (pid == 0) {
+    // Only async-signal-safe calls may be made between fork() and exec() in a threaded process
+    auto log_fd = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (log_fd >= 0) {
+      dup2(log_fd, STDOUT_FILENO);
+      dup2(log_fd, STDERR_FILENO);
+      close(log_fd);
+    }
+    if (core.has_value())
+      sched_setaffinity(0, sizeof(affinity), &affinity);
+    execv(argv.front(), std::data(argv));
+    _exit(127);
+  }
+
+  int status{0};
+  bool succeeded = (pid > 0) && waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+  outcome result{succeeded ? "complete" : "failed", seconds};
+  if (succeeded && std::rename(partial.c_str(), (base + ".json").c_str()) != 0)
+    result.status = "failed";
+
+  std::ofstream meta{base + ".meta.json"};
+  meta << nlohmann::json{{"key", j.key()}, {"status", result.status}, {"seconds", result.seconds}} << std::endl;
+  return result;
+}
+
+// Each worker owns a queue. It takes its own jobs from the front, where the longest are, and steals from the back of the queue with the most work left.
+struct worker_queue {
+  std::mutex lock;
+  std::deque<std::size_t> jobs;
+  double remaining_cost = 0;
+};
+
+class pool
+{
+  const std::vector<job>& jobs;
+  std::vector<worker_queue> queues;
+
+  std::optional<std::size_t> take(std::size_t self)
+  {
+    auto pop = [this](worker_queue& queue, bool front) -> std::optional<std::size_t> {
+      std::lock_guard guard{queue.lock};
+      if (std::empty(queue.jobs))
+        return std::nullopt;
+      auto idx = front ? queue.jobs.front() : queue.jobs.back();
+      if (front)
+        queue.jobs.pop_front();
+      else
+        queue.jobs.pop_back();
+      queue.remaining_cost -= jobs.at(idx).expected_cost();
+      return idx;
+    };
+
+    if (auto idx = pop(queues.at(self), true); idx.has_value())
+      return idx;
+
+    for (;;) {
+      std::optional<std::size_t> victim;
+      double most = 0;
+      for (std::size_t i = 0; i < std::size(queues); ++i) {
+        std::lock_guard guard{queues.at(i).lock};
+        if (!std::empty(queues.at(i).jobs) && (!victim.has_value() || queues.at(i).remaining_cost > most)) {
+          victim = i;
+          most = queues.at(i).remaining_cost;
+        }
+      }
+      if (!victim.has_value())
+        return std::nullopt;
+      if (auto idx = pop(queues.at(*victim), false); idx.has_value())
+        return idx;
+    }
+  }
+
+public:
+  pool(const std::vector<job>& jobs_, const std::vector<std::size_t>& pending, std::size_t workers) : jobs(jobs_), queues(workers)
+  {
+    // Longest expected first, each to the worker with the least work so far
+    auto order = pending;
+    std::stable_sort(std::begin(order), std::end(order),
+                     [this](auto lhs, auto rhs) { return jobs.at(lhs).expected_cost() > jobs.at(rhs).expected_cost(); });
+    for (auto idx : order) {
+      auto least = std::min_element(std::begin(queues), std::end(queues),
+                                    [](const auto& lhs, const auto& rhs) { return lhs.remaining_cost < rhs.remaining_cost; });
+      least->jobs.push_back(idx);
+      least->remaining_cost += jobs.at(idx).expected_cost();
+    }
+  }
+
+  template <typename F>
+  void run(F&& func)
+  {
+    std::vector<std::thread> threads;
+    for (std::size_t self = 0; self < std::size(queues); ++self) {
+      threads.emplace_back([this, self, &func] {
+        for (auto idx = take(self); idx.has_value(); idx = take(self))
+          func(self, *idx);
+      });
+    }
+    std::for_each(std::begin(threads), std::end(threads), [](std::thread& t) { t.join(); });
+  }
+};
+
+// The cores that this process may run on
+std::vector<int> allowed_cores()
+{
+  cpu_set_t affinity;
+  CPU_ZERO(&affinity);
+  std::vector<int> result;
+  if (sched_getaffinity(0, sizeof(affinity), &affinity) == 0) {
+    for (int core = 0; core < CPU_SETSIZE; ++core) {
+      if (CPU_ISSET(core, &affinity))
+        result.push_back(core);
+    }
+  }
+  return result;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  CLI::App app{"Run a sweep of ChampSim simulations on a local pool of workers"};
+
+  std::string matrix_name;
+  std::string directory = "sweep_results";
+  std::string results_name;
+  std::size_t workers = std::max(1u, std::thread::hardware_concurrency());
+  bool no_pin{false};
+  bool dry_run{false};
+
+  app.add_option("matrix", matrix_name, "A JSON file describing the executables, traces, and instruction counts to sweep")
+      ->required()
+      ->check(CLI::ExistingFile);
+  app.add_option("-o,--output-dir", directory, "The directory to hold the results and log of each job. Jobs with results here are not run again.")
+      ->capture_default_str();
+  app.add_option("--results", results_name, "The name of the merged results file. By default, it is results.json in the output directory");
+  app.add_option("-j,--jobs", workers, "The number of jobs to run at once")->check(CLI::PositiveNumber)->capture_default_str();
+  app.add_flag("--no-pin", no_pin, "Do not pin each worker to a core");
+  app.add_flag("-n,--dry-run", dry_run, "Print the jobs that would be run, without running them");
+
+  CLI11_PARSE(app, argc, argv);
+
+  if (std::empty(results_name))
+    results_name = directory + "/results.json";
+
+  std::ifstream matrix_file{matrix_name};
+  auto jobs = read_matrix(matrix_file);
+
+  if (!dry_run && mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+    fmt::print(stderr, "Could not create the output directory {}\n", directory);
+    return 1;
+  }
+
+  // Jobs that completed in a previous sweep are not run again
+  std::vector<outcome> outcomes(std::size(jobs));
+  std::vector<std::size_t> pending;
+  for (std::size_t i = 0; i < std::size(jobs); ++i) {
+    if (auto previous = previous_outcome(directory, jobs.at(i)); previous.has_value())
+      outcomes.at(i) = *previous;
+    else
+      pending.push_back(i);
+  }
+  fmt::print("Jobs: {} ({} complete, {} to run)\n", std::size(jobs), std::size(jobs) - std::size(pending), std::size(pending));
+
+  if (dry_run) {
+    for (auto idx : pending)
+      fmt::print("{}\n", jobs.at(idx).key());
+    return 0;
+  }
+
+  auto cores = allowed_cores();
+  workers = std::min(workers, std::max<std::size_t>(std::size(pending), 1));
+  std::mutex print_lock;
+  std::size_t finished{0};
+  auto begin = std::chrono::steady_clock::now();
+  pool{jobs, pending, workers}.run([&](std::size_t worker, std::size_t idx) {
+    std::optional<int> core;
+    if (!no_pin && !std::empty(cores))
+      core = cores.at(worker % std::size(cores));
+
+    auto result = run_job(directory, jobs.at(idx), core);
+
+    std::lock_guard guard{print_lock};
+    outcomes.at(idx) = result;
+    fmt::print("[{}/{}] {} {} ({:.1f} s)\n", ++finished, std::size(pending), result.status, jobs.at(idx).key(), result.seconds);
+    std::fflush(stdout);
+  });
+  fmt::print("Sweep finished in {:.1f} s\n", std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count());
+
+  // The merged results hold every job of the matrix in order, and are indexed by the key of each job
+  nlohmann::json merged{{"index", nlohmann::json::object()}, {"jobs", nlohmann::json::array()}};
+  std::size_t failed{0};
+  for (std::size_t i = 0; i < std::size(jobs); ++i) {
+    const auto& j = jobs.at(i);
+    nlohmann::json entry{{"key", j.key()},
+                         {"executable", j.executable},
+                         {"traces", j.traces},
+                         {"warmup_instructions", j.warmup_instructions},
+                         {"simulation_instructions", j.simulation_instructions},
+                         {"options", j.options},
+                         {"status", outcomes.at(i).status},
+                         {"seconds", outcomes.at(i).seconds},
+                         {"log", directory + "/" + j.stem() + ".log"}};
+    if (outcomes.at(i).status == "complete") {
+      std::ifstream result_file{directory + "/" + j.stem() + ".json"};
+      entry["stats"] = nlohmann::json::parse(result_file);
+    } else {
+      ++failed;
+    }
+    merged["index"][j.key()] = i;
+    merged["jobs"].push_back(entry);
+  }
+
+  std::ofstream results_file{results_name};
+  results_file << merged.dump(2) << std::endl;
+  fmt::print("Results of {} jobs written to {}\n", std::size(jobs) - failed, results_name);
+  if (failed > 0)
+    fmt::print("{} jobs failed. Run the sweep again to retry them.\n", failed);
+
+  return failed > 0 ? 1 : 0;
+}
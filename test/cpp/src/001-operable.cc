@@ -1,4 +1,5 @@
 #include <catch.hpp>
+#include "clock_calendar.h"
 #include "operable.h"
 
 namespace {
@@ -6,15 +7,22 @@ struct mock_operable : champsim::operable {
   using operable::operable;
   long operate() final { return 1; }
 };
+
+void run_ticks(champsim::clock_calendar& calendar, int num_ticks) {
+  for (int i = 0; i < num_ticks; ++i) {
+    for (champsim::operable& op : calendar.next_tick())
+      op._operate();
+  }
+}
 }
 
 TEST_CASE("An operable with a scale of 1 operates every cycle") {
   constexpr double scale = 1;
   constexpr int num_cycles = 100;
   mock_operable uut{scale};
+  champsim::clock_calendar calendar{{uut}};
 
-  for (int i = 0; i < num_cycles; ++i)
-    uut._operate();
+  run_ticks(calendar, num_cycles);
 
   REQUIRE(uut.current_cycle == num_cycles);
 }
@@ -23,9 +31,9 @@ TEST_CASE("An operable with a scale greater than 1 skips occasional cycles") {
   constexpr double scale = 1.25;
   constexpr int num_cycles = 100;
   mock_operable uut{scale};
+  champsim::clock_calendar calendar{{uut}};
 
-  for (int i = 0; i < num_cycles; ++i)
-    uut._operate();
+  run_ticks(calendar, num_cycles);
 
   REQUIRE(uut.current_cycle == (4*num_cycles)/5);
 }
@@ -34,9 +42,9 @@ TEST_CASE("An operable with a scale greater than 2 skips multiple cycles") {
   constexpr double scale = 4;
   constexpr int num_cycles = 100;
   mock_operable uut{scale};
+  champsim::clock_calendar calendar{{uut}};
 
-  for (int i = 0; i < num_cycles; ++i)
-    uut._operate();
+  run_ticks(calendar, num_cycles);
 
   REQUIRE(uut.current_cycle == num_cycles/4);
 }
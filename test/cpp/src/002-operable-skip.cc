@@ -0,0 +1,70 @@
+#include <catch.hpp>
+#include "operable.h"
+
+namespace {
+struct skip_operable : champsim::operable {
+  using operable::operable;
+  uint64_t event_cycle = 0;
+  std::size_t occupancy = 0;
+  long skip_progress = 0;
+  int operate_count = 0;
+  int skip_count = 0;
+
+  long operate() final { ++operate_count; return 1; }
+  long skip_operate() final { ++skip_count; return skip_progress; }
+  uint64_t next_event_cycle() const final { return event_cycle; }
+  std::size_t input_occupancy() const final { return occupancy; }
+};
+
+struct default_operable : champsim::operable {
+  using operable::operable;
+  long operate() final { return 1; }
+};
+}
+
+TEST_CASE("An operable without a next event cannot be skipped") {
+  default_operable uut{1};
+  uut._operate();
+
+  REQUIRE_FALSE(uut.prepare_skip());
+}
+
+TEST_CASE("An operable can be skipped until its next event") {
+  constexpr uint64_t event = 20;
+  skip_operable uut{1};
+  uut.event_cycle = event;
+
+  REQUIRE(uut.prepare_skip());
+
+  while (uut.can_skip())
+    uut._skip();
+
+  CHECK(uut.current_cycle == event);
+  CHECK(uut.skip_count == event);
+  CHECK(uut.operate_count == 0);
+}
+
+TEST_CASE("A dormant operable wakes when a packet arrives") {
+  skip_operable uut{1};
+  uut.event_cycle = 100;
+
+  REQUIRE(uut.prepare_skip());
+  uut._skip();
+  REQUIRE(uut.can_skip());
+
+  ++uut.occupancy;
+  CHECK_FALSE(uut.can_skip());
+}
+
+TEST_CASE("A dormant operable wakes when skipping makes progress") {
+  skip_operable uut{1};
+  uut.event_cycle = 100;
+
+  REQUIRE(uut.prepare_skip());
+  uut._skip();
+  REQUIRE(uut.can_skip());
+
+  uut.skip_progress = 1;
+  uut._skip();
+  CHECK_FALSE(uut.can_skip());
+}
@@ -0,0 +1,90 @@
+#include <catch.hpp>
+#include "clock_calendar.h"
+
+#include <algorithm>
+
+namespace {
+struct clocked_operable : champsim::operable {
+  using operable::operable;
+  long operate() final { return 1; }
+};
+
+bool due(const std::vector<std::reference_wrapper<champsim::operable>>& tick, const champsim::operable& op) {
+  return std::any_of(std::begin(tick), std::end(tick), [&op](const champsim::operable& x) { return &x == &op; });
+}
+}
+
+TEST_CASE("A clock period is reduced to lowest terms") {
+  champsim::clock_period uut{4000, 3200};
+  CHECK(uut.ticks == 5);
+  CHECK(uut.cycles == 4);
+}
+
+TEST_CASE("A clock period recovers the exact ratio of a floating-point scale") {
+  champsim::clock_period uut{4000.0 / 2800.0};
+  CHECK(uut.ticks == 10);
+  CHECK(uut.cycles == 7);
+}
+
+TEST_CASE("A clock period that is unset or faster than a tick operates on every tick") {
+  auto [scale, ticks, cycles] = GENERATE(table<double, uint64_t, uint64_t>({{0, 1, 1}, {0.5, 1, 1}, {1, 1, 1}}));
+  champsim::clock_period uut{scale};
+  CHECK(uut.ticks == ticks);
+  CHECK(uut.cycles == cycles);
+}
+
+TEST_CASE("The clock calendar repeats after the least common multiple of the periods") {
+  clocked_operable fast{champsim::clock_period{1, 1}};
+  clocked_operable slow{champsim::clock_period{5, 4}};
+  clocked_operable slower{champsim::clock_period{10, 7}};
+
+  champsim::clock_calendar uut{{fast, slow, slower}};
+  CHECK(uut.hyperperiod() == 10);
+}
+
+TEST_CASE("The clock calendar skips the same ticks as the floating-point leap") {
+  constexpr double scale = 1.25;
+  clocked_operable uut_op{champsim::clock_period{scale}};
+  champsim::clock_calendar uut{{uut_op}};
+
+  double leap = 0;
+  for (int i = 0; i < 100; ++i) {
+    bool expected = leap < 1;
+    if (expected)
+      leap += scale - 1;
+    else
+      leap -= 1;
+    CHECK(due(uut.next_tick(), uut_op) == expected);
+  }
+}
+
+TEST_CASE("The clock calendar operates clock domains in order of their clock edges") {
+  clocked_operable slow{champsim::clock_period{5, 4}};
+  clocked_operable fast{champsim::clock_period{1, 1}};
+  champsim::clock_calendar uut{{slow, fast}};
+
+  const auto& first_tick = uut.next_tick();
+  REQUIRE(std::size(first_tick) == 2);
+  CHECK(&first_tick.at(0).get() == &slow);
+  CHECK(&first_tick.at(1).get() == &fast);
+
+  const auto& second_tick = uut.next_tick();
+  REQUIRE(std::size(second_tick) == 2);
+  CHECK(&second_tick.at(0).get() == &fast);
+  CHECK(&second_tick.at(1).get() == &slow);
+}
+
+TEST_CASE("Clock domains with tied clock edges keep their order from the previous tick") {
+  clocked_operable slow{champsim::clock_period{5, 4}};
+  clocked_operable fast{champsim::clock_period{1, 1}};
+  champsim::clock_calendar uut{{slow, fast}};
+
+  // The slow domain skips the fifth tick, and is behind the fast domain when its edge catches up
+  for (int i = 0; i < 5; ++i)
+    uut.next_tick();
+
+  const auto& tick = uut.next_tick();
+  REQUIRE(std::size(tick) == 2);
+  CHECK(&tick.at(0).get() == &fast);
+  CHECK(&tick.at(1).get() == &slow);
+}
@@ -0,0 +1,118 @@
+#include <catch.hpp>
+#include "defaults.hpp"
+#include "environment.h"
+#include "quantum.h"
+
+#include <algorithm>
+#include <optional>
+#include <thread>
+
+namespace {
+struct two_core_environment : champsim::environment {
+  std::array<champsim::channel, 2> fetch_queues{}, data_queues{}, l1i_queues{}, l1d_queues{}, llc_queues{};
+  champsim::channel dram_queue{};
+
+  O3_CPU cpu0{O3_CPU::Builder{champsim::defaults::default_core}.index(0).fetch_queues(&fetch_queues[0]).data_queues(&data_queues[0])};
+  O3_CPU cpu1{O3_CPU::Builder{champsim::defaults::default_core}.index(1).fetch_queues(&fetch_queues[1]).data_queues(&data_queues[1])};
+  CACHE l1i0{CACHE::Builder{champsim::defaults::default_l1i}.name("004-l1i0").upper_levels({&fetch_queues[0]}).lower_level(&l1i_queues[0])};
+  CACHE l1d0{CACHE::Builder{champsim::defaults::default_l1d}.name("004-l1d0").upper_levels({&data_queues[0]}).lower_level(&l1d_queues[0])};
+  CACHE l2c0{CACHE::Builder{champsim::defaults::default_l2c}.name("004-l2c0").upper_levels({&l1i_queues[0], &l1d_queues[0]}).lower_level(&llc_queues[0])};
+  CACHE l1i1{CACHE::Builder{champsim::defaults::default_l1i}.name("004-l1i1").upper_levels({&fetch_queues[1]}).lower_level(&l1i_queues[1])};
+  CACHE l1d1{CACHE::Builder{champsim::defaults::default_l1d}.name("004-l1d1").upper_levels({&data_queues[1]}).lower_level(&l1d_queues[1])};
+  CACHE l2c1{CACHE::Builder{champsim::defaults::default_l2c}.name("004-l2c1").upper_levels({&l1i_queues[1], &l1d_queues[1]}).lower_level(&llc_queues[1])};
+  CACHE llc{CACHE::Builder{champsim::defaults::default_llc}.name("004-llc").upper_levels({&llc_queues[0], &llc_queues[1]}).lower_level(&dram_queue)};
+  MEMORY_CONTROLLER dram{1, 3200, 12.5, 12.5, 12.5, 7.5, {&dram_queue}};
+
+  std::vector<std::reference_wrapper<O3_CPU>> cpu_view() override { return {cpu0, cpu1}; }
+  std::vector<std::reference_wrapper<CACHE>> cache_view() override { return {l1i0, l1d0, l2c0, l1i1, l1d1, l2c1, llc}; }
+  std::vector<std::reference_wrapper<PageTableWalker>> ptw_view() override { return {}; }
+  MEMORY_CONTROLLER& dram_view() override { return dram; }
+  std::vector<std::reference_wrapper<champsim::operable>> operable_view() override { return {cpu0, cpu1, l1i0, l1d0, l2c0, l1i1, l1d1, l2c1, llc, dram}; }
+};
+
+bool contains(const champsim::slice& s, const champsim::operable& op) {
+  return std::any_of(std::begin(s.operables), std::end(s.operables), [&op](const champsim::operable& x) { return &x == &op; });
+}
+}
+
+TEST_CASE("Each core's private caches are placed in its own slice") {
+  two_core_environment env;
+  auto slices = champsim::partition_slices(env);
+
+  REQUIRE(std::size(slices) == 3);
+  CHECK(std::size(slices[0].cpus) == 1);
+  CHECK(&slices[0].cpus.front().get() == &env.cpu0);
+  CHECK(std::size(slices[0].operables) == 4);
+  CHECK(contains(slices[0], env.l2c0));
+  CHECK(contains(slices[1], env.l2c1));
+  CHECK(std::empty(slices[2].cpus));
+  CHECK(std::size(slices[2].operables) == 2);
+  CHECK(contains(slices[2], env.llc));
+  CHECK(contains(slices[2], env.dram));
+}
+
+SCENARIO("A slice boundary stages the traffic that crosses it") {
+  GIVEN("A boundary between the private and shared slices") {
+    two_core_environment env;
+    auto slices = champsim::partition_slices(env);
+    std::optional<champsim::slice_boundary> uut{std::in_place, env, slices};
+
+    THEN("Only the channels into the shared cache are staged") {
+      CHECK(uut->size() == 2);
+      CHECK(env.l2c0.lower_level != &env.llc_queues[0]);
+      CHECK(env.l1d0.lower_level == &env.l1d_queues[0]);
+    }
+
+    WHEN("A private cache issues a request") {
+      champsim::channel::request_type test;
+      test.address = 0xdeadbeef;
+      REQUIRE(env.l2c0.lower_level->add_rq(test));
+
+      THEN("The shared cache does not see it until the exchange") {
+        CHECK(std::empty(env.llc_queues[0].RQ));
+        CHECK(uut->exchange() == 1);
+        CHECK(std::size(env.llc_queues[0].RQ) == 1);
+      }
+    }
+
+    WHEN("The shared cache responds") {
+      champsim::channel::request_type test;
+      test.address = 0xdeadbeef;
+      env.llc_queues[1].returned.emplace_back(test);
+
+      THEN("The private cache does not see it until the exchange") {
+        CHECK(std::empty(env.l2c1.lower_level->returned));
+        CHECK(uut->exchange() == 1);
+        CHECK(std::size(env.l2c1.lower_level->returned) == 1);
+      }
+    }
+
+    WHEN("The boundary ends with a request still staged") {
+      champsim::channel::request_type test;
+      test.address = 0xdeadbeef;
+      REQUIRE(env.l2c0.lower_level->add_rq(test));
+      uut.reset();
+
+      THEN("The original channels are restored and the request is delivered") {
+        CHECK(env.l2c0.lower_level == &env.llc_queues[0]);
+        CHECK(std::size(env.llc_queues[0].RQ) == 1);
+      }
+    }
+  }
+}
+
+TEST_CASE("A quantum barrier runs its completion once per generation") {
+  constexpr int generations = 100;
+  int completions = 0;
+  champsim::quantum_barrier uut{2, [&completions] { ++completions; }};
+
+  std::thread other{[&uut] {
+    for (int i = 0; i < generations; ++i)
+      uut.arrive_and_wait();
+  }};
+  for (int i = 0; i < generations; ++i) {
+    uut.arrive_and_wait();
+    REQUIRE(completions == i + 1);
+  }
+  other.join();
+}
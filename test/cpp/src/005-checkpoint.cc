@@ -0,0 +1,157 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "checkpoint.h"
+#include "dram_controller.h"
+#include "util/lru_table.h"
+#include "vmem.h"
+
+#include <map>
+#include <optional>
+#include <sstream>
+#include <vector>
+
+TEST_CASE("Checkpointed values survive a round trip") {
+  std::map<std::pair<uint32_t, uint64_t>, uint64_t> map{{{0, 0xdead}, 0xbeef}, {{1, 0xcafe}, 0xf00d}};
+  std::vector<int> vec{1, 2, 3};
+  std::optional<int> full{5};
+  std::optional<int> empty{};
+  std::array<std::vector<int>, 2> nested{{{4}, {5, 6}}};
+
+  std::stringstream stream;
+  champsim::checkpoint::save(stream, std::tie(map, vec, full, empty, nested));
+
+  decltype(map) map_result;
+  decltype(vec) vec_result{7};
+  decltype(full) full_result;
+  decltype(empty) empty_result{8};
+  decltype(nested) nested_result;
+  auto fields = std::tie(map_result, vec_result, full_result, empty_result, nested_result);
+  champsim::checkpoint::load(stream, fields);
+
+  CHECK(map_result == map);
+  CHECK(vec_result == vec);
+  CHECK(full_result == full);
+  CHECK(empty_result == empty);
+  CHECK(nested_result == nested);
+}
+
+TEST_CASE("Loading a truncated checkpoint throws") {
+  std::stringstream stream;
+  champsim::checkpoint::save(stream, std::vector<uint64_t>{1, 2, 3});
+
+  auto data = stream.str();
+  std::stringstream truncated{data.substr(0, std::size(data) - 1)};
+  std::vector<uint64_t> result;
+  REQUIRE_THROWS_AS(champsim::checkpoint::load(truncated, result), std::runtime_error);
+}
+
+TEST_CASE("A restored lru_table keeps its replacement order") {
+  struct id_proj {
+    auto operator()(uint64_t x) const { return x; }
+  };
+  champsim::lru_table<uint64_t, id_proj, id_proj> original{1, 2};
+  original.fill(0xa);
+  original.fill(0xb);
+  original.check_hit(0xa);
+
+  std::stringstream stream;
+  champsim::checkpoint::save(stream, original);
+
+  champsim::lru_table<uint64_t, id_proj, id_proj> uut{1, 2};
+  champsim::checkpoint::load(stream, uut);
+  uut.fill(0xc);
+
+  CHECK(uut.check_hit(0xa).has_value());
+  CHECK_FALSE(uut.check_hit(0xb).has_value());
+  CHECK(uut.check_hit(0xc).has_value());
+}
+
+SCENARIO("A virtual memory restored from a checkpoint translates as before") {
+  GIVEN("A virtual memory with a page mapped") {
+    MEMORY_CONTROLLER dram{1, 3200, 12.5, 12.5, 12.5, 7.5, {}};
+    VirtualMemory original{1ull << 12, 5, 200, dram};
+    auto [original_paddr, original_delay] = original.va_to_pa(0, 0xdeadbeef);
+
+    std::stringstream stream;
+    original.save_checkpoint(stream);
+
+    WHEN("The mappings are restored into a new virtual memory") {
+      VirtualMemory uut{1ull << 12, 5, 200, dram};
+      uut.load_checkpoint(stream);
+
+      THEN("The mapped page does not fault") {
+        auto [paddr, delay] = uut.va_to_pa(0, 0xdeadbeef);
+        CHECK(paddr == original_paddr);
+        CHECK(delay == 0);
+      }
+
+      THEN("The next page is allocated in the same place") {
+        CHECK(uut.va_to_pa(0, 0xcafebabe) == original.va_to_pa(0, 0xcafebabe));
+      }
+    }
+  }
+}
+
+SCENARIO("A cache restored from a checkpoint hits on the blocks it held") {
+  GIVEN("A cache that has been filled") {
+    do_nothing_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE original{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("005-original")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&original, &mock_ll, &mock_ul}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    decltype(mock_ul)::request_type seed;
+    seed.address = 0xdeadbeef;
+    seed.is_translated = true;
+    seed.cpu = 0;
+    seed.type = access_type::LOAD;
+    REQUIRE(mock_ul.issue(seed));
+
+    for (auto i = 0; i < 100; ++i)
+      for (auto elem : elements)
+        elem->_operate();
+
+    std::stringstream stream;
+    original.save_checkpoint(stream);
+
+    WHEN("The checkpoint is restored into a new cache") {
+      do_nothing_MRC restored_ll;
+      to_rq_MRP restored_ul;
+      CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+        .name("005-uut")
+        .upper_levels({&restored_ul.queues})
+        .lower_level(&restored_ll.queues)
+      };
+
+      std::array<champsim::operable*, 3> restored_elements{{&uut, &restored_ll, &restored_ul}};
+      for (auto elem : restored_elements) {
+        elem->initialize();
+        elem->warmup = false;
+        elem->begin_phase();
+      }
+      uut.load_checkpoint(stream);
+
+      auto test = seed;
+      REQUIRE(restored_ul.issue(test));
+      for (auto i = 0; i < 10; ++i)
+        for (auto elem : restored_elements)
+          elem->_operate();
+
+      THEN("The packet hits") {
+        CHECK(uut.sim_stats.hits.at(champsim::to_underlying(access_type::LOAD)).at(0) == 1);
+        CHECK(std::size(restored_ul.packets) == 1);
+      }
+    }
+  }
+}
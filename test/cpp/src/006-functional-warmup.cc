@@ -0,0 +1,99 @@
+#include <catch.hpp>
+#include "defaults.hpp"
+#include "environment.h"
+#include "functional_warmup.h"
+#include "instr.h"
+
+namespace {
+struct one_core_environment : champsim::environment {
+  champsim::channel fetch_queues{}, data_queues{}, l1i_queues{}, l1d_queues{}, llc_queues{}, dram_queue{};
+
+  O3_CPU cpu{O3_CPU::Builder{champsim::defaults::default_core}.fetch_queues(&fetch_queues).data_queues(&data_queues)};
+  CACHE l1i{CACHE::Builder{champsim::defaults::default_l1i}.name("006-l1i").upper_levels({&fetch_queues}).lower_level(&l1i_queues)};
+  CACHE l1d{CACHE::Builder{champsim::defaults::default_l1d}.name("006-l1d").upper_levels({&data_queues}).lower_level(&l1d_queues)};
+  CACHE l2c{CACHE::Builder{champsim::defaults::default_l2c}.name("006-l2c").upper_levels({&l1i_queues, &l1d_queues}).lower_level(&llc_queues)};
+  CACHE llc{CACHE::Builder{champsim::defaults::default_llc}.name("006-llc").upper_levels({&llc_queues}).lower_level(&dram_queue)};
+  MEMORY_CONTROLLER dram{1, 3200, 12.5, 12.5, 12.5, 7.5, {&dram_queue}};
+
+  std::vector<std::reference_wrapper<O3_CPU>> cpu_view() override { return {cpu}; }
+  std::vector<std::reference_wrapper<CACHE>> cache_view() override { return {l1i, l1d, l2c, llc}; }
+  std::vector<std::reference_wrapper<PageTableWalker>> ptw_view() override { return {}; }
+  MEMORY_CONTROLLER& dram_view() override { return dram; }
+  std::vector<std::reference_wrapper<champsim::operable>> operable_view() override { return {cpu, l1i, l1d, l2c, llc, dram}; }
+
+  one_core_environment() {
+    for (champsim::operable& op : operable_view()) {
+      op.initialize();
+      op.warmup = true;
+      op.begin_phase();
+    }
+  }
+};
+
+champsim::channel::request_type load(uint64_t address) {
+  champsim::channel::request_type packet;
+  packet.address = address;
+  packet.v_address = address;
+  packet.ip = address;
+  packet.is_translated = true;
+  packet.cpu = 0;
+  packet.type = access_type::LOAD;
+  return packet;
+}
+}
+
+SCENARIO("Functional warming fills every level that an access misses") {
+  GIVEN("An empty hierarchy") {
+    one_core_environment env;
+    champsim::functional_warmup uut{env};
+
+    WHEN("An instruction loads from memory") {
+      auto instr = champsim::test::instruction_with_ip(0x401000);
+      instr.source_memory.push_back(0xdeadbeef);
+      uut.operate(env.cpu, instr);
+
+      THEN("The instruction is retired") {
+        CHECK(env.cpu.num_retired == 1);
+      }
+
+      THEN("The instruction block is in the instruction cache") {
+        CHECK(env.l1i.warm_access(load(0x401000)).has_value());
+      }
+
+      THEN("The data block is in each data cache") {
+        CHECK(env.l1d.warm_access(load(0xdeadbeef)).has_value());
+        CHECK(env.l2c.warm_access(load(0xdeadbeef)).has_value());
+        CHECK(env.llc.warm_access(load(0xdeadbeef)).has_value());
+      }
+
+      THEN("No time passes") {
+        CHECK(env.cpu.current_cycle == 0);
+        CHECK(env.l1d.current_cycle == 0);
+      }
+    }
+  }
+}
+
+SCENARIO("A functional fill returns the writeback of a dirty victim") {
+  GIVEN("A cache set filled with dirty blocks") {
+    one_core_environment env;
+    auto write = load(0);
+    write.type = access_type::WRITE;
+
+    const auto set_stride = uint64_t{env.l1d.NUM_SET} << LOG2_BLOCK_SIZE;
+    for (std::size_t i = 0; i < env.l1d.NUM_WAY; ++i) {
+      write.address = write.v_address = i * set_stride;
+      REQUIRE_FALSE(env.l1d.warm_fill(write).has_value());
+    }
+
+    WHEN("Another block is filled into the set") {
+      auto writeback = env.l1d.warm_fill(load(env.l1d.NUM_WAY * set_stride));
+
+      THEN("A dirty block is written back") {
+        REQUIRE(writeback.has_value());
+        CHECK(writeback->type == access_type::WRITE);
+        CHECK(writeback->address % set_stride == 0);
+      }
+    }
+  }
+}
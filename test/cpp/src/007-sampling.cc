@@ -0,0 +1,81 @@
+#include <catch.hpp>
+#include "sampling.h"
+
+#include <cmath>
+
+TEST_CASE("The estimated mean of a sample has a confidence interval from the t-distribution") {
+  auto uut = champsim::estimate_mean({1.0, 2.0, 3.0, 4.0});
+
+  CHECK(uut.count == 4);
+  CHECK(uut.mean == Approx(2.5));
+
+  // The sample standard deviation is sqrt(5/3), and the critical value for 3 degrees of freedom is 3.182
+  CHECK(uut.half_width == Approx(3.182 * std::sqrt(5.0 / 3.0) / 2.0));
+}
+
+TEST_CASE("A single window has no confidence interval") {
+  auto uut = champsim::estimate_mean({0.5});
+
+  CHECK(uut.mean == Approx(0.5));
+  CHECK(std::isnan(uut.half_width));
+}
+
+TEST_CASE("Identical windows have an empty confidence interval") {
+  auto uut = champsim::estimate_mean(std::vector<double>(100, 1.25));
+
+  CHECK(uut.mean == Approx(1.25));
+  CHECK(uut.half_width == Approx(0.0));
+}
+
+TEST_CASE("A measured window reports IPC and misses per kilo-instruction") {
+  champsim::phase_stats window;
+
+  O3_CPU::stats_type cpu;
+  cpu.begin_instrs = 1000;
+  cpu.end_instrs = 3000;
+  cpu.begin_cycles = 500;
+  cpu.end_cycles = 4500;
+  window.roi_cpu_stats.push_back(cpu);
+
+  CACHE::stats_type cache;
+  cache.name = "007-cache";
+  cache.misses.at(champsim::to_underlying(access_type::LOAD)).at(0) = 30;
+  cache.misses.at(champsim::to_underlying(access_type::WRITE)).at(0) = 10;
+  window.roi_cache_stats.push_back(cache);
+
+  DRAM_CHANNEL::stats_type dram;
+  dram.RQ_ROW_BUFFER_HIT = 2;
+  dram.RQ_ROW_BUFFER_MISS = 6;
+  window.roi_dram_stats.push_back(dram);
+
+  auto uut = champsim::measure_sample(window);
+
+  REQUIRE(std::size(uut.cpu_ipc) == 1);
+  CHECK(uut.cpu_ipc.front() == Approx(0.5));
+  REQUIRE(std::size(uut.cache_mpki) == 1);
+  CHECK(uut.cache_mpki.front().first == "007-cache");
+  CHECK(uut.cache_mpki.front().second == Approx(20.0));
+  REQUIRE(std::size(uut.dram_apki) == 1);
+  CHECK(uut.dram_apki.front().second == Approx(4.0));
+}
+
+TEST_CASE("Combined CPU stats cover both phases") {
+  O3_CPU::stats_type first;
+  first.begin_instrs = 100;
+  first.end_instrs = 200;
+  first.begin_cycles = 1000;
+  first.end_cycles = 1400;
+  first.branch_type_misses.at(BRANCH_CONDITIONAL) = 3;
+
+  O3_CPU::stats_type second;
+  second.begin_instrs = 5000;
+  second.end_instrs = 5300;
+  second.begin_cycles = 9000;
+  second.end_cycles = 9200;
+  second.branch_type_misses.at(BRANCH_CONDITIONAL) = 4;
+
+  auto uut = first + second;
+  CHECK(uut.instrs() == 400);
+  CHECK(uut.cycles() == 600);
+  CHECK(uut.branch_type_misses.at(BRANCH_CONDITIONAL) == 7);
+}
@@ -0,0 +1,78 @@
+#include <catch.hpp>
+#include "sampling.h"
+#include "simpoint.h"
+
+#include <sstream>
+
+TEST_CASE("SimPoints are joined with their weights by cluster") {
+  std::istringstream simpoints{"12 0\n3 1\n"};
+  std::istringstream weights{"0.25 1\n0.75 0\n"};
+
+  auto uut = champsim::read_simpoints(simpoints, weights);
+
+  REQUIRE(std::size(uut) == 2);
+  CHECK(uut.at(0).cluster == 0);
+  CHECK(uut.at(0).interval == 12);
+  CHECK(uut.at(0).weight == Approx(0.75));
+  CHECK(uut.at(1).cluster == 1);
+  CHECK(uut.at(1).interval == 3);
+  CHECK(uut.at(1).weight == Approx(0.25));
+}
+
+TEST_CASE("A SimPoint without a weight is rejected") {
+  std::istringstream simpoints{"12 0\n3 1\n"};
+  std::istringstream weights{"1.0 0\n"};
+
+  REQUIRE_THROWS_AS(champsim::read_simpoints(simpoints, weights), std::runtime_error);
+}
+
+SCENARIO("SimPoint regions are visited in trace order") {
+  champsim::phase_info warmup{"Warmup", true, 300, {0}, {"trace"}};
+  champsim::phase_info simulation{"Simulation", false, 0, {0}, {"trace"}};
+
+  GIVEN("Regions with room for their warmup") {
+    auto uut = champsim::simpoint_phases({{0, 10, 0.5}, {1, 2, 0.5}}, 1000, warmup, simulation);
+
+    THEN("Each region is warmed and then simulated") {
+      REQUIRE(std::size(uut) == 4);
+      CHECK(uut.at(0).is_warmup);
+      CHECK(uut.at(0).skip_to == 1700);
+      CHECK(uut.at(0).length == 300);
+      CHECK_FALSE(uut.at(1).is_warmup);
+      CHECK(uut.at(1).skip_to == 2000);
+      CHECK(uut.at(1).length == 1000);
+      CHECK(uut.at(1).weight == Approx(0.5));
+      CHECK(uut.at(2).skip_to == 9700);
+      CHECK(uut.at(3).skip_to == 10000);
+    }
+  }
+
+  GIVEN("Adjacent regions") {
+    auto uut = champsim::simpoint_phases({{0, 0, 0.5}, {1, 1, 0.5}}, 1000, warmup, simulation);
+
+    THEN("The first region has no warmup, and the second is not warmed again") {
+      REQUIRE(std::size(uut) == 2);
+      CHECK_FALSE(uut.at(0).is_warmup);
+      CHECK(uut.at(0).skip_to == 0);
+      CHECK_FALSE(uut.at(1).is_warmup);
+      CHECK(uut.at(1).skip_to == 1000);
+    }
+  }
+}
+
+TEST_CASE("The weighted IPC of regions is averaged through CPI") {
+  auto region = [](uint64_t cycles, double weight) {
+    champsim::phase_stats result;
+    O3_CPU::stats_type cpu;
+    cpu.end_instrs = 1000;
+    cpu.end_cycles = cycles;
+    result.roi_cpu_stats.push_back(cpu);
+    result.weight = weight;
+    return result;
+  };
+
+  auto uut = champsim::weighted_mean({region(1000, 0.5), region(4000, 0.5), region(1, 0)});
+
+  REQUIRE(std::size(uut.cpu_ipc) == 1);
+  CHECK(uut.cpu_ipc.front() == Approx(1.0 / 2.5));
+}
@@ -0,0 +1,25 @@
+#include <catch.hpp>
+#include "sampling.h"
+
+TEST_CASE("A series converges once enough values lie within the tolerance of the latest") {
+  std::deque<double> history{2.0, 1.0, 0.995, 1.005, 1.0};
+
+  CHECK(champsim::has_converged(history, 3, 0.01));
+  CHECK_FALSE(champsim::has_converged(history, 4, 0.01));
+  CHECK_FALSE(champsim::has_converged(history, 3, 0.005));
+}
+
+TEST_CASE("A series that is too short has not converged") {
+  std::deque<double> history{1.0, 1.0};
+
+  CHECK(champsim::has_converged(history, 1, 0.01));
+  CHECK_FALSE(champsim::has_converged(history, 2, 0.01));
+  CHECK_FALSE(champsim::has_converged({}, 1, 0.01));
+}
+
+TEST_CASE("A slowly drifting series does not converge") {
+  std::deque<double> history{1.0, 1.004, 1.008, 1.012, 1.016};
+
+  // Each step is within the tolerance, but the series as a whole is not
+  CHECK_FALSE(champsim::has_converged(history, 4, 0.01));
+}
@@ -0,0 +1,83 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "batch.h"
+#include "cache.h"
+
+#include <sstream>
+#include <stdexcept>
+
+TEST_CASE("A batch manifest holds the traces and JSON file of each job") {
+  std::istringstream manifest{"# core0 core1 output\na.xz b.xz ab.json\n\n  c.xz d.xz cd.json\n"};
+  auto jobs = champsim::read_batch_manifest(manifest, 2);
+
+  REQUIRE(std::size(jobs) == 2);
+  CHECK(jobs.at(0).trace_names == std::vector<std::string>{"a.xz", "b.xz"});
+  CHECK(jobs.at(0).json_file_name == "ab.json");
+  CHECK(jobs.at(1).trace_names == std::vector<std::string>{"c.xz", "d.xz"});
+  CHECK(jobs.at(1).json_file_name == "cd.json");
+}
+
+TEST_CASE("A batch manifest line with the wrong number of traces throws") {
+  std::istringstream manifest{"a.xz b.xz ab.json\nc.xz cd.json\n"};
+  REQUIRE_THROWS_AS(champsim::read_batch_manifest(manifest, 2), std::runtime_error);
+}
+
+SCENARIO("Clearing a cache discards its work in flight") {
+  GIVEN("A cache with misses outstanding") {
+    release_MRC mock_ll;
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("010-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&uut, &mock_ll, &mock_ul}};
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    for (uint64_t i = 0; i < 3; ++i) {
+      decltype(mock_ul)::request_type test;
+      test.address = 0xdeadbeef + (i << LOG2_BLOCK_SIZE);
+      test.is_translated = true;
+      test.cpu = 0;
+      test.type = access_type::LOAD;
+      REQUIRE(mock_ul.issue(test));
+    }
+
+    for (auto i = 0; i < 100; ++i)
+      for (auto elem : elements)
+        elem->_operate();
+
+    REQUIRE(uut.get_mshr_occupancy() > 0);
+
+    WHEN("The cache is cleared") {
+      uut.clear_inflight();
+
+      THEN("The MSHR and the queues it reads from are empty") {
+        CHECK(uut.get_mshr_occupancy() == 0);
+        CHECK(std::empty(mock_ul.queues.RQ));
+        CHECK(std::empty(mock_ul.queues.returned));
+      }
+
+      THEN("A new request misses again") {
+        decltype(mock_ul)::request_type test;
+        test.address = 0xdeadbeef;
+        test.is_translated = true;
+        test.cpu = 0;
+        test.type = access_type::LOAD;
+        REQUIRE(mock_ul.issue(test));
+
+        for (auto i = 0; i < 10; ++i)
+          for (auto elem : elements)
+            elem->_operate();
+
+        CHECK(uut.get_mshr_occupancy() == 1);
+      }
+    }
+  }
+}
@@ -0,0 +1,74 @@
+#include <catch.hpp>
+#include "checkpoint.h"
+#include "forking.h"
+#include "phase_info.h"
+#include "trace_fixtures.h"
+
+#include <array>
+#include <sstream>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+TEST_CASE("Adopted file offsets are independent of the originals") {
+  champsim::test::temp_file file{"abcdef"};
+
+  auto fd = open(file.name.c_str(), O_RDONLY);
+  REQUIRE(fd >= 0);
+  std::array<char, 2> buffer{};
+  REQUIRE(read(fd, std::data(buffer), std::size(buffer)) == 2);
+
+  // A duplicate shares the offset of the original description, like a forked child would
+  auto shared = dup(fd);
+  REQUIRE(shared >= 0);
+  {
+    champsim::file_offsets offsets;
+    offsets.adopt();
+  }
+
+  REQUIRE(read(shared, std::data(buffer), std::size(buffer)) == 2);
+  CHECK(std::string(std::begin(buffer), std::end(buffer)) == "cd");
+  REQUIRE(read(fd, std::data(buffer), std::size(buffer)) == 2);
+  CHECK(std::string(std::begin(buffer), std::end(buffer)) == "cd");
+
+  close(shared);
+  close(fd);
+}
+
+TEST_CASE("Phase stats survive a round trip through a pipe") {
+  champsim::phase_stats original;
+  original.name = "011-original";
+  original.trace_names = {"a.xz", "b.xz"};
+  original.sim_cpu_stats.emplace_back().end_instrs = 1000;
+  original.sim_cache_stats.emplace_back().name = "LLC";
+  original.sim_cache_stats.back().pf_issued = 7;
+  original.sim_dram_stats.emplace_back().RQ_ROW_BUFFER_HIT = 3;
+  original.samples.emplace_back().cpu_ipc = {0.5};
+  original.stop_reason = "end of trace";
+
+  int stats_pipe[2];
+  REQUIRE(pipe(stats_pipe) == 0);
+  std::ostringstream out;
+  champsim::checkpoint::save(out, original);
+  REQUIRE(champsim::write_all(stats_pipe[1], out.str()));
+  close(stats_pipe[1]);
+
+  std::istringstream in{champsim::read_all(stats_pipe[0])};
+  close(stats_pipe[0]);
+  champsim::phase_stats uut;
+  champsim::checkpoint::load(in, uut);
+
+  CHECK(uut.name == original.name);
+  CHECK(uut.trace_names == original.trace_names);
+  REQUIRE(std::size(uut.sim_cpu_stats) == 1);
+  CHECK(uut.sim_cpu_stats.front().end_instrs == 1000);
+  REQUIRE(std::size(uut.sim_cache_stats) == 1);
+  CHECK(uut.sim_cache_stats.front().name == "LLC");
+  CHECK(uut.sim_cache_stats.front().pf_issued == 7);
+  REQUIRE(std::size(uut.sim_dram_stats) == 1);
+  CHECK(uut.sim_dram_stats.front().RQ_ROW_BUFFER_HIT == 3);
+  REQUIRE(std::size(uut.samples) == 1);
+  CHECK(uut.samples.front().cpu_ipc == std::vector<double>{0.5});
+  CHECK(uut.stop_reason == original.stop_reason);
+}
@@ -0,0 +1,32 @@
+#include <catch.hpp>
+#include "profiler.h"
+
+TEST_CASE("An enabled timer adds its lifetime to the region") {
+  champsim::profiler::region region;
+  for (int i = 0; i < 3; ++i) {
+    champsim::profiler::timer<true> timed{region};
+  }
+
+  REQUIRE(region.calls == 3);
+}
+
+TEST_CASE("An enabled timer counts the ticks that pass while it is alive") {
+  champsim::profiler::region region;
+  auto begin = champsim::profiler::now();
+  {
+    champsim::profiler::timer<true> timed{region};
+  }
+  auto end = champsim::profiler::now();
+
+  REQUIRE(region.ticks <= end - begin);
+}
+
+TEST_CASE("A disabled timer does not touch the region") {
+  champsim::profiler::region region;
+  {
+    champsim::profiler::timer<false> timed{region};
+  }
+
+  REQUIRE(region.calls == 0);
+  REQUIRE(region.ticks == 0);
+}
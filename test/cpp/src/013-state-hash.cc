@@ -0,0 +1,54 @@
+#include <catch.hpp>
+#include "state_hash.h"
+
+#include <sstream>
+
+TEST_CASE("A state hash record is read from a tab-separated line") {
+  std::istringstream log{"Simulation phase\t1000\tcpu0_L1D\t00000000deadbeef\n"};
+  auto record = champsim::state_hash::read(log);
+
+  REQUIRE(record.has_value());
+  REQUIRE(record->phase == "Simulation phase");
+  REQUIRE(record->tick == 1000);
+  REQUIRE(record->component == "cpu0_L1D");
+  REQUIRE(record->hash == 0xdeadbeef);
+  REQUIRE_FALSE(champsim::state_hash::read(log).has_value());
+}
+
+TEST_CASE("A malformed state hash record throws") {
+  std::istringstream log{"Simulation\t1000\tcpu0_L1D\n"};
+  REQUIRE_THROWS_AS(champsim::state_hash::read(log), std::runtime_error);
+}
+
+TEST_CASE("Identical state hash logs match") {
+  std::string log{"Warmup\t10\tCPU 0\t1\nWarmup\t10\tLLC\t2\nSimulation\t20\tCPU 0\t3\n"};
+  std::istringstream reference{log}, actual{log};
+  auto result = champsim::state_hash::compare(reference, actual);
+
+  REQUIRE_FALSE(result.diverged());
+  REQUIRE(result.matched == 3);
+}
+
+TEST_CASE("The first divergent cycle and component are reported") {
+  std::istringstream reference{"Warmup\t10\tCPU 0\t1\nWarmup\t10\tLLC\t2\nSimulation\t20\tCPU 0\t3\n"};
+  std::istringstream actual{"Warmup\t10\tCPU 0\t1\nWarmup\t10\tLLC\t5\nSimulation\t20\tCPU 0\t6\n"};
+  auto result = champsim::state_hash::compare(reference, actual);
+
+  REQUIRE(result.diverged());
+  REQUIRE(result.matched == 1);
+  REQUIRE(result.actual.has_value());
+  REQUIRE(result.actual->tick == 10);
+  REQUIRE(result.actual->component == "LLC");
+  REQUIRE(champsim::state_hash::describe(result) == "State diverged from the reference at Warmup tick 10 in LLC (1 records matched)");
+}
+
+TEST_CASE("A state hash log that ends early diverges") {
+  std::istringstream reference{"Warmup\t10\tCPU 0\t1\nWarmup\t20\tCPU 0\t2\n"};
+  std::istringstream actual{"Warmup\t10\tCPU 0\t1\n"};
+  auto result = champsim::state_hash::compare(reference, actual);
+
+  REQUIRE(result.diverged());
+  REQUIRE(result.matched == 1);
+  REQUIRE_FALSE(result.actual.has_value());
+  REQUIRE(result.reference->tick == 20);
+}
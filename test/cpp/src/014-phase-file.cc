@@ -0,0 +1,109 @@
+#include <catch.hpp>
+#include "dram_controller.h"
+#include "phase_file.h"
+
+#include <sstream>
+
+namespace
+{
+const champsim::phase_info warmup_template{"Warmup", true, 0, {}, {}};
+const champsim::phase_info simulation_template{"Simulation", false, 0, {}, {}};
+} // namespace
+
+TEST_CASE("A phase file describes a sequence of phases") {
+  std::istringstream file{R"({"phases": [
+    {"name": "Cold", "warmup": true, "functional": true, "length": 1000},
+    {"name": "First", "length": 2000},
+    {"length": 3000, "skip_to": 10000}
+  ]})"};
+  auto uut = champsim::read_phase_file(file, {"a.xz", "b.xz"}, 2, warmup_template, simulation_template);
+
+  REQUIRE(std::size(uut) == 3);
+  CHECK(uut.at(0).name == "Cold");
+  CHECK(uut.at(0).is_warmup);
+  CHECK(uut.at(0).is_functional);
+  CHECK(uut.at(0).length == 1000);
+  CHECK(uut.at(1).name == "First");
+  CHECK_FALSE(uut.at(1).is_warmup);
+  CHECK(uut.at(1).length == 2000);
+  CHECK(uut.at(2).name == "Phase 2");
+  CHECK(uut.at(2).skip_to == 10000);
+  for (const auto& phase : uut) {
+    CHECK(phase.trace_index == std::vector<std::size_t>{0, 1});
+    CHECK(phase.trace_names == std::vector<std::string>{"a.xz", "b.xz"});
+  }
+}
+
+TEST_CASE("Phases copy the options of their template") {
+  auto simulation = simulation_template;
+  simulation.sample_period = 500;
+  std::istringstream file{R"({"phases": [{"warmup": true, "length": 1000}, {"length": 2000}]})"};
+  auto uut = champsim::read_phase_file(file, {"a.xz"}, 1, warmup_template, simulation);
+
+  REQUIRE(std::size(uut) == 2);
+  CHECK(uut.at(0).sample_period == 0);
+  CHECK(uut.at(1).sample_period == 500);
+}
+
+TEST_CASE("Each phase of a phase file may assign its own traces") {
+  std::istringstream file{R"({"traces": ["a.xz", "b.xz"], "phases": [
+    {"length": 1000},
+    {"length": 1000, "traces": [1, 0]},
+    {"length": 1000, "traces": ["c.xz", "a.xz"]}
+  ]})"};
+  auto uut = champsim::read_phase_file(file, {}, 2, warmup_template, simulation_template);
+
+  REQUIRE(std::size(uut) == 3);
+  CHECK(uut.at(0).trace_index == std::vector<std::size_t>{0, 1});
+  CHECK(uut.at(1).trace_index == std::vector<std::size_t>{1, 0});
+  CHECK(uut.at(2).trace_index == std::vector<std::size_t>{2, 0});
+  CHECK(uut.at(0).trace_names == std::vector<std::string>{"a.xz", "b.xz", "c.xz"});
+}
+
+TEST_CASE("An invalid phase file is rejected") {
+  auto read = [](std::string text) {
+    std::istringstream file{text};
+    return champsim::read_phase_file(file, {"a.xz"}, 1, warmup_template, simulation_template);
+  };
+
+  CHECK_THROWS_AS(read("{"), std::runtime_error);
+  CHECK_THROWS_AS(read(R"({"phases": []})"), std::runtime_error);
+  CHECK_THROWS_AS(read(R"({"phases": [{"name": "No length"}]})"), std::runtime_error);
+  CHECK_THROWS_AS(read(R"({"phases": [{"length": 1000, "lenght": 2000}]})"), std::runtime_error);
+  CHECK_THROWS_AS(read(R"({"phases": [{"length": 1000, "traces": [3]}]})"), std::runtime_error);
+  CHECK_THROWS_AS(read(R"({"phases": [{"length": 1000, "traces": [0, 0]}]})"), std::runtime_error);
+  CHECK_THROWS_AS(read(R"({"phases": [{"length": 1000, "functional": true}]})"), std::runtime_error);
+}
+
+SCENARIO("The memory controller may warm up after a timed phase") {
+  GIVEN("A memory controller with a request scheduled to a bank") {
+    champsim::channel ul{};
+    MEMORY_CONTROLLER uut{1, 3200, 12.5, 12.5, 12.5, 7.5, {&ul}};
+    uut.warmup = false;
+
+    champsim::channel::request_type request;
+    request.address = 0xdeadbeef;
+    request.v_address = request.address;
+    ul.add_rq(request);
+
+    auto scheduled = [&uut] {
+      return std::any_of(std::begin(uut.channels), std::end(uut.channels), [](const auto& chan) {
+        return std::any_of(std::begin(chan.bank_request), std::end(chan.bank_request), [](const auto& bank) { return bank.valid; });
+      });
+    };
+    for (int i = 0; i < 100 && !scheduled(); ++i)
+      uut._operate();
+    REQUIRE(scheduled());
+
+    WHEN("The next phase is a warmup") {
+      uut.warmup = true;
+
+      THEN("The scheduled request is dropped with its packet") {
+        REQUIRE_NOTHROW(uut._operate());
+        CHECK_FALSE(scheduled());
+        for (int i = 0; i < 1000; ++i)
+          REQUIRE_NOTHROW(uut._operate());
+      }
+    }
+  }
+}
@@ -0,0 +1,52 @@
+#include <catch.hpp>
+
+#include <sstream>
+
+#include "trace_fixtures.h"
+#include "tracereader.h"
+
+TEST_CASE("A skipping tracereader resumes at the same instruction as a reading one") {
+  auto length = GENERATE(as<uint64_t>{}, 1, 126, 127, 128, 500);
+  auto data = champsim::test::trace_of_length(1000);
+
+  champsim::bulk_tracereader<input_instr, std::istringstream> reader{0, std::istringstream{data}};
+  champsim::bulk_tracereader<input_instr, std::istringstream> uut{0, std::istringstream{data}};
+
+  // Start partway through a buffer
+  for (auto i = 0; i < 3; ++i) {
+    (void)reader();
+    (void)uut();
+  }
+
+  for (uint64_t i = 0; i < length; ++i)
+    (void)reader();
+  REQUIRE(uut.skip(length) == length);
+
+  for (auto i = 0; i < 200; ++i) {
+    auto expected = reader();
+    auto actual = uut();
+    REQUIRE(actual.ip == expected.ip);
+    REQUIRE(actual.branch_target == expected.branch_target);
+  }
+}
+
+TEST_CASE("A tracereader skips no further than the end of the trace") {
+  champsim::tracereader uut{champsim::bulk_tracereader<input_instr, std::istringstream>{0, std::istringstream{champsim::test::trace_of_length(10)}}};
+  (void)uut();
+
+  CHECK(uut.skip(100) == 9);
+  CHECK(uut.num_read() == 10);
+  CHECK(uut.eof());
+}
+
+TEST_CASE("A tracereader without a skip() member function reads the skipped instructions") {
+  uint64_t calls = 0;
+  champsim::tracereader uut{[&calls]() {
+    ++calls;
+    return ooo_model_instr{0, input_instr{}};
+  }};
+
+  CHECK(uut.skip(5) == 5);
+  CHECK(calls == 5);
+  CHECK(uut.num_read() == 5);
+}
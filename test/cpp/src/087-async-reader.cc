@@ -0,0 +1,72 @@
+#include <catch.hpp>
+
+#include <sstream>
+
+#include "async_reader.h"
+#include "trace_fixtures.h"
+#include "tracereader.h"
+
+namespace {
+using reader_type = champsim::bulk_tracereader<input_instr, std::istringstream>;
+}
+
+TEST_CASE("An asynchronous tracereader reads the same instructions as a synchronous one") {
+  auto depth = GENERATE(as<std::size_t>{}, 1, 2, 16);
+  auto data = champsim::test::trace_of_length(2000);
+
+  champsim::tracereader reader{reader_type{0, std::istringstream{data}}};
+  champsim::tracereader uut{champsim::async_reader<reader_type>{reader_type{0, std::istringstream{data}}, depth}};
+
+  while (!reader.eof()) {
+    REQUIRE_FALSE(uut.eof());
+    auto expected = reader();
+    auto actual = uut();
+    REQUIRE(actual.ip == expected.ip);
+    REQUIRE(actual.branch_target == expected.branch_target);
+  }
+
+  CHECK(uut.eof());
+  CHECK(uut.num_read() == reader.num_read());
+}
+
+TEST_CASE("An asynchronous tracereader resumes at the same instruction as a skipping one") {
+  auto length = GENERATE(as<uint64_t>{}, 1, 255, 256, 700, 1500);
+  auto data = champsim::test::trace_of_length(2000);
+
+  reader_type reader{0, std::istringstream{data}};
+  champsim::async_reader<reader_type> uut{reader_type{0, std::istringstream{data}}, 2};
+
+  // Start partway through a batch
+  for (auto i = 0; i < 3; ++i) {
+    (void)reader();
+    (void)uut();
+  }
+
+  REQUIRE(reader.skip(length) == length);
+  REQUIRE(uut.skip(length) == length);
+
+  for (auto i = 0; i < 200; ++i) {
+    auto expected = reader();
+    auto actual = uut();
+    REQUIRE(actual.ip == expected.ip);
+    REQUIRE(actual.branch_target == expected.branch_target);
+  }
+}
+
+TEST_CASE("An asynchronous tracereader skips no further than the end of the trace") {
+  champsim::tracereader uut{champsim::async_reader<reader_type>{reader_type{0, std::istringstream{champsim::test::trace_of_length(10)}}, 4}};
+  (void)uut();
+
+  CHECK(uut.skip(100) == 9);
+  CHECK(uut.num_read() == 10);
+  CHECK(uut.eof());
+}
+
+TEST_CASE("An asynchronous tracereader can be moved while it reads") {
+  auto data = champsim::test::trace_of_length(1000);
+  champsim::async_reader<reader_type> original{reader_type{0, std::istringstream{data}}, 2};
+  (void)original();
+
+  auto uut = std::move(original);
+  CHECK(uut().ip == 0x1004);
+}
@@ -0,0 +1,98 @@
+#include <catch.hpp>
+
+#include <sstream>
+
+#include "seekable_zstd.h"
+#include "trace_fixtures.h"
+#include "tracereader.h"
+
+namespace {
+std::string compress_in_frames(const std::string& data, std::size_t frame_instructions, bool with_table = true) {
+  std::ostringstream result;
+  champsim::seekable_zstd::writer writer{result, 3};
+  for (std::size_t offset = 0; offset < std::size(data); offset += frame_instructions * sizeof(input_instr)) {
+    auto size = std::min(frame_instructions * sizeof(input_instr), std::size(data) - offset);
+    REQUIRE(writer.write_frame(std::data(data) + offset, size));
+  }
+  if (with_table)
+    writer.finish();
+  return result.str();
+}
+
+using stream_type = champsim::seekable_zstd::istream<std::istringstream>;
+using reader_type = champsim::bulk_tracereader<input_instr, stream_type>;
+}
+
+TEST_CASE("The seek table locates each frame of a seekable zstd stream") {
+  auto data = champsim::test::trace_of_length(2000);
+  std::istringstream compressed{compress_in_frames(data, 300)};
+
+  auto frames = champsim::seekable_zstd::read_seek_table(compressed);
+  REQUIRE(std::size(frames) == 7);
+  CHECK(frames.front().compressed_offset == 0);
+  for (std::size_t i = 0; i < std::size(frames); ++i)
+    CHECK(frames.at(i).inflated_offset == i * 300 * sizeof(input_instr));
+
+  // The stream is left at its start
+  CHECK(compressed.tellg() == 0);
+}
+
+TEST_CASE("A stream without a seek table has no frames") {
+  std::istringstream compressed{compress_in_frames(champsim::test::trace_of_length(100), 30, false)};
+  CHECK(std::empty(champsim::seekable_zstd::read_seek_table(compressed)));
+}
+
+TEST_CASE("A seekable zstd stream reads every frame in order") {
+  auto with_table = GENERATE(true, false);
+  auto data = champsim::test::trace_of_length(2000);
+
+  stream_type uut{std::istringstream{compress_in_frames(data, 300, with_table)}};
+  std::string inflated(std::size(data), '\0');
+  uut.read(std::data(inflated), static_cast<std::streamsize>(std::size(inflated)));
+
+  REQUIRE(uut.gcount() == static_cast<std::streamsize>(std::size(data)));
+  CHECK(inflated == data);
+}
+
+TEST_CASE("A tracereader over a seekable zstd stream resumes at the same instruction as a reading one") {
+  auto length = GENERATE(as<uint64_t>{}, 1, 297, 298, 600, 1500);
+  auto with_table = GENERATE(true, false);
+  auto data = champsim::test::trace_of_length(2000);
+
+  champsim::bulk_tracereader<input_instr, std::istringstream> reader{0, std::istringstream{data}};
+  reader_type uut{0, stream_type{std::istringstream{compress_in_frames(data, 300, with_table)}}};
+
+  for (auto i = 0; i < 3; ++i) {
+    (void)reader();
+    (void)uut();
+  }
+
+  REQUIRE(reader.skip(length) == length);
+  REQUIRE(uut.skip(length) == length);
+
+  for (auto i = 0; i < 200; ++i) {
+    auto expected = reader();
+    auto actual = uut();
+    REQUIRE(actual.ip == expected.ip);
+    REQUIRE(actual.branch_target == expected.branch_target);
+  }
+}
+
+TEST_CASE("A seekable zstd stream does not inflate the frames that it skips") {
+  auto data = champsim::test::trace_of_length(2000);
+  auto compressed = compress_in_frames(data, 300);
+
+  // Corrupt the second frame. Only a stream that jumps past it can read the fourth.
+  std::istringstream table_source{compressed};
+  auto frames = champsim::seekable_zstd::read_seek_table(table_source);
+  for (auto i = frames.at(1).compressed_offset + 10; i < frames.at(2).compressed_offset - 4; ++i)
+    compressed.at(i) = '\0';
+
+  stream_type uut{std::istringstream{compressed}};
+  uut.ignore(static_cast<std::streamsize>(frames.at(3).inflated_offset + 5 * sizeof(input_instr)));
+  REQUIRE(uut.gcount() == static_cast<std::streamsize>(frames.at(3).inflated_offset + 5 * sizeof(input_instr)));
+
+  input_instr instr;
+  uut.read(reinterpret_cast<char*>(&instr), sizeof(instr));
+  CHECK(instr.ip == 0x1000 + 4 * (900 + 5));
+}
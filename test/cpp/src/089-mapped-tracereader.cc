@@ -0,0 +1,84 @@
+#include <catch.hpp>
+
+#include <sstream>
+#include <string>
+
+#include "mapped_tracereader.h"
+#include "trace_fixtures.h"
+#include "tracereader.h"
+
+TEST_CASE("A mapped tracereader reads the same instructions as a bulk tracereader") {
+  auto length = GENERATE(as<uint64_t>{}, 1, 2, 300, 1000);
+  auto data = champsim::test::trace_of_length(length);
+  champsim::test::temp_file file{data};
+
+  champsim::tracereader reader{champsim::bulk_tracereader<input_instr, std::istringstream>{0, std::istringstream{data}}};
+  champsim::tracereader uut{champsim::mapped_tracereader<input_instr>{0, file.name}};
+
+  // A bulk tracereader only knows it has reached the end once it has read
+  (void)reader();
+  (void)uut();
+
+  while (!reader.eof()) {
+    REQUIRE_FALSE(uut.eof());
+    auto expected = reader();
+    auto actual = uut();
+    REQUIRE(actual.ip == expected.ip);
+    REQUIRE(actual.branch_target == expected.branch_target);
+    REQUIRE(actual.source_memory == expected.source_memory);
+  }
+
+  CHECK(uut.eof());
+  CHECK(uut.num_read() == reader.num_read());
+}
+
+TEST_CASE("A mapped tracereader resumes at the same instruction as a skipping one") {
+  auto length = GENERATE(as<uint64_t>{}, 1, 126, 500);
+  auto data = champsim::test::trace_of_length(1000);
+  champsim::test::temp_file file{data};
+
+  champsim::bulk_tracereader<input_instr, std::istringstream> reader{0, std::istringstream{data}};
+  champsim::mapped_tracereader<input_instr> uut{0, file.name};
+
+  REQUIRE(reader.skip(length) == length);
+  REQUIRE(uut.skip(length) == length);
+
+  for (auto i = 0; i < 200; ++i) {
+    auto expected = reader();
+    auto actual = uut();
+    REQUIRE(actual.ip == expected.ip);
+    REQUIRE(actual.branch_target == expected.branch_target);
+  }
+}
+
+TEST_CASE("A mapped tracereader skips no further than the end of the trace") {
+  champsim::test::temp_file file{champsim::test::trace_of_length(10)};
+  champsim::tracereader uut{champsim::mapped_tracereader<input_instr>{0, file.name}};
+  (void)uut();
+
+  CHECK(uut.skip(100) == 9);
+  CHECK(uut.num_read() == 10);
+  CHECK(uut.eof());
+}
+
+TEST_CASE("A mapped tracereader ignores a partial record at the end of the file") {
+  auto data = champsim::test::trace_of_length(3);
+  champsim::test::temp_file file{data.substr(0, std::size(data) - 1)};
+  champsim::mapped_tracereader<input_instr> uut{0, file.name};
+
+  CHECK(uut().ip == 0x1000);
+  CHECK(uut.eof());
+}
+
+TEST_CASE("An empty trace is at its end when it is mapped") {
+  champsim::test::temp_file file{""};
+  champsim::mapped_tracereader<input_instr> uut{0, file.name};
+  CHECK(uut.eof());
+}
+
+TEST_CASE("Uncompressed traces are mapped") {
+  champsim::test::temp_file file{champsim::test::trace_of_length(10)};
+  auto uut = get_tracereader(file.name, 0, false, false);
+  CHECK(uut().ip == 0x1000);
+  CHECK(uut().ip == 0x1004);
+}
@@ -0,0 +1,143 @@
+#include <catch.hpp>
+
+#include <sstream>
+
+#include <lzma.h>
+#include <zlib.h>
+
+#include "seek_index.h"
+#include "trace_fixtures.h"
+#include "tracereader.h"
+
+namespace {
+std::string gzip_compress(const std::string& data) {
+  z_stream strm{};
+  REQUIRE(deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+  std::string result(deflateBound(&strm, static_cast<uLong>(std::size(data))), '\0');
+  strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(std::data(data)));
+  strm.avail_in = static_cast<uInt>(std::size(data));
+  strm.next_out = reinterpret_cast<Bytef*>(std::data(result));
+  strm.avail_out = static_cast<uInt>(std::size(result));
+  REQUIRE(deflate(&strm, Z_FINISH) == Z_STREAM_END);
+  result.resize(strm.total_out);
+  deflateEnd(&strm);
+  return result;
+}
+
+// Each piece is compressed as its own stream, with one block each
+std::string xz_compress_in_pieces(const std::string& data, std::size_t piece_size) {
+  std::string result;
+  for (std::size_t offset = 0; offset < std::size(data); offset += piece_size) {
+    auto piece = std::min(piece_size, std::size(data) - offset);
+    std::string compressed(lzma_stream_buffer_bound(piece), '\0');
+    std::size_t out_pos = 0;
+    REQUIRE(lzma_easy_buffer_encode(1, LZMA_CHECK_CRC64, nullptr, reinterpret_cast<const uint8_t*>(std::data(data) + offset), piece,
+                                    reinterpret_cast<uint8_t*>(std::data(compressed)), &out_pos, std::size(compressed)) == LZMA_OK);
+    result.append(std::data(compressed), out_pos);
+  }
+  return result;
+}
+
+champsim::seek_index::istream indexed_stream(const std::string& compressed, champsim::seek_index::index idx) {
+  return champsim::seek_index::istream{std::make_unique<std::istringstream>(compressed), std::move(idx)};
+}
+}
+
+TEST_CASE("A gzip seek index places points apart by the span") {
+  auto data = champsim::test::trace_of_length(20000);
+  std::istringstream compressed{gzip_compress(data)};
+  auto idx = champsim::seek_index::build_gzip(compressed, 100000);
+
+  CHECK(idx.fmt == champsim::seek_index::format::gzip);
+  REQUIRE(std::size(idx.points) > 3);
+  for (auto it = std::next(std::begin(idx.points)); it != std::end(idx.points); ++it)
+    CHECK(it->inflated_offset - std::prev(it)->inflated_offset >= 100000);
+}
+
+TEST_CASE("An xz seek index has a point at each block") {
+  auto data = champsim::test::trace_of_length(5000);
+  std::istringstream compressed{xz_compress_in_pieces(data, 1000 * sizeof(input_instr))};
+  auto idx = champsim::seek_index::build_xz(compressed);
+
+  CHECK(idx.fmt == champsim::seek_index::format::xz);
+  REQUIRE(std::size(idx.points) == 5);
+  for (std::size_t i = 0; i < std::size(idx.points); ++i)
+    CHECK(idx.points.at(i).inflated_offset == i * 1000 * sizeof(input_instr));
+}
+
+TEST_CASE("A seek index can be written and read back") {
+  auto data = champsim::test::trace_of_length(20000);
+  auto compressed = gzip_compress(data);
+  std::istringstream source{compressed};
+  auto idx = champsim::seek_index::build_gzip(source, 100000);
+
+  std::stringstream sidecar;
+  champsim::seek_index::write(sidecar, idx);
+  auto uut = champsim::seek_index::read(sidecar);
+
+  CHECK(uut.fmt == idx.fmt);
+  CHECK(uut.compressed_size == std::size(compressed));
+  REQUIRE(std::size(uut.points) == std::size(idx.points));
+  for (std::size_t i = 0; i < std::size(idx.points); ++i) {
+    CHECK(uut.points.at(i).inflated_offset == idx.points.at(i).inflated_offset);
+    CHECK(uut.points.at(i).compressed_offset == idx.points.at(i).compressed_offset);
+    CHECK(uut.points.at(i).bits == idx.points.at(i).bits);
+    CHECK(uut.points.at(i).window == idx.points.at(i).window);
+  }
+}
+
+TEST_CASE("A file that is not a seek index is rejected") {
+  std::istringstream sidecar{"not an index"};
+  CHECK_THROWS_AS(champsim::seek_index::read(sidecar), std::runtime_error);
+}
+
+TEST_CASE("A tracereader over an indexed trace resumes at the same instruction as a reading one") {
+  auto is_xz = GENERATE(false, true);
+  auto length = GENERATE(as<uint64_t>{}, 1, 1500, 2500, 9000, 17000);
+  auto data = champsim::test::trace_of_length(20000);
+
+  auto compressed = is_xz ? xz_compress_in_pieces(data, 1000 * sizeof(input_instr)) : gzip_compress(data);
+  std::istringstream source{compressed};
+  auto idx = is_xz ? champsim::seek_index::build_xz(source) : champsim::seek_index::build_gzip(source, 100000);
+
+  champsim::bulk_tracereader<input_instr, std::istringstream> reader{0, std::istringstream{data}};
+  champsim::bulk_tracereader<input_instr, champsim::seek_index::istream> uut{0, indexed_stream(compressed, std::move(idx))};
+
+  for (auto i = 0; i < 3; ++i) {
+    (void)reader();
+    (void)uut();
+  }
+
+  REQUIRE(reader.skip(length) == length);
+  REQUIRE(uut.skip(length) == length);
+
+  while (!reader.eof()) {
+    REQUIRE_FALSE(uut.eof());
+    auto expected = reader();
+    auto actual = uut();
+    REQUIRE(actual.ip == expected.ip);
+    REQUIRE(actual.branch_target == expected.branch_target);
+    REQUIRE(actual.source_memory == expected.source_memory);
+  }
+  CHECK(uut.eof());
+}
+
+TEST_CASE("An indexed xz trace does not inflate the blocks that it skips") {
+  auto data = champsim::test::trace_of_length(5000);
+  auto compressed = xz_compress_in_pieces(data, 1000 * sizeof(input_instr));
+  std::istringstream source{compressed};
+  auto idx = champsim::seek_index::build_xz(source);
+
+  // Damage the data of the second block. Only a stream that jumps past it can read the fourth.
+  for (auto i = idx.points.at(1).compressed_offset + 40; i < idx.points.at(1).compressed_offset + 60; ++i)
+    compressed.at(i) = '\0';
+
+  auto target = idx.points.at(3).inflated_offset + 5 * sizeof(input_instr);
+  auto uut = indexed_stream(compressed, std::move(idx));
+  uut.ignore(static_cast<std::streamsize>(target));
+  REQUIRE(uut.gcount() == static_cast<std::streamsize>(target));
+
+  input_instr instr;
+  uut.read(reinterpret_cast<char*>(&instr), sizeof(instr));
+  CHECK(instr.ip == 0x1000 + 4 * (3000 + 5));
+}
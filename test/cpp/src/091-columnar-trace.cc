@@ -0,0 +1,188 @@
+#include <catch.hpp>
+
+#include <sstream>
+
+#include "columnar_trace.h"
+#include "columnar_tracereader.h"
+#include "tracereader.h"
+
+namespace {
+template <typename T>
+T record_at(uint64_t i)
+{
+  T instr{};
+  instr.ip = 0x400000 + 4 * i - 0x1000 * (i % 13);
+  instr.is_branch = (i % 5 == 0);
+  instr.branch_taken = (i % 10 == 0);
+  instr.destination_registers[0] = static_cast<unsigned char>(i % 3 == 0 ? champsim::REG_INSTRUCTION_POINTER : 0);
+  instr.source_registers[0] = static_cast<unsigned char>(1 + i % 60);
+  instr.source_registers[1] = static_cast<unsigned char>(i % 4 == 0 ? champsim::REG_FLAGS : 0);
+  instr.source_memory[0] = (i % 2 == 0) ? 0x7fff00000000 + 8 * i : 0;
+  instr.destination_memory[0] = (i % 7 == 0) ? 0xffffffffffffffc0 - 64 * i : 0;
+  if constexpr (std::is_same_v<T, cloudsuite_instr>) {
+    instr.asid[0] = static_cast<unsigned char>(i % 3);
+    instr.asid[1] = static_cast<unsigned char>(i % 5);
+  }
+  return instr;
+}
+
+template <typename T>
+std::string fixed_trace(uint64_t length)
+{
+  std::string result;
+  for (uint64_t i = 0; i < length; ++i) {
+    auto instr = record_at<T>(i);
+    result.append(reinterpret_cast<const char*>(&instr), sizeof(instr));
+  }
+  return result;
+}
+
+template <typename T>
+std::string columnar_trace(uint64_t length, std::size_t block_instructions)
+{
+  std::ostringstream result;
+  auto kind = std::is_same_v<T, cloudsuite_instr> ? champsim::columnar::record_kind::cloudsuite : champsim::columnar::record_kind::standard;
+  champsim::columnar::writer uut{result, kind, block_instructions};
+  for (uint64_t i = 0; i < length; ++i)
+    uut.write(record_at<T>(i));
+  uut.flush();
+  return result.str();
+}
+
+template <typename T>
+bool same_record(const T& lhs, const T& rhs)
+{
+  return std::memcmp(&lhs, &rhs, sizeof(T)) == 0;
+}
+}
+
+TEMPLATE_TEST_CASE("A columnar trace holds the same records as the fixed-size trace", "", input_instr, cloudsuite_instr) {
+  auto block_instructions = GENERATE(as<std::size_t>{}, 1, 100, 4096);
+  champsim::columnar::block_reader<std::istringstream> uut{std::istringstream{columnar_trace<TestType>(1000, block_instructions)}};
+
+  std::vector<TestType> records;
+  while (!uut.eof())
+    uut.read_block(records);
+
+  REQUIRE(std::size(records) == 1000);
+  for (uint64_t i = 0; i < std::size(records); ++i)
+    REQUIRE(same_record(records.at(i), record_at<TestType>(i)));
+}
+
+TEST_CASE("A columnar trace does not store empty slots") {
+  input_instr instr{};
+  instr.ip = 0xdeadbeef;
+  instr.source_registers[2] = 7;
+  instr.source_memory[3] = 0xcafe;
+
+  std::ostringstream trace;
+  champsim::columnar::writer writer{trace, champsim::columnar::record_kind::standard};
+  writer.write(instr);
+  writer.flush();
+
+  champsim::columnar::block_reader<std::istringstream> uut{std::istringstream{trace.str()}};
+  std::vector<input_instr> records;
+  uut.read_block(records);
+
+  REQUIRE(std::size(records) == 1);
+  CHECK(records.front().ip == 0xdeadbeef);
+  CHECK(records.front().source_registers[0] == 7);
+  CHECK(records.front().source_registers[2] == 0);
+  CHECK(records.front().source_memory[0] == 0xcafe);
+  CHECK(records.front().source_memory[3] == 0);
+}
+
+TEST_CASE("A columnar writer rejects records of the other kind") {
+  std::ostringstream trace;
+  champsim::columnar::writer uut{trace, champsim::columnar::record_kind::standard};
+  CHECK_THROWS_AS(uut.write(cloudsuite_instr{}), std::invalid_argument);
+}
+
+TEST_CASE("A columnar trace is recognized by its header") {
+  CHECK(champsim::columnar::has_header(std::istringstream{columnar_trace<input_instr>(10, 4)}));
+  CHECK_FALSE(champsim::columnar::has_header(std::istringstream{fixed_trace<input_instr>(10)}));
+  CHECK_THROWS_AS(champsim::columnar::block_reader<std::istringstream>{std::istringstream{fixed_trace<input_instr>(10)}}, std::runtime_error);
+}
+
+TEST_CASE("A peeked stream reads back the bytes that were checked for a header") {
+  auto length = GENERATE(as<uint64_t>{}, 1, 10, 300);
+  champsim::bulk_tracereader<input_instr, std::istringstream> reader{0, std::istringstream{fixed_trace<input_instr>(length)}};
+
+  champsim::columnar::peeked_stream<std::istringstream> stream{std::istringstream{fixed_trace<input_instr>(length)}};
+  REQUIRE_FALSE(stream.has_header());
+  champsim::bulk_tracereader<input_instr, champsim::columnar::peeked_stream<std::istringstream>> uut{0, std::move(stream)};
+
+  // A bulk tracereader only knows it has reached the end once it has read
+  REQUIRE(uut().ip == reader().ip);
+  while (!reader.eof()) {
+    REQUIRE_FALSE(uut.eof());
+    REQUIRE(uut().ip == reader().ip);
+  }
+  CHECK(uut.eof());
+}
+
+TEST_CASE("A columnar tracereader reads from the stream that was checked for its header") {
+  champsim::columnar::peeked_stream<std::istringstream> stream{std::istringstream{columnar_trace<input_instr>(10, 4)}};
+  REQUIRE(stream.has_header());
+  champsim::columnar_tracereader<champsim::columnar::peeked_stream<std::istringstream>> uut{0, std::move(stream)};
+
+  for (uint64_t i = 0; i < 10; ++i)
+    REQUIRE(uut().ip == record_at<input_instr>(i).ip);
+}
+
+TEST_CASE("A malformed columnar block is rejected") {
+  // The block claims to hold two instructions, but its columns are empty
+  auto trace = columnar_trace<input_instr>(0, 100);
+  trace.append({2, 3, 0, 0, 0});
+
+  champsim::columnar::block_reader<std::istringstream> uut{std::istringstream{trace}};
+  std::vector<input_instr> records;
+  CHECK_THROWS_AS(uut.read_block(records), std::runtime_error);
+}
+
+TEMPLATE_TEST_CASE("A columnar tracereader reads the same instructions as a bulk tracereader", "", input_instr, cloudsuite_instr) {
+  auto block_instructions = GENERATE(as<std::size_t>{}, 1, 100, 4096);
+  champsim::bulk_tracereader<TestType, std::istringstream> reader{0, std::istringstream{fixed_trace<TestType>(1000)}};
+  champsim::columnar_tracereader<std::istringstream> uut{0, std::istringstream{columnar_trace<TestType>(1000, block_instructions)}};
+
+  while (!reader.eof()) {
+    REQUIRE_FALSE(uut.eof());
+    auto expected = reader();
+    auto actual = uut();
+    REQUIRE(actual.ip == expected.ip);
+    REQUIRE(actual.is_branch == expected.is_branch);
+    REQUIRE(actual.branch_taken == expected.branch_taken);
+    REQUIRE(actual.branch_type == expected.branch_type);
+    REQUIRE(actual.branch_target == expected.branch_target);
+    REQUIRE(actual.asid == expected.asid);
+    REQUIRE(actual.source_registers == expected.source_registers);
+    REQUIRE(actual.destination_registers == expected.destination_registers);
+    REQUIRE(actual.source_memory == expected.source_memory);
+    REQUIRE(actual.destination_memory == expected.destination_memory);
+  }
+  CHECK(uut.eof());
+}
+
+TEST_CASE("A columnar tracereader skips to the same instruction as a bulk tracereader") {
+  auto block_instructions = GENERATE(as<std::size_t>{}, 1, 100, 4096);
+  auto length = GENERATE(as<uint64_t>{}, 1, 97, 100, 250, 900);
+  champsim::bulk_tracereader<input_instr, std::istringstream> reader{0, std::istringstream{fixed_trace<input_instr>(1000)}};
+  champsim::columnar_tracereader<std::istringstream> uut{0, std::istringstream{columnar_trace<input_instr>(1000, block_instructions)}};
+
+  for (auto i = 0; i < 3; ++i) {
+    (void)reader();
+    (void)uut();
+  }
+
+  REQUIRE(reader.skip(length) == length);
+  REQUIRE(uut.skip(length) == length);
+
+  while (!reader.eof()) {
+    REQUIRE_FALSE(uut.eof());
+    auto expected = reader();
+    auto actual = uut();
+    REQUIRE(actual.ip == expected.ip);
+    REQUIRE(actual.branch_target == expected.branch_target);
+  }
+  CHECK(uut.eof());
+}
@@ -0,0 +1,189 @@
+#include <catch.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "decoded_cache.h"
+#include "trace_fixtures.h"
+#include "tracereader.h"
+
+namespace {
+// A directory that holds a trace and its cache
+struct cache_dir : champsim::test::temp_dir {
+  std::string trace_name = (path / "trace.champsimtrace").string();
+
+  explicit cache_dir(const std::string& data) {
+    std::ofstream{trace_name, std::ios::binary}.write(std::data(data), static_cast<std::streamsize>(std::size(data)));
+  }
+
+  std::string cache_name() const { return (path / "cache").string(); }
+};
+
+using source_type = champsim::bulk_tracereader<input_instr, std::ifstream>;
+
+void require_same(const ooo_model_instr& actual, const ooo_model_instr& expected) {
+  REQUIRE(actual.ip == expected.ip);
+  REQUIRE(actual.is_branch == expected.is_branch);
+  REQUIRE(actual.branch_taken == expected.branch_taken);
+  REQUIRE(actual.branch_type == expected.branch_type);
+  REQUIRE(actual.branch_target == expected.branch_target);
+  REQUIRE(actual.asid == expected.asid);
+  REQUIRE(actual.destination_registers == expected.destination_registers);
+  REQUIRE(actual.source_registers == expected.source_registers);
+  REQUIRE(actual.destination_memory == expected.destination_memory);
+  REQUIRE(actual.source_memory == expected.source_memory);
+}
+
+void record(const cache_dir& dir, uint64_t length) {
+  auto found = champsim::decoded_cache::find(dir.cache_name(), dir.trace_name, false);
+  REQUIRE(found.has_value());
+  REQUIRE_FALSE(found->exists);
+
+  champsim::decoded_cache::recording_reader<source_type> uut{*found, source_type{0, dir.trace_name}};
+  for (uint64_t i = 0; i < length && !uut.eof(); ++i)
+    (void)uut();
+}
+}
+
+TEST_CASE("A decoded record holds the instruction") {
+  auto data = champsim::test::trace_of_length(100);
+  std::istringstream stream{data};
+  champsim::bulk_tracereader<input_instr, std::istringstream> reader{3, std::move(stream)};
+
+  while (!reader.eof()) {
+    auto expected = reader();
+    std::vector<char> buffer;
+    champsim::decoded_cache::append_record(buffer, expected);
+    REQUIRE(std::size(buffer) == champsim::decoded_cache::record_size(std::data(buffer)));
+    require_same(champsim::decoded_cache::read_record(std::data(buffer), 3, false), expected);
+  }
+}
+
+TEST_CASE("A decoded cache header can be encoded and decoded") {
+  champsim::decoded_cache::header info{true, true, 0xdeadbeef, 123456789, 42};
+  auto encoded = champsim::decoded_cache::encode_header(info);
+  auto uut = champsim::decoded_cache::decode_header(std::data(encoded), std::size(encoded));
+
+  REQUIRE(uut.has_value());
+  CHECK(uut->cloudsuite == info.cloudsuite);
+  CHECK(uut->complete == info.complete);
+  CHECK(uut->source_crc == info.source_crc);
+  CHECK(uut->source_size == info.source_size);
+  CHECK(uut->count == info.count);
+
+  CHECK_FALSE(champsim::decoded_cache::decode_header(std::data(encoded), std::size(encoded) - 1).has_value());
+}
+
+TEST_CASE("A trace that was recorded is replayed from the decoded cache") {
+  auto cached_length = GENERATE(as<uint64_t>{}, 1, 500, 2000);
+  cache_dir dir{champsim::test::trace_of_length(1000)};
+  record(dir, cached_length);
+
+  auto found = champsim::decoded_cache::find(dir.cache_name(), dir.trace_name, false);
+  REQUIRE(found.has_value());
+  REQUIRE(found->exists);
+
+  source_type reader{0, dir.trace_name};
+  champsim::decoded_cache::replay_reader<source_type> uut{*found, 0, source_type{0, dir.trace_name}};
+  while (!reader.eof()) {
+    REQUIRE_FALSE(uut.eof());
+    require_same(uut(), reader());
+  }
+  CHECK(uut.eof());
+}
+
+TEST_CASE("A replayed trace skips to the same instruction as the trace") {
+  auto cached_length = GENERATE(as<uint64_t>{}, 100, 2000);
+  auto skip_length = GENERATE(as<uint64_t>{}, 1, 50, 300);
+  cache_dir dir{champsim::test::trace_of_length(1000)};
+  record(dir, cached_length);
+
+  auto found = champsim::decoded_cache::find(dir.cache_name(), dir.trace_name, false);
+  REQUIRE(found.has_value());
+
+  source_type reader{0, dir.trace_name};
+  champsim::decoded_cache::replay_reader<source_type> uut{*found, 0, source_type{0, dir.trace_name}};
+  for (auto i = 0; i < 3; ++i)
+    require_same(uut(), reader());
+
+  REQUIRE(uut.skip(skip_length) == reader.skip(skip_length));
+  while (!reader.eof()) {
+    REQUIRE_FALSE(uut.eof());
+    require_same(uut(), reader());
+  }
+  CHECK(uut.eof());
+}
+
+TEST_CASE("The decoded cache ends at the first skip") {
+  cache_dir dir{champsim::test::trace_of_length(1000)};
+  {
+    auto found = champsim::decoded_cache::find(dir.cache_name(), dir.trace_name, false);
+    REQUIRE(found.has_value());
+    champsim::decoded_cache::recording_reader<source_type> uut{*found, source_type{0, dir.trace_name}};
+    for (auto i = 0; i < 10; ++i)
+      (void)uut();
+    uut.skip(100);
+    for (auto i = 0; i < 10; ++i)
+      (void)uut();
+  }
+
+  auto found = champsim::decoded_cache::find(dir.cache_name(), dir.trace_name, false);
+  REQUIRE(found.has_value());
+  REQUIRE(found->exists);
+
+  std::ifstream cache{found->name, std::ios::binary};
+  std::array<char, champsim::decoded_cache::header_size> header;
+  cache.read(std::data(header), std::size(header));
+  auto info = champsim::decoded_cache::decode_header(std::data(header), std::size(header));
+  REQUIRE(info.has_value());
+  CHECK(info->count == 10);
+  CHECK_FALSE(info->complete);
+}
+
+TEST_CASE("A changed trace does not find the cache of the old one") {
+  cache_dir dir{champsim::test::trace_of_length(1000)};
+  record(dir, 100);
+
+  std::ofstream{dir.trace_name, std::ios::binary} << champsim::test::trace_of_length(1000, 4);
+  auto found = champsim::decoded_cache::find(dir.cache_name(), dir.trace_name, false);
+  REQUIRE(found.has_value());
+  CHECK_FALSE(found->exists);
+}
+
+TEST_CASE("A trace that cannot be read has no decoded cache") {
+  CHECK_FALSE(champsim::decoded_cache::find("/tmp", "/nonexistent/092-decoded-cache", false).has_value());
+}
+
+TEST_CASE("A repeating trace records its first pass and replays it") {
+  cache_dir dir{champsim::test::trace_of_length(1000)};
+  {
+    auto uut = get_tracereader(dir.trace_name, 0, false, true, 0, dir.cache_name());
+    for (auto i = 0; i < 1500; ++i)
+      (void)uut();
+  }
+
+  auto found = champsim::decoded_cache::find(dir.cache_name(), dir.trace_name, false);
+  REQUIRE(found.has_value());
+  REQUIRE(found->exists);
+
+  std::ifstream cache{found->name, std::ios::binary};
+  std::array<char, champsim::decoded_cache::header_size> header;
+  cache.read(std::data(header), std::size(header));
+  auto info = champsim::decoded_cache::decode_header(std::data(header), std::size(header));
+  REQUIRE(info.has_value());
+  CHECK(info->complete);
+
+  // Each pass reads the instructions that were recorded
+  uint64_t length = 0;
+  for (source_type reader{0, dir.trace_name}; !reader.eof(); ++length)
+    (void)reader();
+  CHECK(info->count == length);
+
+  auto uut = get_tracereader(dir.trace_name, 0, false, true, 0, dir.cache_name());
+  for (auto pass = 0; pass < 3; ++pass) {
+    source_type reader{0, dir.trace_name};
+    while (!reader.eof())
+      require_same(uut(), reader());
+  }
+}
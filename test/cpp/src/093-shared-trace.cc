@@ -0,0 +1,204 @@
+#include <catch.hpp>
+
+#include <sstream>
+
+#include "shared_trace.h"
+#include "trace_fixtures.h"
+#include "tracereader.h"
+
+namespace {
+using reader_type = champsim::bulk_tracereader<input_instr, std::istringstream>;
+
+// Like a repeatable reader, but without the message at the end of the trace
+struct repeating_reader {
+  std::string data;
+  uint8_t cpu;
+  reader_type intern{cpu, std::istringstream{data}};
+
+  ooo_model_instr operator()() {
+    if (intern.eof())
+      intern = reader_type{cpu, std::istringstream{data}};
+    return intern();
+  }
+
+  uint64_t skip(uint64_t count) {
+    uint64_t skipped = 0;
+    while (skipped < count) {
+      if (intern.eof())
+        intern = reader_type{cpu, std::istringstream{data}};
+      skipped += intern.skip(count - skipped);
+    }
+    return skipped;
+  }
+
+  bool eof() const { return false; }
+};
+
+std::shared_ptr<champsim::shared_trace::source> source_of(const std::string& data, bool repeat = false,
+                                                          std::size_t capacity = champsim::shared_trace::default_capacity) {
+  auto open = [data](uint8_t cpu, bool reader_repeat) {
+    if (reader_repeat)
+      return champsim::any_reader{repeating_reader{data, cpu}};
+    return champsim::any_reader{reader_type{cpu, std::istringstream{data}}};
+  };
+  return std::make_shared<champsim::shared_trace::source>(open(champsim::shared_trace::anonymous_cpu, false), open, "093-shared-trace", repeat, capacity);
+}
+}
+
+TEST_CASE("Cursors into a shared trace read the same instructions as their own readers") {
+  auto data = champsim::test::trace_of_length(5000);
+  auto source = source_of(data);
+
+  reader_type reader{0, std::istringstream{data}};
+  champsim::shared_trace::reader first{source, 0};
+  champsim::shared_trace::reader second{source, 1};
+
+  // The cursors take turns, and the second falls behind the first
+  while (!reader.eof()) {
+    REQUIRE_FALSE(first.eof());
+    auto expected = reader();
+    auto actual = first();
+    REQUIRE(actual.ip == expected.ip);
+    REQUIRE(actual.branch_target == expected.branch_target);
+    REQUIRE(actual.source_memory == expected.source_memory);
+    REQUIRE(actual.asid == std::array<uint8_t, 2>{0, 0});
+  }
+  CHECK(first.eof());
+
+  reader_type second_reader{1, std::istringstream{data}};
+  while (!second_reader.eof()) {
+    REQUIRE_FALSE(second.eof());
+    auto expected = second_reader();
+    auto actual = second();
+    REQUIRE(actual.ip == expected.ip);
+    REQUIRE(actual.branch_target == expected.branch_target);
+    REQUIRE(actual.asid == std::array<uint8_t, 2>{1, 1});
+  }
+  CHECK(second.eof());
+}
+
+TEST_CASE("A cursor that falls too far behind a shared trace reads the trace on its own") {
+  auto data = champsim::test::trace_of_length(5000);
+  auto source = source_of(data, false, 1);
+
+  champsim::shared_trace::reader fast{source, 0};
+  champsim::shared_trace::reader slow{source, 1};
+  (void)slow();
+  for (auto i = 0; i < 3000; ++i)
+    (void)fast();
+
+  reader_type reader{1, std::istringstream{data}};
+  (void)reader();
+  while (!reader.eof()) {
+    REQUIRE_FALSE(slow.eof());
+    auto expected = reader();
+    auto actual = slow();
+    REQUIRE(actual.ip == expected.ip);
+    REQUIRE(actual.asid == std::array<uint8_t, 2>{1, 1});
+  }
+  CHECK(slow.eof());
+
+  for (auto i = 3000; i < 5000; ++i)
+    REQUIRE(fast().ip == 0x1000 + 4 * static_cast<uint64_t>(i));
+  CHECK(fast.eof());
+}
+
+TEST_CASE("Cursors into a shared trace skip to their own positions") {
+  auto first_length = GENERATE(as<uint64_t>{}, 0, 1, 1023, 1024, 3000);
+  auto second_length = GENERATE(as<uint64_t>{}, 0, 500, 2500);
+  auto data = champsim::test::trace_of_length(5000);
+  auto source = source_of(data);
+
+  champsim::tracereader first{champsim::shared_trace::reader{source, 0}};
+  champsim::tracereader second{champsim::shared_trace::reader{source, 1}};
+  REQUIRE(first.skip(first_length) == first_length);
+  REQUIRE(second.skip(second_length) == second_length);
+
+  for (uint64_t i = 0; i < 100; ++i) {
+    REQUIRE(first().ip == 0x1000 + 4 * (first_length + i));
+    REQUIRE(second().ip == 0x1000 + 4 * (second_length + i));
+  }
+  CHECK(first.num_read() == first_length + 100);
+}
+
+TEST_CASE("A cursor into a shared trace reaches the end of the trace") {
+  auto data = champsim::test::trace_of_length(10);
+  auto source = source_of(data);
+
+  champsim::shared_trace::reader first{source, 0};
+  champsim::shared_trace::reader second{source, 1};
+  CHECK(first.skip(100) == 100);
+  CHECK(first.eof());
+
+  reader_type reader{1, std::istringstream{data}};
+  while (!reader.eof()) {
+    REQUIRE_FALSE(second.eof());
+    REQUIRE(second().ip == reader().ip);
+  }
+  CHECK(second.eof());
+}
+
+TEST_CASE("Cursors into a repeating shared trace start it over") {
+  auto capacity = GENERATE(as<std::size_t>{}, 1, champsim::shared_trace::default_capacity);
+  auto data = champsim::test::trace_of_length(3000);
+  auto source = source_of(data, true, capacity);
+
+  reader_type reader{0, std::istringstream{data}};
+  std::vector<uint64_t> expected;
+  while (!reader.eof())
+    expected.push_back(reader().ip);
+
+  champsim::shared_trace::reader first{source, 0};
+  champsim::shared_trace::reader second{source, 1};
+  REQUIRE(second.skip(std::size(expected) - 10) == std::size(expected) - 10);
+  for (std::size_t i = 0; i < 3 * std::size(expected); ++i) {
+    REQUIRE_FALSE(first.eof());
+    REQUIRE(first().ip == expected.at(i % std::size(expected)));
+  }
+  for (std::size_t i = std::size(expected) - 10; i < 3 * std::size(expected); ++i) {
+    REQUIRE_FALSE(second.eof());
+    REQUIRE(second().ip == expected.at(i % std::size(expected)));
+  }
+}
+
+TEST_CASE("A repeating shared trace replays its later passes from memory") {
+  auto loop_capacity = GENERATE(as<std::size_t>{}, 1, std::size_t{1} << 20);
+  auto data = champsim::test::trace_of_length(3000);
+
+  int opened = 0;
+  auto open = [data, &opened](uint8_t cpu, bool) {
+    ++opened;
+    return champsim::any_reader{reader_type{cpu, std::istringstream{data}}};
+  };
+  auto source = std::make_shared<champsim::shared_trace::source>(open(champsim::shared_trace::anonymous_cpu, false), open, "093-shared-trace", true,
+                                                                 champsim::shared_trace::default_capacity, loop_capacity);
+
+  reader_type reader{0, std::istringstream{data}};
+  std::vector<uint64_t> expected;
+  while (!reader.eof())
+    expected.push_back(reader().ip);
+
+  champsim::shared_trace::reader first{source, 0};
+  champsim::shared_trace::reader second{source, 1};
+  REQUIRE(first.skip(1500) == 1500);
+  for (std::size_t i = 1500; i < 4 * std::size(expected); ++i)
+    REQUIRE(first().ip == expected.at(i % std::size(expected)));
+  for (std::size_t i = 0; i < 4 * std::size(expected); ++i)
+    REQUIRE(second().ip == expected.at(i % std::size(expected)));
+
+  if (loop_capacity > 1)
+    CHECK(opened == 1);
+  else
+    CHECK(opened >= 4);
+}
+
+TEST_CASE("Cursors can join a shared trace only before it is read") {
+  auto create = [] { return source_of(champsim::test::trace_of_length(100)); };
+
+  auto source = champsim::shared_trace::find_or_open("093-shared-trace", create);
+  CHECK(champsim::shared_trace::find_or_open("093-shared-trace", create) == source);
+
+  champsim::shared_trace::reader uut{source, 0};
+  (void)uut();
+  CHECK(champsim::shared_trace::find_or_open("093-shared-trace", create) != source);
+}
@@ -0,0 +1,64 @@
+#include <catch.hpp>
+
+#include <sstream>
+
+#include "shared_trace.h"
+#include "trace_fixtures.h"
+#include "tracereader.h"
+
+namespace {
+using reader_type = champsim::bulk_tracereader<input_instr, std::istringstream>;
+
+std::shared_ptr<champsim::shared_trace::source> source_of(const std::string& data) {
+  auto open = [data](uint8_t cpu, bool) { return champsim::any_reader{reader_type{cpu, std::istringstream{data}}}; };
+  return std::make_shared<champsim::shared_trace::source>(open(champsim::shared_trace::anonymous_cpu, false), open, "094-tracereader-fill", false);
+}
+}
+
+TEST_CASE("A filling tracereader reads the same instructions as a reading one") {
+  auto batch = GENERATE(as<std::size_t>{}, 1, 7, 256, 1000);
+  auto data = champsim::test::trace_of_length(2000);
+
+  champsim::tracereader reader{reader_type{0, std::istringstream{data}}};
+  champsim::tracereader uut{champsim::shared_trace::reader{source_of(data), 0}};
+
+  std::deque<ooo_model_instr> filled;
+  while (!uut.eof()) {
+    auto old_size = std::size(filled);
+    uut.fill(std::back_inserter(filled), batch);
+    REQUIRE((std::size(filled) - old_size == batch || uut.eof()));
+  }
+
+  for (const auto& actual : filled) {
+    REQUIRE_FALSE(reader.eof());
+    auto expected = reader();
+    REQUIRE(actual.ip == expected.ip);
+    REQUIRE(actual.branch_target == expected.branch_target);
+    REQUIRE(actual.asid == expected.asid);
+  }
+  CHECK(reader.eof());
+  CHECK(uut.num_read() == reader.num_read());
+}
+
+TEST_CASE("A filling tracereader produces monotonically increasing instruction IDs") {
+  champsim::tracereader uut{reader_type{0, std::istringstream{champsim::test::trace_of_length(100)}}};
+
+  std::vector<ooo_model_instr> filled;
+  uut.fill(std::back_inserter(filled), 10);
+  filled.push_back(uut());
+  uut.fill(std::back_inserter(filled), 10);
+
+  REQUIRE(std::size(filled) == 21);
+  for (std::size_t i = 1; i < std::size(filled); ++i)
+    REQUIRE(filled.at(i).instr_id == filled.at(i - 1).instr_id + 1);
+}
+
+TEST_CASE("A filling tracereader stops at the end of the trace") {
+  champsim::tracereader uut{champsim::shared_trace::reader{source_of(champsim::test::trace_of_length(10)), 0}};
+
+  std::vector<ooo_model_instr> filled;
+  uut.fill(std::back_inserter(filled), 100);
+  CHECK(std::size(filled) < 100);
+  CHECK(uut.num_read() == std::size(filled));
+  CHECK(uut.eof());
+}
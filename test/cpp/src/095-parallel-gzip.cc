@@ -0,0 +1,109 @@
+#include <catch.hpp>
+
+#include <sstream>
+#include <string>
+
+#include <zlib.h>
+
+#include "inf_stream.h"
+#include "parallel_gzip.h"
+#include "trace_fixtures.h"
+
+namespace {
+std::string text_of_length(std::size_t length, unsigned seed) {
+  std::string result;
+  for (std::size_t i = 0; i < length; ++i)
+    result.push_back(static_cast<char>('a' + (i * i + seed) % 23));
+  return result;
+}
+
+std::string gzip_member(const std::string& text, int level) {
+  z_stream strm{};
+  REQUIRE(deflateInit2(&strm, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+  std::string result(deflateBound(&strm, static_cast<uLong>(std::size(text))), '\0');
+  strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(std::data(text)));
+  strm.avail_in = static_cast<uInt>(std::size(text));
+  strm.next_out = reinterpret_cast<Bytef*>(std::data(result));
+  strm.avail_out = static_cast<uInt>(std::size(result));
+  REQUIRE(deflate(&strm, Z_FINISH) == Z_STREAM_END);
+  result.resize(strm.total_out);
+  deflateEnd(&strm);
+  return result;
+}
+
+template <typename S>
+std::string read_all(S&& stream) {
+  std::string result;
+  std::string buffer(1000, '\0');
+  while (!stream.eof()) {
+    stream.read(std::data(buffer), static_cast<std::streamsize>(std::size(buffer)));
+    result.append(std::data(buffer), static_cast<std::size_t>(stream.gcount()));
+  }
+  return result;
+}
+
+std::string inflate_on_one_thread(const std::string& data) {
+  return read_all(champsim::inf_istream<champsim::decomp_tags::gzip_tag_t<>, std::istringstream>{std::istringstream{data}});
+}
+}
+
+TEST_CASE("The members of a gzip trace are inflated in order on several threads") {
+  auto threads = GENERATE(as<unsigned>{}, 1, 2, 4);
+  auto span = GENERATE(as<std::size_t>{}, 64, 4096, champsim::parallel_gzip::default_span);
+
+  std::string data;
+  std::string expected;
+  for (unsigned i = 0; i < 50; ++i) {
+    auto text = text_of_length(1000 + 37 * i, i);
+    data += gzip_member(text, i % 10);
+    expected += text;
+  }
+  champsim::test::temp_file file{data};
+
+  CHECK(read_all(champsim::parallel_gzip::istream{file.name, threads, span}) == expected);
+}
+
+TEST_CASE("A gzip header inside a member does not split the member") {
+  auto threads = GENERATE(as<unsigned>{}, 1, 4);
+
+  // A stored member holds its text as it is, so the text's headers appear in the compressed trace
+  std::string header{'\x1f', '\x8b', '\x08', '\x00', '\x00', '\x00', '\x00', '\x00', '\x00', '\x03'};
+  std::string text;
+  for (unsigned i = 0; i < 200; ++i)
+    text += header + text_of_length(50, i);
+  auto data = gzip_member(text, 0) + gzip_member(text_of_length(5000, 1), 6) + gzip_member(text, 0);
+  champsim::test::temp_file file{data};
+
+  REQUIRE(champsim::parallel_gzip::find_member_start(std::data(data), std::size(data), 1, std::size(data)) < std::size(data));
+  CHECK(read_all(champsim::parallel_gzip::istream{file.name, threads, 256}) == inflate_on_one_thread(data));
+}
+
+TEST_CASE("A parallel gzip stream ends where a single thread would") {
+  auto threads = GENERATE(as<unsigned>{}, 1, 4);
+
+  std::string data;
+  for (unsigned i = 0; i < 20; ++i)
+    data += gzip_member(text_of_length(2000, i), 6);
+  auto tail = GENERATE(as<std::string>{}, "", std::string(512, '\0'), "not a member");
+  auto truncation = GENERATE(as<std::size_t>{}, 0, 100);
+  data = data.substr(0, std::size(data) - truncation) + tail;
+  champsim::test::temp_file file{data};
+
+  CHECK(read_all(champsim::parallel_gzip::istream{file.name, threads, 256}) == inflate_on_one_thread(data));
+}
+
+TEST_CASE("A parallel gzip stream ignores inflated bytes") {
+  std::string data;
+  std::string expected;
+  for (unsigned i = 0; i < 20; ++i) {
+    auto text = text_of_length(2000, i);
+    data += gzip_member(text, 6);
+    expected += text;
+  }
+  champsim::test::temp_file file{data};
+
+  champsim::parallel_gzip::istream uut{file.name, 4, 256};
+  uut.ignore(15000);
+  REQUIRE(uut.gcount() == 15000);
+  CHECK(read_all(uut) == expected.substr(15000));
+}
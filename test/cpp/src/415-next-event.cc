@@ -0,0 +1,96 @@
+#include <catch.hpp>
+#include "mocks.hpp"
+#include "defaults.hpp"
+#include "cache.h"
+#include "champsim_constants.h"
+
+SCENARIO("A cache reports when it next has work due") {
+  GIVEN("An empty cache") {
+    constexpr uint64_t hit_latency = 4;
+    constexpr uint64_t miss_latency = 30;
+    constexpr uint64_t fill_latency = 2;
+    do_nothing_MRC mock_ll{miss_latency};
+    to_rq_MRP mock_ul;
+    CACHE uut{CACHE::Builder{champsim::defaults::default_l1d}
+      .name("415-uut")
+      .upper_levels({&mock_ul.queues})
+      .lower_level(&mock_ll.queues)
+      .hit_latency(hit_latency)
+      .fill_latency(fill_latency)
+    };
+
+    std::array<champsim::operable*, 3> elements{{&uut, &mock_ll, &mock_ul}};
+
+    for (auto elem : elements) {
+      elem->initialize();
+      elem->warmup = false;
+      elem->begin_phase();
+    }
+
+    THEN("It can be skipped") {
+      REQUIRE(uut.prepare_skip());
+    }
+
+    WHEN("The cache is dormant and a packet is issued") {
+      REQUIRE(uut.prepare_skip());
+
+      decltype(mock_ul)::request_type test;
+      test.address = 0xdeadbeef;
+      test.cpu = 0;
+      test.type = access_type::LOAD;
+
+      auto test_result = mock_ul.issue(test);
+      REQUIRE(test_result);
+
+      THEN("It wakes up") {
+        REQUIRE_FALSE(uut.can_skip());
+      }
+    }
+
+    WHEN("A packet is issued") {
+      decltype(mock_ul)::request_type test;
+      test.address = 0xdeadbeef;
+      test.cpu = 0;
+      test.type = access_type::LOAD;
+
+      auto test_result = mock_ul.issue(test);
+      REQUIRE(test_result);
+
+      THEN("It cannot be skipped") {
+        REQUIRE_FALSE(uut.prepare_skip());
+      }
+
+      AND_WHEN("The miss is outstanding") {
+        for (uint64_t i = 0; i < 2*hit_latency; ++i)
+          for (auto elem : elements)
+            elem->_operate();
+
+        REQUIRE(uut.get_mshr_occupancy() == 1);
+
+        THEN("It can be skipped") {
+          REQUIRE(uut.prepare_skip());
+        }
+
+        AND_WHEN("The lower level returns the miss") {
+          for (uint64_t i = 0; i < 2*miss_latency && std::empty(mock_ll.queues.returned); ++i)
+            for (auto elem : elements)
+              elem->_operate();
+
+          REQUIRE_FALSE(std::empty(mock_ll.queues.returned));
+
+          THEN("It cannot be skipped") {
+            REQUIRE_FALSE(uut.prepare_skip());
+          }
+
+          AND_WHEN("The cache receives the return") {
+            uut._operate();
+
+            THEN("The next event is the fill") {
+              CHECK(uut.next_event_cycle() == uut.current_cycle - 1 + fill_latency);
+            }
+          }
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,47 @@
+#include "trace_fixtures.h"
+
+#include <catch.hpp>
+#include <cstdio>
+
+#include <unistd.h>
+
+#include "instruction.h"
+
+std::string champsim::test::trace_of_length(uint64_t length, uint64_t seed)
+{
+  std::string result;
+  for (uint64_t i = 0; i < length; ++i) {
+    input_instr instr{};
+    instr.ip = 0x1000 + 4 * i + seed;
+    instr.is_branch = (i % 7 == 0);
+    instr.branch_taken = instr.is_branch;
+    instr.destination_registers[1] = (i % 7 == 0) ? champsim::REG_INSTRUCTION_POINTER : 0;
+    instr.source_registers[0] = (i % 7 == 0) ? champsim::REG_FLAGS : static_cast<unsigned char>(30 + i % 4);
+    instr.source_registers[3] = (i % 7 == 0) ? champsim::REG_INSTRUCTION_POINTER : 0;
+    instr.source_memory[0] = 0x8000 + 64 * i;
+    instr.destination_memory[1] = (i % 3 == 0) ? 0xffff0000 + 8 * i : 0;
+    result.append(reinterpret_cast<const char*>(&instr), sizeof(instr));
+  }
+  return result;
+}
+
+champsim::test::temp_file::temp_file(const std::string& data)
+{
+  char buf[] = "/tmp/champsim-test-XXXXXX";
+  auto fd = mkstemp(buf);
+  REQUIRE(fd >= 0);
+  name = buf;
+  REQUIRE(write(fd, std::data(data), std::size(data)) == static_cast<ssize_t>(std::size(data)));
+  close(fd);
+}
+
+champsim::test::temp_file::~temp_file() { std::remove(name.c_str()); }
+
+champsim::test::temp_dir::temp_dir()
+{
+  char buf[] = "/tmp/champsim-test-XXXXXX";
+  REQUIRE(mkdtemp(buf) != nullptr);
+  path = buf;
+}
+
+champsim::test::temp_dir::~temp_dir() { std::filesystem::remove_all(path); }
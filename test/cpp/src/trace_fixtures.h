@@ -0,0 +1,33 @@
+#ifndef TEST_TRACE_FIXTURES_H
+#define TEST_TRACE_FIXTURES_H
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace champsim::test {
+// The contents of an uncompressed trace. Its instructions have branches, registers, and memory operands, and the seed offsets their addresses.
+std::string trace_of_length(uint64_t length, uint64_t seed = 0);
+
+// A file that holds the given data, and is removed when it goes out of scope
+struct temp_file {
+  std::string name;
+
+  explicit temp_file(const std::string& data);
+  temp_file(const temp_file&) = delete;
+  temp_file& operator=(const temp_file&) = delete;
+  ~temp_file();
+};
+
+// An empty directory that is removed, with its contents, when it goes out of scope
+struct temp_dir {
+  std::filesystem::path path;
+
+  temp_dir();
+  temp_dir(const temp_dir&) = delete;
+  temp_dir& operator=(const temp_dir&) = delete;
+  ~temp_dir();
+};
+}
+
+#endif
@@ -0,0 +1,44 @@
+import unittest
+import os
+import tempfile
+
+import config.modules
+
+class DefinesFunctionTests(unittest.TestCase):
+
+    def setUp(self):
+        self.dir = tempfile.TemporaryDirectory()
+
+    def tearDown(self):
+        self.dir.cleanup()
+
+    def module_with(self, name, source):
+        path = os.path.join(self.dir.name, name)
+        os.mkdir(path)
+        with open(os.path.join(path, name + '.cc'), 'wt') as wfp:
+            wfp.write(source)
+        return {'name': name, 'fname': path}
+
+    def test_required_functions_are_always_defined(self):
+        module = self.module_with('empty', '')
+        self.assertTrue(config.modules.defines_function(module, 'find_victim'))
+
+    def test_optional_function_is_found(self):
+        module = self.module_with('stateful', 'void CACHE::checkpoint_replacement(std::ostream& stream) {}')
+        self.assertTrue(config.modules.defines_function(module, 'checkpoint_replacement'))
+
+    def test_missing_optional_function(self):
+        module = self.module_with('stateless', 'void CACHE::replacement_final_stats() {}')
+        self.assertFalse(config.modules.defines_function(module, 'checkpoint_replacement'))
+
+class GetModuleVariantLinesTests(unittest.TestCase):
+
+    def test_missing_optional_function_does_nothing(self):
+        module = config.modules.get_repl_data('xxyzzy')
+        lines = list(config.modules.get_module_variant_lines('restore_replacement', [module], (('std::istream&','stream'),)))
+        self.assertIn('void repl_xxyzzy_restore_replacement(std::istream&) {}', lines)
+
+    def test_required_function_is_declared(self):
+        module = config.modules.get_repl_data('xxyzzy')
+        lines = list(config.modules.get_module_variant_lines('replacement_final_stats', [module]))
+        self.assertIn('[[]] void repl_xxyzzy_replacement_final_stats();', lines)
@@ -0,0 +1,158 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * Convert a ChampSim trace between the fixed-size record format and the columnar format. The direction is chosen by the format of the input.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <CLI/CLI.hpp>
+#include <fmt/core.h>
+
+#include "columnar_trace.h"
+#include "inf_stream.h"
+#include "seekable_zstd.h"
+#include "trace_instruction.h"
+
+namespace
+{
+bool ends_with(const std::string& name, const std::string& suffix)
+{
+  return std::size(name) >= std::size(suffix) && name.compare(std::size(name) - std::size(suffix), std::size(suffix), suffix) == 0;
+}
+
+// Call the function with a stream that inflates the named trace
+template <typename F>
+auto with_stream(const std::string& name, F&& func)
+{
+  if (ends_with(name, "gz"))
+    return func(champsim::inf_istream<champsim::decomp_tags::gzip_tag_t<>>{name});
+  if (ends_with(name, "xz"))
+    return func(champsim::inf_istream<champsim::decomp_tags::lzma_tag_t<>>{name});
+  if (ends_with(name, "bz2"))
+    return func(champsim::inf_istream<champsim::decomp_tags::bzip2_tag_t>{name});
+  if (ends_with(name, "zst"))
+    return func(champsim::seekable_zstd::istream<>{name});
+  return func(std::ifstream{name, std::ios::binary});
+}
+
+template <typename T, typename IStrm>
+uint64_t to_columnar(IStrm& source, std::ostream& dest, champsim::columnar::record_kind kind, std::size_t block_instructions)
+{
+  champsim::columnar::writer writer{dest, kind, block_instructions};
+  std::vector<T> buffer(block_instructions);
+  uint64_t count = 0;
+  while (!source.eof()) {
+    source.read(reinterpret_cast<char*>(std::data(buffer)), static_cast<std::streamsize>(std::size(buffer) * sizeof(T)));
+    auto num = static_cast<std::size_t>(source.gcount()) / sizeof(T);
+    if (num == 0)
+      break;
+
+    std::for_each_n(std::begin(buffer), num, [&writer](const T& instr) { writer.write(instr); });
+    count += num;
+  }
+  writer.flush();
+  return count;
+}
+
+template <typename T, typename IStrm>
+uint64_t write_records(champsim::columnar::block_reader<IStrm>& blocks, std::ostream& dest)
+{
+  std::vector<T> records;
+  uint64_t count = 0;
+  while (!blocks.eof()) {
+    records.clear();
+    blocks.read_block(records);
+    dest.write(reinterpret_cast<const char*>(std::data(records)), static_cast<std::streamsize>(std::size(records) * sizeof(T)));
+    count += std::size(records);
+  }
+  return count;
+}
+
+template <typename IStrm>
+uint64_t from_columnar(IStrm&& source, std::ostream& dest)
+{
+  champsim::columnar::block_reader<IStrm> blocks{std::move(source)};
+  if (blocks.kind() == champsim::columnar::record_kind::cloudsuite)
+    return write_records<cloudsuite_instr>(blocks, dest);
+  return write_records<input_instr>(blocks, dest);
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  CLI::App app{"Convert a ChampSim trace to or from the columnar format"};
+
+  std::string input_name;
+  std::string output_name;
+  std::size_t block_instructions = champsim::columnar::default_block_instructions;
+  bool cloudsuite{false};
+
+  app.add_option("input", input_name, "The trace to convert. It may be uncompressed, or compressed with gzip, xz, bzip2, or zstd.")
+      ->required()
+      ->check(CLI::ExistingFile);
+  app.add_option("output", output_name, "The name of the converted trace, which is not compressed. If it is -, the trace is written to standard output.")
+      ->required();
+  app.add_option("-b,--block-instructions", block_instructions, "The number of instructions in each block of a columnar trace")
+      ->check(CLI::PositiveNumber)
+      ->capture_default_str();
+  app.add_flag("-c,--cloudsuite", cloudsuite, "The fixed-size input uses the cloudsuite format");
+
+  CLI11_PARSE(app, argc, argv);
+
+  if (output_name == input_name) {
+    fmt::print(stderr, "The output would replace the input {}\n", input_name);
+    return 1;
+  }
+
+  std::ofstream output_file;
+  if (output_name != "-")
+    output_file.open(output_name, std::ios::binary);
+  std::ostream& output = (output_name == "-") ? std::cout : output_file;
+
+  // A columnar trace is converted to fixed-size records, and any other trace to the columnar format
+  auto is_columnar = with_stream(input_name, [](auto&& source) { return champsim::columnar::has_header(source); });
+
+  uint64_t count = 0;
+  try {
+    count = with_stream(input_name, [&](auto&& source) -> uint64_t {
+      if (is_columnar)
+        return from_columnar(std::move(source), output);
+      if (cloudsuite)
+        return to_columnar<cloudsuite_instr>(source, output, champsim::columnar::record_kind::cloudsuite, block_instructions);
+      return to_columnar<input_instr>(source, output, champsim::columnar::record_kind::standard, block_instructions);
+    });
+  } catch (const std::runtime_error& err) {
+    fmt::print(stderr, "Could not convert {}: {}\n", input_name, err.what());
+    return 1;
+  }
+
+  output.flush();
+  if (output.fail()) {
+    fmt::print(stderr, "Could not write {}\n", output_name);
+    return 1;
+  }
+
+  fmt::print(stderr, "{} instructions written to {} in the {} format\n", count, output_name, is_columnar ? "fixed-size" : "columnar");
+  return 0;
+}
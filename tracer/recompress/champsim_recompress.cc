@@ -0,0 +1,144 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * Recompress a ChampSim trace into the seekable zstd layout. Each frame holds a fixed number of instructions, so that a reader that skips ahead can
+ * jump to the frame that holds its target, instead of inflating everything before it.
+ */
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <CLI/CLI.hpp>
+#include <fmt/core.h>
+
+#include "inf_stream.h"
+#include "seekable_zstd.h"
+#include "trace_instruction.h"
+
+namespace
+{
+struct totals {
+  uint64_t frames = 0;
+  uint64_t inflated_bytes = 0;
+};
+
+template <typename IStrm>
+bool recompress(IStrm&& source, champsim::seekable_zstd::writer& writer, std::size_t frame_size, totals& result)
+{
+  std::vector<char> buffer(frame_size);
+  while (!source.eof()) {
+    source.read(std::data(buffer), static_cast<std::streamsize>(frame_size));
+    auto count = static_cast<std::size_t>(source.gcount());
+    if (count == 0)
+      break;
+
+    if (!writer.write_frame(std::data(buffer), count))
+      return false;
+
+    ++result.frames;
+    result.inflated_bytes += count;
+  }
+  return true;
+}
+
+bool ends_with(const std::string& name, const std::string& suffix)
+{
+  return std::size(name) >= std::size(suffix) && name.compare(std::size(name) - std::size(suffix), std::size(suffix), suffix) == 0;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  CLI::App app{"Recompress a ChampSim trace into the seekable zstd layout"};
+
+  std::string input_name;
+  std::string output_name;
+  uint64_t frame_instructions = 1000000;
+  int level = 19;
+  bool cloudsuite{false};
+
+  app.add_option("input", input_name, "The trace to recompress. It may be uncompressed, or compressed with gzip, xz, bzip2, or zstd.")
+      ->required()
+      ->check(CLI::ExistingFile);
+  app.add_option("output", output_name, "The name of the recompressed trace. By convention, it ends in .zst");
+  app.add_option("-f,--frame-instructions", frame_instructions, "The number of instructions in each independently compressed frame")
+      ->check(CLI::PositiveNumber)
+      ->capture_default_str();
+  app.add_option("-l,--level", level, "The zstd compression level")->check(CLI::Range(1, 22))->capture_default_str();
+  app.add_flag("-c,--cloudsuite", cloudsuite, "The trace uses the cloudsuite format");
+
+  CLI11_PARSE(app, argc, argv);
+
+  if (std::empty(output_name)) {
+    output_name = input_name;
+    for (std::string suffix : {".gz", ".xz", ".bz2", ".zst"}) {
+      if (ends_with(output_name, suffix))
+        output_name.erase(std::size(output_name) - std::size(suffix));
+    }
+    output_name += ".zst";
+  }
+
+  if (output_name == input_name) {
+    fmt::print(stderr, "The output would replace the input {}\n", input_name);
+    return 1;
+  }
+
+  // Frames hold whole instructions, so that a jump lands at the start of one
+  const auto instruction_size = cloudsuite ? sizeof(cloudsuite_instr) : sizeof(input_instr);
+  const auto frame_size = frame_instructions * instruction_size;
+  if (frame_size > UINT32_MAX) {
+    fmt::print(stderr, "Frames of {} instructions are too large for the seek table\n", frame_instructions);
+    return 1;
+  }
+
+  std::ofstream output{output_name, std::ios::binary};
+  champsim::seekable_zstd::writer writer{output, level};
+  totals result;
+
+  bool success;
+  if (ends_with(input_name, "gz"))
+    success = recompress(champsim::inf_istream<champsim::decomp_tags::gzip_tag_t<>>{input_name}, writer, frame_size, result);
+  else if (ends_with(input_name, "xz"))
+    success = recompress(champsim::inf_istream<champsim::decomp_tags::lzma_tag_t<>>{input_name}, writer, frame_size, result);
+  else if (ends_with(input_name, "bz2"))
+    success = recompress(champsim::inf_istream<champsim::decomp_tags::bzip2_tag_t>{input_name}, writer, frame_size, result);
+  else if (ends_with(input_name, "zst"))
+    success = recompress(champsim::seekable_zstd::istream<>{input_name}, writer, frame_size, result);
+  else
+    success = recompress(std::ifstream{input_name, std::ios::binary}, writer, frame_size, result);
+
+  if (!success) {
+    fmt::print(stderr, "Could not compress {}\n", input_name);
+    return 1;
+  }
+
+  writer.finish();
+  output.close();
+  if (output.fail()) {
+    fmt::print(stderr, "Could not write {}\n", output_name);
+    return 1;
+  }
+
+  if (result.inflated_bytes % instruction_size != 0)
+    fmt::print(stderr, "WARNING: {} ends with a partial instruction\n", input_name);
+
+  fmt::print("{} instructions in {} frames written to {}\n", result.inflated_bytes / instruction_size, result.frames, output_name);
+  return 0;
+}
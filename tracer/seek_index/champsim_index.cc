@@ -0,0 +1,89 @@
+/*
+ *    Copyright 2023 The ChampSim Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/*
+ * Build the seek index of gzip and xz traces. The index is written to a sidecar file next to each trace, where ChampSim finds it.
+ */
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <CLI/CLI.hpp>
+#include <fmt/core.h>
+
+#include "seek_index.h"
+#include "trace_instruction.h"
+
+namespace
+{
+bool ends_with(const std::string& name, const std::string& suffix)
+{
+  return std::size(name) >= std::size(suffix) && name.compare(std::size(name) - std::size(suffix), std::size(suffix), suffix) == 0;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  CLI::App app{"Build the seek index of gzip and xz traces"};
+
+  std::vector<std::string> trace_names;
+  uint64_t span_instructions = 1000000;
+  bool cloudsuite{false};
+
+  app.add_option("traces", trace_names, "The traces to index")->required()->check(CLI::ExistingFile);
+  app.add_option("-s,--span-instructions", span_instructions,
+                 "The least number of instructions between restart points of a gzip trace. Each point holds a 32 KiB window, before it is compressed.")
+      ->check(CLI::PositiveNumber)
+      ->capture_default_str();
+  app.add_flag("-c,--cloudsuite", cloudsuite, "The traces use the cloudsuite format");
+
+  CLI11_PARSE(app, argc, argv);
+
+  const auto instruction_size = cloudsuite ? sizeof(cloudsuite_instr) : sizeof(input_instr);
+
+  int failures = 0;
+  for (const auto& name : trace_names) {
+    try {
+      std::ifstream trace{name, std::ios::binary};
+      champsim::seek_index::index idx;
+      if (ends_with(name, "gz"))
+        idx = champsim::seek_index::build_gzip(trace, span_instructions * instruction_size);
+      else if (ends_with(name, "xz"))
+        idx = champsim::seek_index::build_xz(trace);
+      else
+        throw std::runtime_error("only gzip and xz traces can be indexed");
+
+      std::ofstream sidecar{champsim::seek_index::sidecar_name(name), std::ios::binary};
+      champsim::seek_index::write(sidecar, idx);
+      sidecar.close();
+      if (sidecar.fail())
+        throw std::runtime_error(fmt::format("could not write {}", champsim::seek_index::sidecar_name(name)));
+
+      fmt::print("{}: {} restart points\n", name, std::size(idx.points));
+      if (idx.fmt == champsim::seek_index::format::xz && std::size(idx.points) < 2)
+        fmt::print("WARNING: {} has one block, so it cannot be skipped into. Compress it with xz --block-size to split it.\n", name);
+    } catch (const std::runtime_error& err) {
+      fmt::print(stderr, "{}: {}\n", name, err.what());
+      ++failures;
+    }
+  }
+
+  return failures > 0 ? 1 : 0;
+}